@@ -0,0 +1,81 @@
+// bench.hpp
+// 基准测试的公共定义
+
+#pragma once
+
+#include <json/json.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+	// 运行参数
+	struct Options
+	{
+		std::string filter;         // 只运行名称中包含该字符串的测试，为空时运行全部
+		double min_time = 0.5;      // 微基准测试的最短运行时间（秒）
+		double duration = 60;       // 宏基准测试中输入音频的时长（秒）
+		int block_size = 4096;      // 微基准测试每次处理的帧数，也是节点图的处理块大小
+		int sample_rate = 48000;    // 输入音频与工程的采样率，也用于计算实时倍率
+	};
+
+	// 单项测试结果
+	struct Result
+	{
+		std::string name;     // 测试名称
+		std::string kind;     // "kernel"或"graph"
+		size_t iterations;    // 重复次数
+		size_t samples;       // 处理的总帧数（每声道采样数）
+		double seconds;       // 总耗时（秒）
+		int sample_rate;      // 计算实时倍率使用的采样率
+		Json::Value details;  // 附加信息，如空终端的统计结果
+
+		Json::Value to_json() const;
+	};
+
+	// 判断测试是否需要运行
+	inline bool selected(const Options& options, const std::string& name)
+	{
+		return options.filter.empty() || name.find(options.filter) != std::string::npos;
+	}
+
+	// 重复执行func直到累计耗时超过options.min_time
+	// - 每次调用处理samples_per_call帧
+	template <typename F>
+	Result run_kernel(const Options& options, std::string name, size_t samples_per_call, F&& func)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		// 预热，排除首次调用的缓存与分配开销
+		func();
+
+		size_t iterations = 0;
+		const auto start = Clock::now();
+		auto now = start;
+
+		do
+		{
+			for (int i = 0; i < 16; i++) func();
+			iterations += 16;
+			now = Clock::now();
+		} while (std::chrono::duration<double>(now - start).count() < options.min_time);
+
+		return Result{
+			.name = std::move(name),
+			.kind = "kernel",
+			.iterations = iterations,
+			.samples = iterations * samples_per_call,
+			.seconds = std::chrono::duration<double>(now - start).count(),
+			.sample_rate = options.sample_rate
+		};
+	}
+
+	// 防止编译器把基准测试的计算结果优化掉
+	void keep_result(const void* data);
+
+	std::vector<Result> run_kernel_benchmarks(const Options& options);
+	std::vector<Result> run_graph_benchmarks(const Options& options);
+}
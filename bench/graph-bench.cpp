@@ -0,0 +1,565 @@
+// graph-bench.cpp
+// 端到端的节点图基准测试
+// - 在代码中构建节点图，以导出WAV的方式运行到结束，测量整体吞吐量
+
+#include "bench.hpp"
+#include "infra/graph.hpp"
+#include "infra/runner.hpp"
+#include "processor/audio-amix.hpp"
+#include "processor/audio-io.hpp"
+#include "processor/audio-velocity.hpp"
+#include "processor/audio-vol.hpp"
+#include "processor/null-sink.hpp"
+#include "processor/signal-generator.hpp"
+#include "utility/anycast-utility.hpp"
+#include "utility/free-utility.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <numbers>
+#include <sstream>
+#include <thread>
+
+namespace bench
+{
+	// 生成一个16位双声道的WAV文件作为输入
+	static void write_input_file(const std::filesystem::path& path, int sample_rate, size_t frame_count)
+	{
+		constexpr int channels = 2;
+		constexpr int bytes_per_sample = 2;
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file) throw std::runtime_error(std::format("Cannot create input file {}", path.string()));
+
+		const auto put = [&file](auto value)
+		{ file.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+		const uint32_t data_size = uint32_t(frame_count * channels * bytes_per_sample);
+
+		file.write("RIFF", 4);
+		put(uint32_t(36 + data_size));
+		file.write("WAVEfmt ", 8);
+		put(uint32_t(16));
+		put(uint16_t(1));
+		put(uint16_t(channels));
+		put(uint32_t(sample_rate));
+		put(uint32_t(sample_rate * channels * bytes_per_sample));
+		put(uint16_t(channels * bytes_per_sample));
+		put(uint16_t(bytes_per_sample * 8));
+		file.write("data", 4);
+		put(data_size);
+
+		// 分块写入，避免一次性生成整个文件的采样
+		std::vector<int16_t> block;
+		for (size_t offset = 0; offset < frame_count; offset += 65536)
+		{
+			const size_t count = std::min<size_t>(65536, frame_count - offset);
+			block.resize(count * channels);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const double t = double(offset + i) / sample_rate;
+				block[i * 2] = int16_t(16384 * std::sin(2 * std::numbers::pi * 440 * t));
+				block[i * 2 + 1] = int16_t(16384 * std::sin(2 * std::numbers::pi * 660 * t));
+			}
+
+			file.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(int16_t));
+		}
+
+		if (!file) throw std::runtime_error(std::format("Cannot write input file {}", path.string()));
+	}
+
+	static infra::Id_t get_pin(const infra::Graph& graph, infra::Id_t node, const std::string& identifier)
+	{
+		return graph.nodes.at(node).pin_name_map.at(identifier);
+	}
+
+	static std::unique_ptr<processor::Audio_input> create_input(const std::string& path, int count)
+	{
+		Json::Value file_path(Json::ValueType::arrayValue);
+		for (int i = 0; i < count; i++) file_path.append(path);
+
+		Json::Value value(Json::ValueType::objectValue);
+		value["file_path"] = file_path;
+
+		auto input = std::make_unique<processor::Audio_input>();
+		input->deserialize(value);
+		return input;
+	}
+
+	// 获取处理器抛出的错误信息
+	static std::string describe_error(const std::any& error)
+	{
+		if (const auto runtime_error = try_anycast<infra::Processor::Runtime_error>(error))
+			return runtime_error->what();
+		if (const auto runtime_error = try_anycast<std::runtime_error>(error)) return runtime_error->what();
+		if (const auto logic_error = try_anycast<std::logic_error>(error)) return logic_error->what();
+		return "Unknown error";
+	}
+
+	// 运行节点图直到所有处理器结束
+	// - 图中的空终端节点的统计结果记录在details中
+	// - fuse: 是否融合相连的逐采样处理器
+	static Result run_graph(
+		const Options& options,
+		std::string name,
+		const infra::Graph& graph,
+		std::map<infra::Id_t, std::shared_ptr<std::any>> node_data,
+		size_t samples,
+		bool fuse = true
+	)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		const auto start = Clock::now();
+		auto runner = infra::Runner::create_and_run(graph, std::move(node_data), fuse);
+
+		while (!runner->is_finished())
+		{
+			if (runner->get_state_count(infra::Runner::State::Error) > 0)
+				throw std::runtime_error(
+					std::format("Benchmark \"{}\" failed: {}", name, describe_error(*runner->get_error()))
+				);
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		const auto end = Clock::now();
+		runner.reset();
+
+		Json::Value details;
+		for (const auto& [id, node] : graph.nodes)
+		{
+			const auto sink = std::dynamic_pointer_cast<processor::Null_sink>(node.processor);
+			if (sink == nullptr) continue;
+
+			const auto stats = sink->get_stats();
+
+			Json::Value sink_value;
+			sink_value["node"] = Json::UInt64(id);
+			sink_value["samples"] = Json::UInt64(stats.samples);
+			sink_value["frames"] = Json::UInt64(stats.frames);
+			sink_value["wall_time"] = stats.wall_time;
+			sink_value["peak"] = stats.peak;
+			sink_value["rms"] = stats.rms;
+			sink_value["checksum"] = std::format("{:016x}", stats.checksum);
+			details["sinks"].append(sink_value);
+		}
+
+		return Result{
+			.name = std::move(name),
+			.kind = "graph",
+			.iterations = 1,
+			.samples = samples,
+			.seconds = std::chrono::duration<double>(end - start).count(),
+			.sample_rate = options.sample_rate,
+			.details = std::move(details)
+		};
+	}
+
+	// 运行以输出节点结尾的节点图，输出节点以WAV格式导出到output_path
+	static Result run_export_graph(
+		const Options& options,
+		std::string name,
+		const infra::Graph& graph,
+		infra::Id_t output_node,
+		const std::filesystem::path& output_path,
+		size_t samples
+	)
+	{
+		std::map<infra::Id_t, std::shared_ptr<std::any>> node_data;
+		node_data[output_node] = std::make_shared<std::any>(processor::Audio_output::Process_context{
+			.do_export = true,
+			.export_path = output_path.string(),
+			.format = processor::Export_format::Wav
+		});
+
+		const Free_utility remove_output(
+			[output_path]
+			{
+				std::error_code error_code;
+				std::filesystem::remove(output_path, error_code);
+			}
+		);
+
+		return run_graph(options, std::move(name), graph, std::move(node_data), samples);
+	}
+
+	// 输入 → 输出，衡量解码、调度与编码的基础开销
+	static Result bench_passthrough(
+		const Options& options,
+		const std::filesystem::path& input_path,
+		const std::filesystem::path& output_path,
+		size_t samples
+	)
+	{
+		infra::Graph graph;
+
+		const auto input = graph.add_node(create_input(input_path.string(), 1));
+		const auto output = graph.add_node(std::make_unique<processor::Audio_output>());
+
+		graph.add_link(get_pin(graph, input, "output_0"), get_pin(graph, output, "input"));
+
+		return run_export_graph(options, "graph/passthrough", graph, output, output_path, samples);
+	}
+
+	// 输入 → 音量 → 变调 → 输出
+	static Result bench_vol_pitch(
+		const Options& options,
+		const std::filesystem::path& input_path,
+		const std::filesystem::path& output_path,
+		size_t samples
+	)
+	{
+		infra::Graph graph;
+
+		auto pitch_modifier = std::make_unique<processor::Pitch_modifier>();
+		Json::Value pitch_value;
+		pitch_value["pitch"] = 2.0;
+		pitch_modifier->deserialize(pitch_value);
+
+		const auto input = graph.add_node(create_input(input_path.string(), 1));
+		const auto vol = graph.add_node(std::make_unique<processor::Audio_vol>());
+		const auto pitch = graph.add_node(std::move(pitch_modifier));
+		const auto output = graph.add_node(std::make_unique<processor::Audio_output>());
+
+		graph.add_link(get_pin(graph, input, "output_0"), get_pin(graph, vol, "input"));
+		graph.add_link(get_pin(graph, vol, "output"), get_pin(graph, pitch, "input"));
+		graph.add_link(get_pin(graph, pitch, "output"), get_pin(graph, output, "input"));
+
+		return run_export_graph(options, "graph/vol_pitch", graph, output, output_path, samples);
+	}
+
+	// 同一输入的16路 → 混音 → 输出
+	static Result bench_amix(
+		const Options& options,
+		const std::filesystem::path& input_path,
+		const std::filesystem::path& output_path,
+		size_t samples
+	)
+	{
+		constexpr int input_num = 16;
+
+		infra::Graph graph;
+
+		auto amix = std::make_unique<processor::Audio_amix>();
+		Json::Value amix_value;
+		amix_value["input_num"] = input_num;
+		for (int i = 0; i < input_num; i++)
+		{
+			amix_value[std::format("volumes{}", i)] = 1.0 / input_num;
+			amix_value[std::format("locks{}", i)] = false;
+		}
+		amix->deserialize(amix_value);
+
+		const auto input = graph.add_node(create_input(input_path.string(), input_num));
+		const auto mixer = graph.add_node(std::move(amix));
+		const auto output = graph.add_node(std::make_unique<processor::Audio_output>());
+
+		for (int i = 0; i < input_num; i++)
+			graph.add_link(
+				get_pin(graph, input, std::format("output_{}", i)),
+				get_pin(graph, mixer, std::format("input_{}", i + 1))
+			);
+		graph.add_link(get_pin(graph, mixer, "output"), get_pin(graph, output, "input"));
+
+		return run_export_graph(options, "graph/amix16", graph, output, output_path, samples);
+	}
+
+	static std::unique_ptr<processor::Signal_generator> create_generator(
+		const Options& options,
+		float frequency
+	)
+	{
+		Json::Value value;
+		value["waveform"] = "sine";
+		value["frequency"] = frequency;
+		value["duration"] = options.duration;
+		value["sample_rate"] = options.sample_rate;
+		value["channels"] = 2;
+
+		auto generator = std::make_unique<processor::Signal_generator>();
+		generator->deserialize(value);
+		return generator;
+	}
+
+	// 信号发生器 → 空终端，不读写文件，衡量调度本身的开销
+	static Result bench_generator_sink(const Options& options, size_t samples)
+	{
+		infra::Graph graph;
+
+		const auto generator = graph.add_node(create_generator(options, 440));
+		const auto sink = graph.add_node(std::make_unique<processor::Null_sink>());
+
+		graph.add_link(get_pin(graph, generator, "output"), get_pin(graph, sink, "input"));
+
+		return run_graph(options, "graph/generator_sink", graph, {}, samples);
+	}
+
+	// 16个信号发生器 → 混音 → 空终端
+	static Result bench_generator_amix(const Options& options, size_t samples)
+	{
+		constexpr int input_num = 16;
+
+		infra::Graph graph;
+
+		auto amix = std::make_unique<processor::Audio_amix>();
+		Json::Value amix_value;
+		amix_value["input_num"] = input_num;
+		for (int i = 0; i < input_num; i++)
+		{
+			amix_value[std::format("volumes{}", i)] = 1.0 / input_num;
+			amix_value[std::format("locks{}", i)] = false;
+		}
+		amix->deserialize(amix_value);
+
+		const auto mixer = graph.add_node(std::move(amix));
+		const auto sink = graph.add_node(std::make_unique<processor::Null_sink>());
+
+		for (int i = 0; i < input_num; i++)
+		{
+			const auto generator = graph.add_node(create_generator(options, 220.0f * (i + 1)));
+			graph.add_link(
+				get_pin(graph, generator, "output"),
+				get_pin(graph, mixer, std::format("input_{}", i + 1))
+			);
+		}
+		graph.add_link(get_pin(graph, mixer, "output"), get_pin(graph, sink, "input"));
+
+		return run_graph(options, "graph/generator_amix16", graph, {}, samples);
+	}
+
+	// 信号发生器 → 4个音量调节 → 空终端，分别在融合与不融合时运行
+	static Result bench_generator_vol_chain(const Options& options, size_t samples, bool fuse)
+	{
+		constexpr int chain_length = 4;
+
+		infra::Graph graph;
+
+		auto previous = graph.add_node(create_generator(options, 440));
+		for (int i = 0; i < chain_length; i++)
+		{
+			const auto vol = graph.add_node(std::make_unique<processor::Audio_vol>());
+			graph.add_link(get_pin(graph, previous, "output"), get_pin(graph, vol, "input"));
+			previous = vol;
+		}
+
+		const auto sink = graph.add_node(std::make_unique<processor::Null_sink>());
+		graph.add_link(get_pin(graph, previous, "output"), get_pin(graph, sink, "input"));
+
+		return run_graph(
+			options,
+			fuse ? "graph/vol_chain4/fused" : "graph/vol_chain4/unfused",
+			graph,
+			{},
+			samples,
+			fuse
+		);
+	}
+
+	// 信号发生器 → 变速 → 空终端，分别在不保持音高（重采样）与保持音高（SoundTouch）时运行
+	// - 速度低于1时输出多于输入，可以检查SoundTouch路径是否及时取出输出并正常运行到结束
+	static Result bench_generator_velocity(
+		const Options& options,
+		const std::string& name,
+		size_t samples,
+		float velocity,
+		bool keep_pitch
+	)
+	{
+		infra::Graph graph;
+
+		auto velocity_modifier = std::make_unique<processor::Velocity_modifier>();
+		Json::Value velocity_value;
+		velocity_value["velocity"] = velocity;
+		velocity_value["keep_pitch"] = keep_pitch;
+		velocity_modifier->deserialize(velocity_value);
+
+		const auto generator = graph.add_node(create_generator(options, 440));
+		const auto velocity = graph.add_node(std::move(velocity_modifier));
+		const auto sink = graph.add_node(std::make_unique<processor::Null_sink>());
+
+		graph.add_link(get_pin(graph, generator, "output"), get_pin(graph, velocity, "input"));
+		graph.add_link(get_pin(graph, velocity, "output"), get_pin(graph, sink, "input"));
+
+		return run_graph(options, name, graph, {}, samples);
+	}
+
+	// 生成由node_count个音量调节节点串联而成的工程JSON
+	static Json::Value make_chain_project(int node_count)
+	{
+		const Json::Value info = processor::Audio_vol().serialize();
+		const auto identifier = processor::Audio_vol::get_processor_info().identifier;
+
+		Json::Value nodes(Json::ValueType::objectValue);
+		Json::Value links(Json::ValueType::arrayValue);
+
+		for (int i = 0; i < node_count; i++)
+		{
+			Json::Value node;
+			node["identifier"] = identifier;
+			node["info"] = info;
+			node["position"]["x"] = float(i % 50) * 200;
+			node["position"]["y"] = float(i / 50) * 150;
+			nodes[std::to_string(i)] = std::move(node);
+
+			if (i == 0) continue;
+
+			Json::Value link;
+			link["from"]["node"] = i - 1;
+			link["from"]["pin"] = "output";
+			link["to"]["node"] = i;
+			link["to"]["pin"] = "input";
+			links.append(std::move(link));
+		}
+
+		Json::Value project;
+		project["nodes"] = std::move(nodes);
+		project["links"] = std::move(links);
+		return project;
+	}
+
+	enum class Project_loader
+	{
+		Json,         // 先解析为完整的JSON树再构建图
+		Json_stream,  // 从流中逐个节点解析
+		Binary
+	};
+
+	// 加载5000个节点的工程，分别使用JSON、流式JSON与二进制格式
+	// - JSON包括解析文本与构建图，二进制只有构建图
+	static Result bench_project_load(const Options& options, Project_loader loader)
+	{
+		constexpr int node_count = 5000;
+
+		const auto project = make_chain_project(node_count);
+
+		Json::StreamWriterBuilder writer;
+		writer["indentation"] = "  ";
+		const std::string content = loader == Project_loader::Binary
+									  ? infra::Graph::encode_binary(project)
+									  : Json::writeString(writer, project);
+
+		const char* const name = [loader]
+		{
+			switch (loader)
+			{
+			case Project_loader::Json:
+				return "graph/load/json_5k";
+			case Project_loader::Json_stream:
+				return "graph/load/json_stream_5k";
+			default:
+				return "graph/load/binary_5k";
+			}
+		}();
+
+		auto result = run_kernel(
+			options,
+			name,
+			0,
+			[&]
+			{
+				infra::Graph graph;
+
+				switch (loader)
+				{
+				case Project_loader::Json:
+				{
+					Json::Value json;
+					if (!Json::Reader().parse(content, json, false))
+						throw std::runtime_error("Failed to parse generated project");
+					graph = infra::Graph::deserialize(json);
+					break;
+				}
+				case Project_loader::Json_stream:
+				{
+					std::istringstream stream(content);
+					graph = infra::Graph::deserialize(stream);
+					break;
+				}
+				case Project_loader::Binary:
+					graph = infra::Graph::deserialize_binary(content);
+					break;
+				}
+
+				keep_result(&graph);
+			}
+		);
+
+		result.kind = "graph";
+		result.details["nodes"] = node_count;
+		result.details["file_bytes"] = Json::UInt64(content.size());
+		return result;
+	}
+
+	std::vector<Result> run_graph_benchmarks(const Options& options)
+	{
+		using Bench_func = Result (*)(
+			const Options&,
+			const std::filesystem::path&,
+			const std::filesystem::path&,
+			size_t
+		);
+
+		const std::pair<std::string, Bench_func> benchmarks[] = {
+			{"graph/passthrough", bench_passthrough},
+			{"graph/vol_pitch",   bench_vol_pitch  },
+			{"graph/amix16",      bench_amix       }
+		};
+
+		std::vector<Result> results;
+
+		const auto temp_directory = std::filesystem::temp_directory_path();
+		const auto input_path = temp_directory / "nodey-bench-input.wav";
+		const auto output_path = temp_directory / "nodey-bench-output.wav";
+		const auto samples = size_t(options.duration * options.sample_rate);
+
+		// 合成信号源与空终端，不需要读写文件
+		if (selected(options, "graph/generator_sink")) results.push_back(bench_generator_sink(options, samples));
+		if (selected(options, "graph/generator_amix16"))
+			results.push_back(bench_generator_amix(options, samples));
+		if (selected(options, "graph/vol_chain4/fused"))
+			results.push_back(bench_generator_vol_chain(options, samples, true));
+		if (selected(options, "graph/vol_chain4/unfused"))
+			results.push_back(bench_generator_vol_chain(options, samples, false));
+		if (selected(options, "graph/velocity/varispeed"))
+			results.push_back(
+				bench_generator_velocity(options, "graph/velocity/varispeed", samples, 1.5, false)
+			);
+		if (selected(options, "graph/velocity/time_stretch"))
+			results.push_back(
+				bench_generator_velocity(options, "graph/velocity/time_stretch", samples, 1.5, true)
+			);
+		if (selected(options, "graph/velocity/time_stretch_slow"))
+			results.push_back(
+				bench_generator_velocity(options, "graph/velocity/time_stretch_slow", samples, 0.5, true)
+			);
+		if (selected(options, "graph/load/json_5k"))
+			results.push_back(bench_project_load(options, Project_loader::Json));
+		if (selected(options, "graph/load/json_stream_5k"))
+			results.push_back(bench_project_load(options, Project_loader::Json_stream));
+		if (selected(options, "graph/load/binary_5k"))
+			results.push_back(bench_project_load(options, Project_loader::Binary));
+
+		if (std::ranges::none_of(benchmarks, [&](const auto& item) { return selected(options, item.first); }))
+			return results;
+
+		write_input_file(input_path, options.sample_rate, samples);
+
+		const Free_utility remove_input(
+			[input_path]
+			{
+				std::error_code error_code;
+				std::filesystem::remove(input_path, error_code);
+			}
+		);
+
+		for (const auto& [name, func] : benchmarks)
+			if (selected(options, name)) results.push_back(func(options, input_path, output_path, samples));
+
+		return results;
+	}
+}
@@ -0,0 +1,240 @@
+// kernel-bench.cpp
+// 处理器内核的微基准测试
+
+#include "bench.hpp"
+#include "processor/audio-kernel.hpp"
+#include "processor/audio-stream.hpp"
+#include "utility/sw-resample.hpp"
+
+extern "C"
+{
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+}
+
+#include <array>
+#include <cmath>
+#include <format>
+#include <memory>
+#include <numbers>
+#include <stdexcept>
+
+namespace bench
+{
+	// 分配一帧填充了正弦波的音频
+	static std::unique_ptr<processor::Audio_frame> make_frame(
+		AVSampleFormat format,
+		int channels,
+		int sample_count,
+		int sample_rate
+	)
+	{
+		auto frame = std::make_unique<processor::Audio_frame>();
+		AVFrame* data = frame->data();
+
+		data->format = format;
+		data->nb_samples = sample_count;
+		data->sample_rate = sample_rate;
+		av_channel_layout_default(&data->ch_layout, channels);
+
+		if (av_frame_get_buffer(data, 32) < 0) throw std::bad_alloc();
+
+		const bool planar = av_sample_fmt_is_planar(format);
+		const auto packed_format = av_get_packed_sample_fmt(format);
+
+		for (int ch = 0; ch < channels; ch++)
+			for (int i = 0; i < sample_count; i++)
+			{
+				const double value = 0.5 * std::sin(2 * std::numbers::pi * 440 * i / sample_rate + ch);
+				const int index = planar ? i : i * channels + ch;
+				uint8_t* const plane = data->data[planar ? ch : 0];
+
+				switch (packed_format)
+				{
+				case AV_SAMPLE_FMT_FLT:
+					reinterpret_cast<float*>(plane)[index] = float(value);
+					break;
+				case AV_SAMPLE_FMT_S16:
+					reinterpret_cast<int16_t*>(plane)[index] = int16_t(value * 32767);
+					break;
+				case AV_SAMPLE_FMT_S32:
+					reinterpret_cast<int32_t*>(plane)[index] = int32_t(value * 2147483647.0);
+					break;
+				default:
+					throw std::invalid_argument("Unsupported sample format for benchmark frame");
+				}
+			}
+
+		return frame;
+	}
+
+	// 原地处理，音量在0.5和2之间交替，数据不会衰减为非规格化数
+	static Result bench_change_volume_float(const Options& options)
+	{
+		const auto frame = make_frame(AV_SAMPLE_FMT_FLTP, 2, options.block_size, options.sample_rate);
+		float volume = 0.5f;
+
+		return run_kernel(
+			options,
+			"kernel/change_volume/fltp",
+			options.block_size,
+			[&]
+			{
+				processor::change_volume<float>(frame->data()->data, 2, options.block_size, volume);
+				volume = 1.0f / volume;
+				keep_result(frame->data()->data[0]);
+			}
+		);
+	}
+
+	static Result bench_change_volume_s16(const Options& options)
+	{
+		const auto frame = make_frame(AV_SAMPLE_FMT_S16, 2, options.block_size, options.sample_rate);
+		float volume = 0.5f;
+
+		return run_kernel(
+			options,
+			"kernel/change_volume/s16",
+			options.block_size,
+			[&]
+			{
+				processor::change_volume<int16_t>(frame->data()->data, 1, options.block_size * 2, volume);
+				volume = 1.0f / volume;
+				keep_result(frame->data()->data[0]);
+			}
+		);
+	}
+
+	static Result bench_amix(const Options& options, int input_num)
+	{
+		std::vector<std::unique_ptr<processor::Audio_frame>> inputs;
+		std::vector<uint8_t**> datas;
+		for (int i = 0; i < input_num; i++)
+		{
+			inputs.push_back(make_frame(AV_SAMPLE_FMT_FLTP, 2, options.block_size, options.sample_rate));
+			datas.push_back(inputs.back()->data()->extended_data);
+		}
+
+		const std::vector<float> volumes(input_num, 1.0f / input_num);
+		const auto output = make_frame(AV_SAMPLE_FMT_FLTP, 2, options.block_size, options.sample_rate);
+
+		return run_kernel(
+			options,
+			std::format("kernel/amix/{}", input_num),
+			options.block_size,
+			[&]
+			{
+				processor::mix_stereo_planar(
+					reinterpret_cast<float*>(output->data()->data[0]),
+					reinterpret_cast<float*>(output->data()->data[1]),
+					datas,
+					volumes,
+					options.block_size
+				);
+				keep_result(output->data()->data[0]);
+			}
+		);
+	}
+
+	static Result bench_extract_samples(const Options& options, AVSampleFormat format)
+	{
+		const auto frame = make_frame(format, 2, options.block_size, options.sample_rate);
+
+		return run_kernel(
+			options,
+			std::format("kernel/extract_samples_interleaved/{}", av_get_sample_fmt_name(format)),
+			options.block_size,
+			[&]
+			{
+				const auto samples = processor::extract_samples_interleaved(frame->data());
+				keep_result(samples.data());
+			}
+		);
+	}
+
+	static std::string resample_bench_name(
+		const Options& options,
+		int input_sample_rate,
+		Audio_resampler::Quality quality
+	)
+	{
+		return std::format(
+			"kernel/resample/s16_{}_to_fltp_{}/{}",
+			input_sample_rate,
+			options.sample_rate,
+			Audio_resampler::get_quality_name(quality)
+		);
+	}
+
+	static Result bench_resample(
+		const Options& options,
+		int input_sample_rate,
+		Audio_resampler::Quality quality
+	)
+	{
+		const auto input = make_frame(AV_SAMPLE_FMT_S16, 2, options.block_size, input_sample_rate);
+
+		auto resampler_create = Audio_resampler::create(
+			{.format = AV_SAMPLE_FMT_S16,
+			 .sample_rate = input_sample_rate,
+			 .channel_layout = AV_CHANNEL_LAYOUT_STEREO},
+			{.format = AV_SAMPLE_FMT_FLTP,
+			 .sample_rate = options.sample_rate,
+			 .channel_layout = AV_CHANNEL_LAYOUT_STEREO},
+			quality
+		);
+		if (!resampler_create.has_value()) throw std::runtime_error("Failed to create resampler");
+
+		auto& resampler = *resampler_create.value();
+		const int output_capacity = resampler.calc_samples(options.block_size) + 256;
+		std::vector<float> left(output_capacity), right(output_capacity);
+		const auto output_ptr_array = std::to_array({left.data(), right.data()});
+
+		auto result = run_kernel(
+			options,
+			resample_bench_name(options, input_sample_rate, quality),
+			options.block_size,
+			[&]
+			{
+				const auto count = resampler.resample<uint8_t, float>(
+					std::span<const uint8_t* const>{input->data()->data, input->data()->data + 1},
+					options.block_size,
+					std::span(output_ptr_array),
+					output_capacity
+				);
+				if (count < 0) throw std::runtime_error("swr_convert() returned error");
+				keep_result(left.data());
+			}
+		);
+
+		// 采样率相同时走格式转换内核，记录下来便于对比
+		const bool resampling = resampler.get_mode() == Audio_resampler::Mode::Resample;
+		result.details["mode"] = resampling ? "resample" : "convert";
+		return result;
+	}
+
+	std::vector<Result> run_kernel_benchmarks(const Options& options)
+	{
+		std::vector<Result> results;
+
+		const auto run = [&](const std::string& name, auto&& func)
+		{
+			if (selected(options, name)) results.push_back(func());
+		};
+
+		run("kernel/change_volume/fltp", [&] { return bench_change_volume_float(options); });
+		run("kernel/change_volume/s16", [&] { return bench_change_volume_s16(options); });
+		run("kernel/amix/2", [&] { return bench_amix(options, 2); });
+		run("kernel/amix/16", [&] { return bench_amix(options, 16); });
+		run("kernel/extract_samples_interleaved/fltp",
+			[&] { return bench_extract_samples(options, AV_SAMPLE_FMT_FLTP); });
+		run("kernel/extract_samples_interleaved/s16",
+			[&] { return bench_extract_samples(options, AV_SAMPLE_FMT_S16); });
+		for (const int input_sample_rate : {44100, 48000})
+			for (const auto quality : {Audio_resampler::Quality::Preview, Audio_resampler::Quality::Export})
+				run(resample_bench_name(options, input_sample_rate, quality),
+					[&] { return bench_resample(options, input_sample_rate, quality); });
+
+		return results;
+	}
+}
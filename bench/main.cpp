@@ -0,0 +1,143 @@
+// main.cpp
+// 基准测试入口
+// - 用法: nodey_bench [--filter <名称>] [--min-time <秒>] [--duration <秒>] [--block-size <帧>] [--sample-rate <Hz>]
+//         [--output <文件>]
+// - 结果以JSON格式输出到标准输出，或指定的文件
+
+#include "bench.hpp"
+#include "config.hpp"
+#include "infra/processor.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <print>
+#include <string_view>
+
+// 不链接前端代码，运行时参数由基准测试自行定义
+namespace runtime_config
+{
+	float ui_scale = 1.0f;
+	int block_size = config::audio::default_block_size;
+	int sample_rate = config::audio::default_sample_rate;
+	bool exporting = false;
+}
+
+namespace bench
+{
+	void keep_result(const void* data)
+	{
+		static const void* volatile sink;
+		sink = data;
+	}
+
+	Json::Value Result::to_json() const
+	{
+		Json::Value value;
+		value["name"] = name;
+		value["kind"] = kind;
+		value["iterations"] = Json::UInt64(iterations);
+		value["samples"] = Json::UInt64(samples);
+		value["seconds"] = seconds;
+		value["samples_per_second"] = double(samples) / seconds;
+		value["realtime_factor"] = double(samples) / sample_rate / seconds;
+		if (!details.isNull()) value["details"] = details;
+		return value;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bench::Options options;
+	std::string output_path;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string_view arg = argv[i];
+
+		if (i + 1 >= argc)
+		{
+			std::println(std::cerr, "[ERROR] Missing value for argument {}", arg);
+			return 1;
+		}
+
+		const std::string value = argv[++i];
+
+		try
+		{
+			if (arg == "--filter")
+				options.filter = value;
+			else if (arg == "--min-time")
+				options.min_time = std::stod(value);
+			else if (arg == "--duration")
+				options.duration = std::stod(value);
+			else if (arg == "--block-size")
+				options.block_size = std::stoi(value);
+			else if (arg == "--sample-rate")
+				options.sample_rate = std::stoi(value);
+			else if (arg == "--output")
+				output_path = value;
+			else
+			{
+				std::println(std::cerr, "[ERROR] Unknown argument {}", arg);
+				return 1;
+			}
+		}
+		catch (const std::logic_error&)
+		{
+			std::println(std::cerr, "[ERROR] Invalid value for argument {}: {}", arg, value);
+			return 1;
+		}
+	}
+
+	if (options.block_size <= 0 || options.sample_rate <= 0 || options.duration <= 0 || options.min_time <= 0)
+	{
+		std::println(std::cerr, "[ERROR] Arguments must be positive");
+		return 1;
+	}
+
+	// 节点图基准测试使用同样的处理块大小，工程采样率与信号源一致，混音节点不需要重采样
+	runtime_config::block_size = options.block_size;
+	runtime_config::sample_rate = options.sample_rate;
+
+	infra::register_all_processors();
+
+	Json::Value root;
+	root["sample_rate"] = options.sample_rate;
+	root["block_size"] = options.block_size;
+	root["duration"] = options.duration;
+	root["results"] = Json::Value(Json::ValueType::arrayValue);
+
+	try
+	{
+		for (const auto& result : bench::run_kernel_benchmarks(options))
+			root["results"].append(result.to_json());
+
+		for (const auto& result : bench::run_graph_benchmarks(options))
+			root["results"].append(result.to_json());
+	}
+	catch (const std::exception& e)
+	{
+		std::println(std::cerr, "[ERROR] {}", e.what());
+		return 1;
+	}
+
+	Json::StreamWriterBuilder writer;
+	writer["indentation"] = "  ";
+	const std::string json = Json::writeString(writer, root) + "\n";
+
+	if (output_path.empty())
+		std::cout << json;
+	else
+	{
+		std::ofstream file(output_path);
+		file << json;
+
+		if (!file)
+		{
+			std::println(std::cerr, "[ERROR] Cannot write output file {}", output_path);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -17,12 +17,23 @@ namespace config
 	{
 		using Buffer_type = float;
 
-		inline static constexpr auto sample_rate = 48000;        // 采样率
-		inline static constexpr auto buffer_size = 2048;         // 缓冲区大小
+		inline static constexpr auto default_sample_rate = 48000;  // 默认工作采样率
+		inline static constexpr auto buffer_size = 512;          // 默认设备缓冲区大小（采样）
 		inline static constexpr auto buffer_format = AUDIO_F32;  // 格式
 		inline static constexpr auto channels = 2;               // 双声道
-		inline static constexpr auto max_buffer_items = 3;       //  最大可以暂存的音频包个数
-		inline static constexpr auto max_buffer_size = buffer_size * max_buffer_items * sizeof(Buffer_type);
+		inline static constexpr auto buffer_periods = 2;         // 预览时环形缓冲区保持的设备缓冲区个数
+		inline static constexpr auto ring_buffer_frames = 16384;  // 环形缓冲区容量（帧）
+
+		// 可选的设备缓冲区大小
+		inline static constexpr int buffer_size_presets[] = {128, 256, 512, 1024, 2048, 4096};
+
+		// 可选的工程采样率，未指定时取输入文件中最常见的采样率
+		inline static constexpr int sample_rate_presets[] = {22050, 32000, 44100, 48000, 88200, 96000};
+
+		// 可选的处理块大小（采样），输入与混音节点输出的每帧采样数
+		// - 块越小预览延迟越低，块越大导出吞吐量越高
+		inline static constexpr int block_size_presets[] = {256, 512, 1024, 2048, 4096};
+		inline static constexpr int default_block_size = 1024;
 
 		inline static constexpr AVSampleFormat av_format = AV_SAMPLE_FMT_FLT;  // AVCODEC的对应格式
 		inline static constexpr AVChannelLayout av_channel_layout = AV_CHANNEL_LAYOUT_STEREO;  // 双声道立体声
@@ -36,6 +47,12 @@ namespace config
 		inline static constexpr auto toolbar_margin = 30;                              // 工具栏边距
 		inline static constexpr auto node_editor_minimap_fraction = 0.15;              // 节点编辑器小地图占比
 		inline static constexpr auto min_window_width = 800, min_window_height = 600;  // 最小窗口大小
+
+		// 空闲节流：没有输入且没有正在运行的处理时，阻塞等待事件
+		inline static constexpr auto idle_tick_ms = 250;     // 空闲时的刷新间隔（毫秒），用于更新后台状态
+		inline static constexpr auto idle_settle_ms = 1000;  // 最后一次输入后保持全速刷新的时间（毫秒）
+
+		inline static constexpr size_t metrics_history_size = 300;  // 诊断覆盖层记录的运行统计快照数量
 	};
 
 	// 逻辑参数
@@ -53,19 +70,39 @@ namespace config
 			inline static constexpr auto buffer_size = 16;
 		}
 
-		namespace audio_volume
+		namespace audio_input
 		{
-			inline static constexpr float max_volume = 10;
+			inline static constexpr float waveform_width = 200;  // 节点中波形预览的宽度
+			inline static constexpr float waveform_height = 40;  // 节点中波形预览的高度
 		}
 
-		namespace audio_amix
+		namespace audio_output
 		{
-			inline static constexpr int std_sample_rate = 48000;
+			inline static constexpr size_t export_queue_size = 64;                    // 编码线程队列长度（帧）
+			inline static constexpr size_t export_write_buffer_size = 4 * 1024 * 1024;  // 导出写入缓冲区大小
+			inline static constexpr int silence_chunk_samples = 4096;  // 编码静音时每次提交的采样数
+			inline static constexpr int encoder_wait_ms = 50;  // 等待编码线程结束时检查停止标志的间隔（毫秒）
+
+			inline static constexpr size_t segment_frames = 512;        // 并行编码时每个分段的MP3帧数
+			inline static constexpr size_t segment_priming_frames = 4;  // 分段前用于预热编码器的帧数
+			inline static constexpr size_t segment_trailing_frames = 2;  // 分段后额外编码的帧数
 		}
 
-		namespace audio_bimix
+		namespace signal_generator
 		{
-			inline static constexpr int std_sample_rate = 48000;
+			inline static constexpr int table_seconds = 1;     // 采样表的长度（秒），正弦波频率精度为其倒数
+			inline static constexpr float max_duration = 3600;  // 最大时长（秒）
+			inline static constexpr int sample_rate_presets[] = {22050, 44100, 48000, 96000};
+		}
+
+		namespace sample_processor
+		{
+			inline static constexpr int chunk_size = 1024;  // 融合执行内核时每块的采样数
+		}
+
+		namespace audio_volume
+		{
+			inline static constexpr float max_volume = 10;
 		}
 
 	}
@@ -81,4 +118,9 @@ namespace runtime_config
 {
 	// UI参数
 	extern float ui_scale;
+
+	// 处理参数
+	extern int block_size;   // 处理块大小（采样），在启动预览或导出前设置
+	extern int sample_rate;  // 工程采样率，混音节点与预览设备按此工作，在启动预览或导出前设置
+	extern bool exporting;   // 是否正在导出，导出时采样率转换使用高质量预设
 }
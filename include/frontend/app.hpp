@@ -3,9 +3,9 @@
 // 系统头文件
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <functional>
-#include <list>
 #include <map>
 #include <memory>
 #include <print>
@@ -26,9 +26,11 @@
 #include "frontend/font.hpp"
 #include "frontend/imgui-context.hpp"
 #include "frontend/sdl-context.hpp"
+#include "infra/graph-history.hpp"
 #include "infra/graph.hpp"
 #include "infra/processor.hpp"
 #include "infra/runner.hpp"
+#include "processor/audio-encoder.hpp"
 
 // 应用程序主类
 // - 管理应用程序状态
@@ -84,11 +86,10 @@ class App
 	std::unique_ptr<infra::Runner> runner;  // 音频预览运行器
 
 	// 撤销/重做系统
-	std::list<infra::Graph> undo_stack;  // 撤销栈
-	std::list<infra::Graph> redo_stack;  // 重做栈
+	infra::Graph_history history;  // 撤销/重做记录
 
 	// 复制粘贴系统
-	std::string copied_graph_json;               // 复制的图数据（JSON格式）
+	infra::Graph::Subgraph clipboard;            // 复制的子图，处理器为独立的副本
 	ImVec2 last_paste_position{100.0f, 100.0f};  // 上次粘贴位置
 
 	// 延迟选择
@@ -103,14 +104,29 @@ class App
 
 	App_settings app_settings;  // 应用程序设置
 	bool show_diagnostics = false;
+
+	// 运行统计历史，环形缓冲区，用于在诊断覆盖层中绘制曲线
+	std::vector<infra::Runner::Metrics> metrics_history;
+	size_t metrics_history_head = 0;  // 缓冲区满时最旧快照的位置
+	uint64_t metrics_sequence = 0;    // 已记录的最新快照序号
 	bool show_demo_window = false;
 
+	// 空闲节流
+	std::chrono::steady_clock::time_point last_activity_time = std::chrono::steady_clock::now();  // 上一次输入
+	size_t popup_window_count = 0;  // 上一帧的弹窗数量
+
 	// =============================================================================
 	// 弹窗管理
 	// =============================================================================
 
 	std::jthread background_thread;
 
+	// 自动保存，格式化与写盘在后台线程中完成
+	std::atomic<bool> autosave_running = false;  // 后台线程是否正在保存
+	std::atomic<bool> autosave_failed = false;   // 上一次自动保存是否失败
+	std::chrono::steady_clock::time_point last_autosave_time = std::chrono::steady_clock::now();
+	std::jthread autosave_thread;  // 声明在上面的状态之后，析构时先等待线程结束
+
 	// 错误和信息弹窗
 	void add_error_popup_window(                       // 添加错误弹窗
         std::string message,                           // 错误消息
@@ -152,29 +168,30 @@ class App
 	void new_project_async();  // 创建新项目
 
 	bool save_project_with_path(const std::string& filename);  // 保存项目到指定路径
+	void poll_autosave();                                      // 到达间隔时在后台自动保存项目
 	bool load_project_from_file(const std::string& filepath);  // 从文件加载项目
 
 	// 序列化
-	std::string save_graph_as_string() const;                     // 将图序列化为JSON字符串
-	void load_graph_from_string(const std::string& json_string);  // 从JSON字符串反序列化图
+	bool write_project_file(std::ostream& stream, const std::string& path) const;  // 按路径的扩展名序列化图
+	void load_graph_from_stream(std::istream& stream);                             // 从JSON或二进制项目文件反序列化图
 
 	// =============================================================================
 	// 撤销/重做系统
 	// =============================================================================
 
-	void save_undo_state();         // 保存当前状态到撤销栈
-	void save_redo_state();         // 保存当前状态到重做栈
+	void save_undo_state();         // 即将修改图，记录此前的修改
 	void undo();                    // 执行撤销操作
 	void redo();                    // 执行重做操作
 	void restore_node_positions();  // 恢复节点位置
-	void compress_undo_stack();     // 压缩撤销栈以节省内存
 
 	// =============================================================================
 	// 复制粘贴系统
 	// =============================================================================
 
-	void copy_selected_nodes();  // 复制选中的节点和连接
-	void paste_nodes();          // 粘贴节点和连接
+	void copy_selected_nodes();            // 复制选中的节点和连接
+	void paste_nodes();                    // 粘贴节点和连接
+	void copy_selected_nodes_to_system();  // 复制选中的节点到系统剪贴板（JSON格式）
+	void paste_nodes_from_system();        // 从系统剪贴板粘贴节点（JSON格式）
 
 	// =============================================================================
 	// UI绘制 - 主要组件
@@ -191,6 +208,7 @@ class App
 	void draw_diagnostics_overlay();  // 绘制性能信息覆盖层
 
 	void sync_ui_settings() const;  // 同步UI设置到ImGui/ImNode上下文
+	void sync_audio_settings();     // 同步音频设置，缓冲区大小改变时重新打开音频设备
 
 	// =============================================================================
 	// UI绘制 - 菜单栏
@@ -214,6 +232,7 @@ class App
 	// 节点编辑器绘制
 	void draw_node_editor();                                         // 绘制节点编辑器主界面
 	void draw_node(infra::Id_t id, const infra::Graph::Node& node);  // 绘制单个节点
+	void sync_dragged_node_positions();                              // 保存被拖动节点的位置
 	void draw_node_editor_context_menu();                            // 绘制节点编辑器右键菜单
 	void draw_add_node_menu();                                       // 绘制添加节点菜单
 
@@ -227,22 +246,25 @@ class App
 	// =============================================================================
 
 	// 状态轮询和预览
-	void poll_state();             // 轮询应用程序状态，处理状态转换
-	void create_preview_runner();  // 创建音频预览运行器
+	void poll_state();                    // 轮询应用程序状态，处理状态转换
+	bool is_idle() const;                 // 是否可以降低刷新率，等待输入
+	int get_project_sample_rate() const;  // 获取工程采样率，未指定时按输入文件自动选择
+	void create_preview_runner();         // 创建音频预览运行器
+	void record_runner_metrics();         // 记录运行器新发布的统计快照
+	void reset_metrics_history();         // 清空运行统计历史，创建新的运行器时调用
 
 	// 创建音频导出运行器
 	// - 返回一个共享指针，指向一个原子双精度浮点数，用于跟踪导出进度
 	std::shared_ptr<std::atomic<double>> create_export_runner(
 		const std::string& export_file_path,
-		size_t kbps
+		processor::Export_format format,
+		size_t kbps,
+		bool parallel_encode
 	);                                                      // 创建音频导出运行器
 	void show_preview_runner_error(const std::any& error);  // 显示预览运行器错误信息
 	void show_export_runner_error(const std::any& error);   // 显示导出运行器错误信息
 
 	// 辅助函数
 	static std::string get_current_state_text(App::State state);  // 获取当前状态的文本描述
-	std::tuple<size_t, size_t, size_t> count_processor_states(
-		const auto& resources
-	) const;  // 统计处理器状态数量（运行中、空闲、错误）
 	void add_exit_confirm_window();
 };
\ No newline at end of file
@@ -50,4 +50,7 @@ class Popup_manager
 
 	// 添加新弹窗
 	void open_window(Window window);
+
+	// 正在显示的弹窗数量，只能在绘制线程中调用
+	size_t get_window_count() const { return windows.size(); }
 };
\ No newline at end of file
@@ -16,6 +16,7 @@ struct UI_settings
 	float grid_size = 20.0f;
 	bool snap_to_grid = false;
 	int side_panel_width = 300;
+	bool idle_throttle = true;  // 空闲时降低刷新率
 
 	Json::Value serialize() const;
 	void deserialize(const Json::Value& json);
@@ -32,6 +33,17 @@ struct Editor_settings
 	void deserialize(const Json::Value& json);
 };
 
+// 音频设置
+struct Audio_settings
+{
+	int device_buffer_size = 512;  // 预览时音频设备的缓冲区大小（采样）
+	int preview_block_size = 512;  // 预览时的处理块大小（采样），越小延迟越低
+	int export_block_size = 4096;  // 导出时的处理块大小（采样），越大吞吐量越高
+
+	Json::Value serialize() const;
+	void deserialize(const Json::Value& json);
+};
+
 // 渲染设置
 struct Export_settings
 {
@@ -46,6 +58,7 @@ struct App_settings
 {
 	UI_settings ui;
 	Editor_settings editor;
+	Audio_settings audio;
 	Export_settings export_settings;
 
 	Json::Value serialize() const;
@@ -77,5 +90,6 @@ class Settings_window
 
 	void draw_ui_tab();
 	void draw_editor_tab();
+	void draw_audio_tab();
 	void draw_export_tab();
 };
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "utility/audio-device.hpp"
+
 #include <SDL2/SDL.h>
+#include <memory>
 #include <span>
 #include <stdexcept>
 
@@ -10,7 +13,7 @@ class SDL_context
 {
 	SDL_Window* window = nullptr;
 	SDL_Renderer* renderer = nullptr;
-	SDL_AudioDeviceID audio_device;
+	std::shared_ptr<Audio_device> audio_device;
 	bool sdl_initialized = false;
 
   public:
@@ -19,7 +22,11 @@ class SDL_context
 
 	SDL_Window* get_window_ptr() const { return window; }
 	SDL_Renderer* get_renderer_ptr() const { return renderer; }
-	SDL_AudioDeviceID get_audio_device() const { return audio_device; }
+	const std::shared_ptr<Audio_device>& get_audio_device() const { return audio_device; }
+
+	// 以新的缓冲区大小与采样率重新打开音频设备
+	// - 正在使用旧设备的预览会继续持有旧设备，直到结束
+	void reopen_audio_device(int buffer_size, int sample_rate);
 
 	~SDL_context();
 };
@@ -0,0 +1,115 @@
+// graph-history.hpp
+// 节点图的撤销/重做记录
+
+#pragma once
+
+#include "graph.hpp"
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+
+namespace infra
+{
+	// 节点图的撤销/重做记录
+	// - 每一步只记录变化的节点与连结（修改前后的状态），内存开销与修改规模成正比
+	// - 节点状态包括处理器的序列化参数，参数修改同样可以撤销
+	// - 撤销时只重新生成参数变化的处理器，只移动了位置的节点保留原有的处理器
+	// - 未变化的节点参数在各步之间共享，不会重复保存
+	// - 记录时只重新序列化新增、处理器被替换或通过mark_pending()标记的节点，其余节点只比较位置
+	class Graph_history
+	{
+		// 节点的一个状态，创建后不再修改
+		struct Node_record
+		{
+			std::string identifier;                  // 处理器标识名
+			std::shared_ptr<const Json::Value> info;  // 处理器的序列化参数
+			ImVec2 position;
+		};
+
+		// 连结以节点ID与引脚名记录，引脚ID在重新生成节点后会变化
+		struct Link_record
+		{
+			Id_t from_node;
+			std::string from_pin;
+			Id_t to_node;
+			std::string to_pin;
+
+			auto operator<=>(const Link_record&) const = default;
+		};
+
+		// 图的一个状态，只在记录器内部保留一份
+		struct Snapshot
+		{
+			std::map<Id_t, std::shared_ptr<const Node_record>> nodes;
+			std::set<Link_record> links;
+			int sample_rate = 0;
+		};
+
+		// 两个相邻状态之间的差异，节点状态为nullptr表示节点不存在
+		struct Delta
+		{
+			std::map<Id_t, std::pair<std::shared_ptr<const Node_record>, std::shared_ptr<const Node_record>>>
+				nodes;
+			std::set<Link_record> removed_links, added_links;
+			int sample_rate_before = 0, sample_rate_after = 0;
+		};
+
+		Snapshot tracked;  // 上一次记录时图的状态
+		std::map<Id_t, std::weak_ptr<const Processor>> tracked_processors;  // 上一次记录时各节点的处理器
+		std::set<Id_t> dirty_nodes;  // 参数可能已被修改，下一次记录时需要重新序列化的节点
+		std::deque<Delta> undo_log, redo_log;
+		size_t max_levels;
+		bool pending = false;  // 是否有尚未记录的修改
+
+		// 记录图的当前状态，同时更新tracked_processors
+		Snapshot take_snapshot(const Graph& graph);
+		static std::optional<Delta> diff(const Snapshot& before, const Snapshot& after);
+
+		// 将图从一个状态切换到另一个状态
+		// - forward为true时应用修改后的状态，否则应用修改前的状态
+		static void apply(Graph& graph, const Delta& delta, bool forward);
+		static void apply(Snapshot& snapshot, const Delta& delta, bool forward);
+
+		// 应用差异后，更新被修改节点的处理器记录
+		void track_processors(const Graph& graph, const Delta& delta);
+
+	  public:
+
+		Graph_history(size_t max_levels = 30);
+
+		// 设置最多保留的撤销步数
+		void set_max_levels(size_t levels);
+
+		// 即将修改图，在修改前调用
+		// - 先记录此前未记录的修改（如移动节点），再标记新的修改
+		// - 新的修改会清空重做记录
+		void begin_edit(const Graph& graph);
+
+		// 标记节点的参数已被修改，修改内容在下一次记录时计算
+		void mark_pending(Id_t node)
+		{
+			pending = true;
+			dirty_nodes.insert(node);
+		}
+
+		// 将上一次记录以来的修改记录为一步
+		// - 没有修改时不记录，返回false
+		bool commit(const Graph& graph);
+
+		// 撤销/重做一步，没有可撤销/重做的步骤时返回false
+		bool undo(Graph& graph);
+		bool redo(Graph& graph);
+
+		// 丢弃所有记录，以图的当前状态为起点
+		void reset(const Graph& graph);
+
+		bool can_undo() const { return pending || !undo_log.empty(); }
+		bool can_redo() const { return !redo_log.empty(); }
+
+		size_t undo_size() const { return undo_log.size(); }
+		size_t redo_size() const { return redo_log.size(); }
+	};
+}
@@ -7,9 +7,13 @@
 
 #include <algorithm>
 #include <imgui.h>
+#include <iosfwd>
 #include <memory>
 #include <ranges>
 #include <set>
+#include <span>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
@@ -57,6 +61,7 @@ namespace infra
 		std::map<Id_t, Link> links;                      // 连结
 		std::map<std::string, Id_t> singleton_node_map;  // 存储单例节点的映射
 		bool modified = false;
+		int sample_rate = 0;  // 工程采样率，0表示按输入文件自动选择
 
 	  private:
 
@@ -81,6 +86,10 @@ namespace infra
 			return first->first + 1;
 		}
 
+		// 为新加入的节点按顺序创建引脚，从next_pin_id开始分配ID
+		// - 调用者保证分配的ID大于图中已有的所有引脚ID
+		void add_node_pins(Id_t id, Node& node, Id_t& next_pin_id);
+
 	  public:
 
 		/* 错误类型 */
@@ -184,12 +193,88 @@ namespace infra
 
 		/* 序列化/反序列化 */
 
+		// 批量构建使用的节点描述
+		struct Node_description
+		{
+			Id_t id;
+			std::shared_ptr<Processor> processor;
+			ImVec2 position;
+		};
+
+		// 批量构建使用的连结描述，引脚以名称给出
+		struct Link_description
+		{
+			Id_t from_node;
+			std::string from_pin;
+			Id_t to_node;
+			std::string to_pin;
+		};
+
+		// 由标识名生成处理器并载入参数，标识名未知时抛出 Invalid_file_error 异常
+		static std::shared_ptr<Processor> create_processor(
+			const std::string& identifier,
+			const Json::Value& info
+		);
+
+		// 一次性构建整个图
+		// - 引脚与连结的ID按顺序分配，添加时不逐个检查，全部添加后调用一次check_graph()
+		// - 图无效时抛出 Invalid_file_error 异常
+		static Graph build(
+			std::vector<Node_description> node_list,
+			std::span<const Link_description> link_list
+		);
+
 		// 序列化图为JSON
-		Json::Value serialize() const;
+		// - 节点位置加上`position_offset`后写入
+		Json::Value serialize(ImVec2 position_offset = ImVec2(0, 0)) const;
+
+		// 序列化图为JSON并直接写入流
+		// - 逐个节点生成JSON，不生成整个图的JSON树，内存占用只取决于最大的单个节点
+		// - 节点位置加上`position_offset`后写入
+		void serialize(std::ostream& stream, ImVec2 position_offset = ImVec2(0, 0)) const;
 
 		// 反序列化图为Graph对象
 		// - 注意：不含错误处理，需要调用者处理错误
 		// - 处理失败时会抛出 Invalid_file_error 异常
 		static Graph deserialize(const Json::Value& value);
+
+		// 从流中读取JSON并反序列化图
+		// - 逐个节点解析，不生成整个图的JSON树
+		// - 处理失败时会抛出 Invalid_file_error 异常
+		static Graph deserialize(std::istream& stream);
+
+		/* 二进制工程格式 */
+
+		// 将serialize()的结果编码为二进制工程格式
+		// - 格式见`src/infra/graph-binary.cpp`，处理器参数仍以紧凑JSON保存
+		static std::string encode_binary(const Json::Value& value);
+
+		// 数据是否以二进制工程格式的文件头开始
+		static bool is_binary(std::string_view data);
+
+		// 从二进制工程格式反序列化图，不经过JSON树
+		// - 处理失败时会抛出 Invalid_file_error 异常
+		static Graph deserialize_binary(std::string_view data);
+
+		/* 子图复制 */
+
+		// 从图中取出的子图，用于复制粘贴
+		// - 节点ID沿用原图的ID，处理器为原处理器的副本，与原图不共享状态
+		struct Subgraph
+		{
+			std::vector<Node_description> nodes;
+			std::vector<Link_description> links;
+		};
+
+		// 取出指定节点组成的子图
+		// - link_ids为空时复制两端都在子图中的所有连结，否则只复制其中两端都在子图中的连结
+		// - 不存在的ID被忽略
+		Subgraph extract(std::span<const Id_t> node_ids, std::span<const Id_t> link_ids) const;
+
+		// 将子图批量插入图中，节点位置加上offset
+		// - 新的节点、引脚与连结ID从各自的最大ID之后顺序分配，不逐个查找空闲ID
+		// - 已存在的单例节点被跳过，连到被跳过节点的连结也被跳过
+		// - 返回子图节点ID到新节点ID的映射
+		std::map<Id_t, Id_t> insert(const Subgraph& subgraph, ImVec2 offset);
 	};
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <any>
+#include <cstdint>
 #include <format>
 #include <functional>
 #include <json/json.h>
@@ -18,7 +19,7 @@ namespace infra
 
 	template <typename T, typename Ty>
 	concept Has_static_processor_info_func = requires {
-		{ T::get_processor_info() } -> std::same_as<Ty>;
+		{ T::get_processor_info() } -> std::same_as<const Ty&>;
 	};
 
 	// 处理器基类
@@ -33,9 +34,22 @@ namespace infra
 		{
 		  public:
 
+			// 产品内部缓冲区的统计
+			struct Buffer_stats
+			{
+				size_t buffered;       // 当前缓冲的数据块数量
+				size_t capacity;       // 缓冲区容量
+				uint64_t transferred;  // 累计传递的数据块数量
+				uint64_t stalls;       // 累计下游取空的次数
+			};
+
 			Product() = default;
 			virtual ~Product() = default;
 			const std::type_info& get_typeinfo() const { return typeid(*this); }
+
+			// 获取缓冲区统计，没有缓冲区的产品返回std::nullopt
+			// - 可能在任意线程中调用，实现需要保证线程安全
+			virtual std::optional<Buffer_stats> get_buffer_stats() const { return std::nullopt; }
 		};
 
 		// 描述处理器的输入/输出端口属性（元数据）
@@ -87,7 +101,8 @@ namespace infra
 
 		// 获取处理器的元数据
 		// - 注意，基类中需要实现一个静态的get_processor_info()函数供注册时使用
-		virtual Processor::Info get_processor_info_non_static() const = 0;
+		// - 元数据只生成一次（静态局部变量），返回引用，调用时不复制字符串
+		virtual const Processor::Info& get_processor_info_non_static() const = 0;
 
 		// 将模块设置/信息导出为JSON
 		virtual Json::Value serialize() const = 0;
@@ -95,9 +110,17 @@ namespace infra
 		// 从serialize()导出的JSON中恢复得到信息
 		virtual void deserialize(const Json::Value& value) = 0;
 
+		// 复制处理器的参数，生成新的处理器实例（不复制运行时状态）
+		// - 默认经过serialize()/deserialize()复制，处理器可以重写为直接复制成员
+		virtual std::unique_ptr<Processor> clone() const;
+
 		// 绘制UI节点标题
 		virtual void draw_title() = 0;
 
+		// 在节点本体中绘制预览（如波形），位于标题栏与端口之间
+		// - 每帧为所有节点调用，实现应当只做廉价的绘制；默认不绘制
+		virtual void draw_preview() {}
+
 		// 绘制UI节点内容
 		// - 若属性被修改，则返回true，否则返回false
 		// - 注意：这个接口后续可能还有大改动
@@ -112,12 +135,18 @@ namespace infra
 			std::any& user_data
 		) = 0;
 
+		// 尝试与下游处理器融合为一个处理器
+		// - 由Runner在启动前调用，融合后的处理器代替两者运行，省去中间的产品
+		// - 只有单输入单输出、无状态的处理器需要重写，融合结果的引脚标识名必须与两者相同
+		// - 不能融合时返回nullptr（默认）
+		virtual std::shared_ptr<Processor> fuse(const Processor& next [[maybe_unused]]) const { return nullptr; }
+
 		// 静态的注册函数
 		template <typename T>
 			requires(std::is_base_of_v<Processor, T> && Has_static_processor_info_func<T, Processor::Info>)
 		static void register_processor()
 		{
-			const Info processor_info = T::get_processor_info();
+			const Info& processor_info = T::get_processor_info();
 
 			if (processor_map.contains(processor_info.identifier))
 				THROW_LOGIC_ERROR(
@@ -125,7 +154,7 @@ namespace infra
 					processor_info.identifier
 				)
 
-			processor_map[processor_info.identifier] = T::get_processor_info();
+			processor_map[processor_info.identifier] = processor_info;
 		}
 	};
 
@@ -7,9 +7,13 @@
 #include <boost/fiber/mutex.hpp>
 
 #include <any>
+#include <array>
+#include <chrono>
 #include <future>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <utility>
 
 namespace infra
 {
@@ -30,6 +34,28 @@ namespace infra
 			Error      // 处理出现错误
 		};
 
+		static constexpr size_t state_count = 4;
+
+		// 单个连结的运行统计
+		struct Link_metrics
+		{
+			Id_t id;
+			float fill;        // 缓冲区占用比例（0~1）
+			float throughput;  // 传递速率（数据块/秒）
+			uint64_t stalls;   // 统计间隔内下游取空的次数
+		};
+
+		// 运行统计快照，由统计线程按固定间隔发布
+		struct Metrics
+		{
+			uint64_t sequence = 0;                           // 快照序号，从1开始
+			double time = 0;                                 // 距离启动的时间（秒）
+			std::array<size_t, state_count> state_counts{};  // 各状态的处理器数量，以State为下标
+			std::vector<Link_metrics> links;                 // 提供缓冲统计的连结，按ID排序
+		};
+
+		static constexpr auto metrics_interval = std::chrono::milliseconds(100);  // 统计快照的发布间隔
+
 	  private:
 
 		// 聚合了处理器资源的struct
@@ -53,12 +79,25 @@ namespace infra
 		std::map<Id_t, std::shared_ptr<Processor::Product>> link_products;  // 追踪每一个连结对应的产品实例
 		std::map<Id_t, std::shared_ptr<std::any>> node_data;  // 存储节点对应的用户数据（由UI给出）
 
+		std::array<std::atomic<size_t>, state_count> state_counts{};  // 各状态的处理器数量，状态改变时更新
+
+		mutable std::mutex metrics_mutex;
+		Metrics metrics;                             // 最新发布的统计快照
+		std::atomic<uint64_t> metrics_sequence = 0;  // 最新快照的序号
+		std::jthread metrics_thread;                 // 统计线程，声明在被统计的资源之后
+
 		// 生成处理器资源
 		void generate_processor_resources(const Graph& graph);
 
 		// 启动纤程的内核线程
 		void launch_threads();
 
+		// 修改处理器的执行状态，同时更新状态计数
+		void set_state(Processor_resource& resource, State state);
+
+		// 统计线程，按metrics_interval发布统计快照直到被要求停止
+		void publish_metrics(std::stop_token stop_token);
+
 	  public:
 
 		Runner() = default;
@@ -71,15 +110,38 @@ namespace infra
 		~Runner();
 
 		// 根据图和用户数据，创建新的Runner实例并马上返回
+		// - fuse: 是否先融合图中可融合的处理器链（见fuse_processors）
 		static std::unique_ptr<Runner> create_and_run(
 			const Graph& graph,
-			std::map<Id_t, std::shared_ptr<std::any>> node_data
+			std::map<Id_t, std::shared_ptr<std::any>> node_data,
+			bool fuse = true
 		);
 
+		// 融合图中首尾相连的可融合处理器，返回融合后的图
+		// - 上游只有一条输出连结、下游只有一条输入连结，且Processor::fuse()成功时才融合
+		// - 融合后的节点沿用上游节点的ID与引脚，下游节点与中间的连结被删除
+		// - 原图与其中的处理器不会被修改
+		static Graph fuse_processors(const Graph& graph);
+
 		// 获取处理器资源集合，可用于检测执行状态细节
 		const auto& get_processor_resources() const { return processor_resources; }
 
 		// 获取连结对应的产品实例，可用于检测执行状态细节
 		const auto& get_link_products() const { return link_products; }
+
+		// 获取处于某一状态的处理器数量，不需要遍历处理器资源
+		size_t get_state_count(State state) const { return state_counts[std::to_underlying(state)].load(); }
+
+		// 是否所有处理器都已处理完成
+		bool is_finished() const { return get_state_count(State::Finished) == processor_resources.size(); }
+
+		// 获取第一个出错的处理器抛出的错误，没有处理器出错时返回std::nullopt
+		std::optional<std::any> get_error() const;
+
+		// 最新统计快照的序号，序号不变时不需要重新获取快照
+		uint64_t get_metrics_sequence() const { return metrics_sequence.load(); }
+
+		// 获取最新发布的统计快照，尚未发布时序号为0
+		Metrics get_metrics() const;
 	};
 }
\ No newline at end of file
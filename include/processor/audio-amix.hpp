@@ -47,8 +47,8 @@ namespace processor
 		Audio_amix& operator=(const Audio_amix&) = delete;
 		Audio_amix& operator=(Audio_amix&&) = default;
 
-		static infra::Processor::Info get_processor_info();
-		virtual Processor::Info get_processor_info_non_static() const { return get_processor_info(); }
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
 
 		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
 
@@ -61,6 +61,7 @@ namespace processor
 
 		virtual Json::Value serialize() const;
 		virtual void deserialize(const Json::Value& value);
+		virtual std::unique_ptr<infra::Processor> clone() const;
 
 		virtual void draw_title();
 		virtual bool draw_content(bool readonly);
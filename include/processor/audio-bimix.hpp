@@ -46,8 +46,8 @@ namespace processor
 		Audio_bimix& operator=(const Audio_bimix&) = delete;
 		Audio_bimix& operator=(Audio_bimix&&) = default;
 
-		static infra::Processor::Info get_processor_info();
-		virtual Processor::Info get_processor_info_non_static() const { return get_processor_info(); }
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
 
 		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
 
@@ -60,6 +60,7 @@ namespace processor
 
 		virtual Json::Value serialize() const;
 		virtual void deserialize(const Json::Value& value);
+		virtual std::unique_ptr<infra::Processor> clone() const;
 
 		virtual void draw_title();
 		virtual bool draw_content(bool readonly);
@@ -77,8 +78,8 @@ namespace processor
 		Audio_bimix_v2& operator=(const Audio_bimix_v2&) = delete;
 		Audio_bimix_v2& operator=(Audio_bimix_v2&&) = default;
 
-		static infra::Processor::Info get_processor_info();
-		virtual Processor::Info get_processor_info_non_static() const { return get_processor_info(); }
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
 
 		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
 
@@ -91,6 +92,7 @@ namespace processor
 
 		virtual Json::Value serialize() const;
 		virtual void deserialize(const Json::Value& value);
+		virtual std::unique_ptr<infra::Processor> clone() const { return std::make_unique<Audio_bimix_v2>(); }
 
 		virtual void draw_title();
 		virtual bool draw_content(bool readonly);
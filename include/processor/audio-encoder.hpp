@@ -0,0 +1,84 @@
+// audio-encoder.hpp
+// 导出音频时使用的编码器
+
+#pragma once
+
+#include "utility/file-writer.hpp"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace processor
+{
+	// 导出格式
+	enum class Export_format
+	{
+		Mp3,   // MP3（LAME）
+		Wav,   // 无压缩WAV，直接写入采样
+		Flac,  // FLAC（libavcodec）
+		Opus   // Opus/Ogg（libavcodec）
+	};
+
+	// 导出格式的显示名称
+	std::string_view get_export_format_name(Export_format format);
+
+	// 导出格式的文件扩展名，如"*.mp3"
+	std::string_view get_export_format_pattern(Export_format format);
+
+	// 导出格式是否使用比特率参数
+	bool export_format_has_bitrate(Export_format format);
+
+	// 导出编码器接口
+	// - 所有函数只在导出编码线程中调用
+	// - 编码后的数据通过Double_buffered_writer写入文件
+	class Audio_encoder
+	{
+	  public:
+
+		// 写入结束后需要回填到文件中的数据
+		struct Header_patch
+		{
+			size_t offset;
+			std::vector<std::byte> data;
+		};
+
+		Audio_encoder() = default;
+		virtual ~Audio_encoder() = default;
+
+		Audio_encoder(const Audio_encoder&) = delete;
+		Audio_encoder(Audio_encoder&&) = delete;
+		Audio_encoder& operator=(const Audio_encoder&) = delete;
+		Audio_encoder& operator=(Audio_encoder&&) = delete;
+
+		virtual bool is_initialized() const = 0;
+
+		// 根据第一帧的参数初始化编码器，需要时写入文件头
+		virtual void initialize(const AVFrame& frame, Double_buffered_writer& writer) = 0;
+
+		// 编码静音，sample_count为第一帧采样率下的采样数
+		virtual void encode_silence(int64_t sample_count, Double_buffered_writer& writer) = 0;
+
+		// 编码一帧音频
+		virtual void encode_frame(const AVFrame& frame, Double_buffered_writer& writer) = 0;
+
+		// 冲刷编码器内部剩余的数据
+		virtual void flush(Double_buffered_writer& writer) = 0;
+
+		// 获取需要回填的文件头，在flush()之后有效
+		virtual std::optional<Header_patch> get_header_patch() const { return std::nullopt; }
+	};
+
+	// 创建编码器
+	// - kbps: 比特率，仅对MP3与Opus有效
+	// - parallel_encode: 分段并行编码，仅对MP3有效
+	std::unique_ptr<Audio_encoder> create_audio_encoder(Export_format format, size_t kbps, bool parallel_encode);
+}
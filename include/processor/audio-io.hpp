@@ -2,8 +2,11 @@
 // 提供音频输入流处理器
 
 #include "infra/processor.hpp"
+#include "processor/audio-encoder.hpp"
 #include "processor/audio-stream.hpp"
+#include "processor/waveform.hpp"
 #include "third-party/ui.hpp"
+#include "utility/audio-device.hpp"
 
 #include <SDL_audio.h>
 
@@ -16,11 +19,16 @@ namespace processor
 {
 	// 音频输入处理器
 	// - 负责读取与解码音频文件
+	// - 在节点中显示各输入文件的波形，波形在后台生成并缓存
 	class Audio_input : public infra::Processor
 	{
 		size_t file_count = 1;
 		std::optional<size_t> remove_index;
 		std::vector<std::string> file_paths = {""};
+		std::vector<std::unique_ptr<Waveform>> waveforms;  // 与file_paths一一对应，路径为空时为nullptr
+
+		// 使waveforms与file_paths一致，路径变化时重新生成对应的波形
+		void sync_waveforms();
 
 	  public:
 
@@ -32,8 +40,8 @@ namespace processor
 		Audio_input& operator=(const Audio_input&) = delete;
 		Audio_input& operator=(Audio_input&&) = delete;
 
-		static infra::Processor::Info get_processor_info();
-		virtual Processor::Info get_processor_info_non_static() const { return get_processor_info(); }
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
 
 		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
 		virtual void process_payload(
@@ -45,9 +53,16 @@ namespace processor
 
 		virtual Json::Value serialize() const;
 		virtual void deserialize(const Json::Value& value);
+		virtual std::unique_ptr<infra::Processor> clone() const;
 
 		virtual void draw_title();
+		virtual void draw_preview();
 		virtual bool draw_content(bool readonly);
+
+		// 探测各输入文件的采样率，用于自动选择工程采样率
+		// - 只读取文件头，无法打开的文件被跳过
+		// - 波形已生成时直接使用其中记录的采样率；探测结果按文件大小与修改时间缓存，在UI线程调用时不会重复打开文件
+		std::vector<int> probe_sample_rates() const;
 	};
 
 	// 音频输出处理器
@@ -63,16 +78,18 @@ namespace processor
 		{
 			bool do_export;
 			std::string export_path = "";
+			Export_format format = Export_format::Mp3;
 			size_t kbps = 0;
+			bool parallel_encode = false;  // 分段并行编码（仅导出MP3时有效）
 			std::shared_ptr<std::atomic<double>> time = std::make_shared<std::atomic<double>>(0.0);
-			SDL_AudioDeviceID audio_device = 0;
+			std::shared_ptr<Audio_device> audio_device;
 		};
 
 	  private:
 
 		void do_preview(
 			Audio_stream& input_stream,
-			SDL_AudioDeviceID audio_device,
+			Audio_device& audio_device,
 			const std::atomic<bool>& stop_token
 		);
 
@@ -92,8 +109,8 @@ namespace processor
 		Audio_output& operator=(const Audio_output&) = delete;
 		Audio_output& operator=(Audio_output&&) = delete;
 
-		static infra::Processor::Info get_processor_info();
-		virtual Processor::Info get_processor_info_non_static() const { return get_processor_info(); }
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
 
 		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
 		virtual void process_payload(
@@ -105,6 +122,7 @@ namespace processor
 
 		virtual Json::Value serialize() const { return {}; }
 		virtual void deserialize(const Json::Value& value) {}
+		virtual std::unique_ptr<infra::Processor> clone() const { return std::make_unique<Audio_output>(); }
 
 		virtual void draw_title();
 		virtual bool draw_content(bool readonly);
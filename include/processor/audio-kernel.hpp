@@ -0,0 +1,50 @@
+// audio-kernel.hpp
+// 处理器内部使用的采样处理内核，单独导出以便基准测试
+
+#pragma once
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace processor
+{
+	// 原地调节音量
+	// - data: 各声道的数据指针，交错格式时只有一个声道
+	// - channel_count: 数据指针的个数
+	// - element_count: 每个数据指针中的采样个数
+	template <typename T>
+	void change_volume(uint8_t* const* data, int channel_count, int element_count, float volume)
+	{
+		const auto typed_data = reinterpret_cast<T* const*>(data);
+
+		for (int ch = 0; ch < channel_count; ch++)
+		{
+			[[assume(typed_data[ch] != nullptr)]];
+			[[assume(element_count > 0)]];
+
+			for (int i = 0; i < element_count; i++) typed_data[ch][i] *= volume;
+		}
+	}
+
+	// 按音量混合多路平面双声道float采样
+	// - inputs: 每一路输入的声道指针数组，每路都必须有左右两个声道
+	// - volumes: 每一路输入的音量，长度与inputs相同
+	// - 每一路都至少有sample_count个采样，输出不能与输入重叠
+	void mix_stereo_planar(
+		float* out_left,
+		float* out_right,
+		std::span<uint8_t** const> inputs,
+		std::span<const float> volumes,
+		int sample_count
+	);
+
+	// 将任意受支持格式的音频帧转换为交错float采样
+	// - 不支持的格式抛出 infra::Processor::Runtime_error
+	std::vector<float> extract_samples_interleaved(const AVFrame* frame);
+}
@@ -9,6 +9,7 @@
 extern "C"
 {
 #include <libavformat/avformat.h>
+#include <libavutil/buffer.h>
 }
 
 #include <boost/fiber/buffered_channel.hpp>
@@ -41,12 +42,48 @@ namespace processor
 		const AVFrame& operator*() const;
 	};
 
+	// 音频帧缓冲池
+	// - 反复生成格式与容量相同的帧，帧释放后缓冲区回到池中，稳定运行时不再分配内存
+	// - 池可以先于由其生成的帧销毁，缓冲区在最后一帧释放后才真正释放
+	class Audio_frame_pool
+	{
+		AVSampleFormat format;
+		int sample_rate;
+		AVChannelLayout channel_layout{};
+		int capacity;  // 每帧的采样数
+
+		int plane_count;
+		int linesize;
+		std::unique_ptr<AVBufferPool, void (*)(AVBufferPool*)> pool;
+
+	  public:
+
+		Audio_frame_pool(
+			AVSampleFormat format,
+			int sample_rate,
+			const AVChannelLayout& channel_layout,
+			int capacity
+		);
+		~Audio_frame_pool();
+
+		Audio_frame_pool(const Audio_frame_pool&) = delete;
+		Audio_frame_pool(Audio_frame_pool&&) = delete;
+		Audio_frame_pool& operator=(const Audio_frame_pool&) = delete;
+		Audio_frame_pool& operator=(Audio_frame_pool&&) = delete;
+
+		// 取出一帧，nb_samples为容量，填充后可以改小
+		// - 时间戳由调用者设置
+		std::shared_ptr<Audio_frame> acquire();
+	};
+
 	// 音频流对象
 	// - 管理与同步音频帧的生产和消费
 	class Audio_stream : public infra::Processor::Product
 	{
 		boost::fibers::buffered_channel<std::shared_ptr<const Audio_frame>> channel;
 		std::atomic<size_t> buffered_frames = 0;
+		std::atomic<uint64_t> pushed_frames = 0;  // 累计推送的帧数
+		std::atomic<uint64_t> empty_pops = 0;     // 未结束时取空的次数
 		std::atomic<bool> end_of_stream;
 
 	  public:
@@ -80,5 +117,15 @@ namespace processor
 
 		// 音频流中暂存的音频帧数量
 		size_t buffered_count() const { return buffered_frames.load(); }
+
+		virtual std::optional<Buffer_stats> get_buffer_stats() const
+		{
+			return Buffer_stats{
+				.buffered = buffered_frames.load(std::memory_order_relaxed),
+				.capacity = config::processor::audio_stream::buffer_size,
+				.transferred = pushed_frames.load(std::memory_order_relaxed),
+				.stalls = empty_pops.load(std::memory_order_relaxed)
+			};
+		}
 	};
 }
\ No newline at end of file
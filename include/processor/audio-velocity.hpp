@@ -4,12 +4,28 @@
 #include "processor/audio-stream.hpp"
 #include "third-party/ui.hpp"
 
+#include <string_view>
+
 namespace processor
 {
+	// SoundTouch的处理质量
+	// - Auto: 预览时使用Fast，导出时使用High
+	// - Fast: 启用快速搜索并缩短序列与搜索窗口，关闭抗混叠滤波器，适合实时预览
+	// - High: SoundTouch的默认设置，音质最好
+	enum class Soundtouch_quality
+	{
+		Auto,
+		Fast,
+		High
+	};
+
+	std::string_view get_soundtouch_quality_name(Soundtouch_quality quality);
+
 	class Velocity_modifier : public infra::Processor
 	{
 		float velocity = 1;
 		bool keep_pitch = false;
+		Soundtouch_quality quality = Soundtouch_quality::Auto;
 
 	  public:
 
@@ -21,8 +37,8 @@ namespace processor
 		Velocity_modifier& operator=(const Velocity_modifier&) = delete;
 		Velocity_modifier& operator=(Velocity_modifier&&) = delete;
 
-		static infra::Processor::Info get_processor_info();
-		virtual Processor::Info get_processor_info_non_static() const { return get_processor_info(); }
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
 
 		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
 		virtual void process_payload(
@@ -34,6 +50,7 @@ namespace processor
 
 		virtual Json::Value serialize() const;
 		virtual void deserialize(const Json::Value& value);
+		virtual std::unique_ptr<infra::Processor> clone() const;
 
 		virtual void draw_title();
 		virtual bool draw_content(bool readonly);
@@ -42,6 +59,7 @@ namespace processor
 	class Pitch_modifier : public infra::Processor
 	{
 		float pitch = 0;
+		Soundtouch_quality quality = Soundtouch_quality::Auto;
 
 	  public:
 
@@ -53,8 +71,8 @@ namespace processor
 		Pitch_modifier& operator=(const Pitch_modifier&) = delete;
 		Pitch_modifier& operator=(Pitch_modifier&&) = delete;
 
-		static infra::Processor::Info get_processor_info();
-		virtual Processor::Info get_processor_info_non_static() const { return get_processor_info(); }
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
 
 		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
 		virtual void process_payload(
@@ -66,6 +84,7 @@ namespace processor
 
 		virtual Json::Value serialize() const;
 		virtual void deserialize(const Json::Value& value);
+		virtual std::unique_ptr<infra::Processor> clone() const;
 
 		virtual void draw_title();
 		virtual bool draw_content(bool readonly);
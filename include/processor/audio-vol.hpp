@@ -5,6 +5,7 @@
 
 #include "infra/processor.hpp"
 #include "processor/audio-stream.hpp"
+#include "processor/sample-processor.hpp"
 #include "third-party/ui.hpp"
 
 #include <SDL_audio.h>
@@ -29,7 +30,8 @@ namespace processor
 
 	// 音量调节处理器
 	// - 负责更改音频音量
-	class Audio_vol : public infra::Processor
+	// - 逐采样处理，相连的音量调节处理器在运行时会被融合
+	class Audio_vol : public Sample_processor
 	{
 		float volume = 1.0;
 
@@ -43,19 +45,14 @@ namespace processor
 		Audio_vol& operator=(const Audio_vol&) = delete;
 		Audio_vol& operator=(Audio_vol&&) = default;
 
-		static infra::Processor::Info get_processor_info();
-		virtual Processor::Info get_processor_info_non_static() const { return get_processor_info(); }
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
 
-		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
-		virtual void process_payload(
-			const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
-			const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
-			const std::atomic<bool>& stop_token,
-			std::any& user_data
-		);
+		virtual std::vector<Sample_kernel> get_sample_kernels() const;
 
-		virtual Json::Value serialize() const { return {}; }
-		virtual void deserialize(const Json::Value& value) {}
+		virtual Json::Value serialize() const;
+		virtual void deserialize(const Json::Value& value);
+		virtual std::unique_ptr<infra::Processor> clone() const;
 
 		virtual void draw_title();
 		virtual bool draw_content(bool readonly);
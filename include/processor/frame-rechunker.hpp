@@ -0,0 +1,91 @@
+// frame-rechunker.hpp
+// 将任意长度的音频帧重新切分为固定长度的块
+
+#pragma once
+
+#include "processor/audio-stream.hpp"
+#include "utility/sw-resample.hpp"
+
+extern "C"
+{
+#include <libavutil/audio_fifo.h>
+}
+
+#include <memory>
+#include <optional>
+
+namespace processor
+{
+	// 当前运行应使用的重采样质量，导出时为高质量预设
+	Audio_resampler::Quality get_resample_quality();
+
+	// 音频帧重新分块器
+	// - 写入任意长度的音频帧，取出长度恰好为block_size的块，流结束后最后一块可以不足
+	// - 输出块的时间戳以采样为单位（time_base = 1/采样率），从第一帧的时间戳开始连续递增
+	// - 给出输出格式时，先转换采样格式、采样率与声道布局再分块；否则保持第一帧的格式
+	// - 输入已经是输出格式时不经过转换，直接写入FIFO
+	class Frame_rechunker
+	{
+		int block_size;
+		std::optional<Audio_resampler::Format> target_format;
+		Audio_resampler::Quality quality;
+
+		std::unique_ptr<AVAudioFifo, void (*)(AVAudioFifo*)> fifo;
+		std::unique_ptr<Audio_resampler> resampler;
+		Audio_frame resample_buffer;  // 重采样结果的暂存区，容量不足时重新分配
+
+		// 输入格式，用于检查后续帧
+		AVSampleFormat input_sample_format = AV_SAMPLE_FMT_NONE;
+		int input_sample_rate = 0;
+		int input_channels = 0;
+
+		// 输出格式
+		AVSampleFormat format = AV_SAMPLE_FMT_NONE;
+		int sample_rate = 0;
+		AVChannelLayout channel_layout{};
+
+		int64_t next_pts = 0;
+		bool finished = false;
+
+		void initialize(const AVFrame& frame);
+		int write_resampled(const uint8_t* const* data, int sample_count);
+
+	  public:
+
+		Frame_rechunker(
+			int block_size,
+			std::optional<Audio_resampler::Format> target_format = std::nullopt,
+			Audio_resampler::Quality quality = Audio_resampler::Quality::Preview
+		);
+		~Frame_rechunker();
+
+		Frame_rechunker(const Frame_rechunker&) = delete;
+		Frame_rechunker(Frame_rechunker&&) = delete;
+		Frame_rechunker& operator=(const Frame_rechunker&) = delete;
+		Frame_rechunker& operator=(Frame_rechunker&&) = delete;
+
+		// 写入一帧
+		// - 不转换格式时，帧的采样格式、采样率与声道数必须与第一帧相同
+		void push(const AVFrame& frame);
+
+		// 通知输入已经结束，之后可以取出不足一块的剩余数据
+		void finish();
+
+		// 从音频流中读取帧，直到可以取出一块或者流已经结束
+		// - 返回false表示流中暂时没有数据，需要让出纤程后重试
+		bool fill_from(Audio_stream& stream);
+
+		// 是否可以取出一块
+		bool ready() const;
+
+		// 输入已经结束且所有数据都已取出
+		bool drained() const { return finished && available() == 0; }
+
+		// 暂存的采样数
+		int available() const;
+
+		// 取出一块，不能取出时返回nullptr
+		// - pad_to: 块长度不足该值时，以静音补齐到该长度；时间戳仍按实际采样数递增
+		std::shared_ptr<Audio_frame> pop(int pad_to = 0);
+	};
+}
@@ -0,0 +1,80 @@
+// null-sink.hpp
+// 提供丢弃输入并统计信息的终端处理器
+
+#pragma once
+
+#include "infra/processor.hpp"
+#include "processor/audio-stream.hpp"
+#include "third-party/ui.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace processor
+{
+	// 空终端处理器
+	// - 以最快速度消耗输入音频流，不播放也不编码，可以在图中存在多个
+	// - 统计采样数、帧数、耗时、峰值、RMS与PCM数据的校验和
+	// - 统计值在处理过程中持续更新，UI线程与无界面的调用者都可以随时读取
+	class Null_sink : public infra::Processor
+	{
+	  public:
+
+		// 一次运行的统计结果
+		struct Stats
+		{
+			uint64_t samples;   // 每声道的采样数
+			uint64_t frames;    // 收到的音频帧数
+			double wall_time;   // 从开始处理到当前（或结束）经过的时间（秒）
+			float peak;         // 峰值幅度（线性，满幅为1）
+			double rms;         // 均方根幅度（线性）
+			uint64_t checksum;  // PCM原始数据的FNV-1a校验和
+			int sample_rate;    // 最后一帧的采样率
+			int channels;       // 最后一帧的声道数
+			bool running;       // 是否正在处理
+		};
+
+	  private:
+
+		std::atomic<uint64_t> sample_count = 0;
+		std::atomic<uint64_t> frame_count = 0;
+		std::atomic<uint64_t> start_time = 0;  // 开始处理的时刻（steady_clock，纳秒）
+		std::atomic<uint64_t> end_time = 0;    // 结束处理的时刻，为0时表示尚未结束
+		std::atomic<float> peak = 0;
+		std::atomic<double> sum_squares = 0;   // 所有声道采样的平方和
+		std::atomic<uint64_t> checksum = 0;
+		std::atomic<int> sample_rate = 0;
+		std::atomic<int> channels = 0;
+
+	  public:
+
+		Null_sink() = default;
+		virtual ~Null_sink() = default;
+
+		Null_sink(const Null_sink&) = delete;
+		Null_sink(Null_sink&&) = delete;
+		Null_sink& operator=(const Null_sink&) = delete;
+		Null_sink& operator=(Null_sink&&) = delete;
+
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
+
+		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
+		virtual void process_payload(
+			const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
+			const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
+			const std::atomic<bool>& stop_token,
+			std::any& user_data
+		);
+
+		virtual Json::Value serialize() const { return {}; }
+		virtual void deserialize(const Json::Value& value [[maybe_unused]]) {}
+		virtual std::unique_ptr<infra::Processor> clone() const { return std::make_unique<Null_sink>(); }
+
+		virtual void draw_title();
+		virtual bool draw_content(bool readonly);
+
+		// 获取统计结果，可在任意线程调用
+		Stats get_stats() const;
+	};
+}
@@ -0,0 +1,93 @@
+// sample-processor.hpp
+// 无状态逐采样处理器的基类，以及由其融合而成的处理器
+
+#pragma once
+
+#include "infra/processor.hpp"
+#include "processor/audio-stream.hpp"
+#include "third-party/ui.hpp"
+
+extern "C"
+{
+#include <libavutil/samplefmt.h>
+}
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace processor
+{
+	// 逐采样处理内核
+	// - 原地处理采样，每个采样的结果只依赖于它自身
+	// - data: 各平面的数据指针，交错格式时只有一个平面
+	// - plane_count: 平面个数
+	// - element_count: 每个平面中的采样个数
+	// - format: 采样格式，只会是FLT、S16、S32及其平面格式
+	using Sample_kernel = std::function<
+		void(AVSampleFormat format, uint8_t* const* data, int plane_count, int element_count)>;
+
+	// 无状态逐采样处理器
+	// - 只有一个"input"输入引脚和一个"output"输出引脚
+	// - 子类只需要给出处理内核，逐帧收发由基类完成
+	// - 相连的逐采样处理器在运行时会被融合为一个Fused_sample_processor，
+	//   每一帧分块依次执行所有内核，数据在缓存中只经过一次
+	class Sample_processor : public infra::Processor
+	{
+	  public:
+
+		Sample_processor() = default;
+		virtual ~Sample_processor() = default;
+
+		Sample_processor(const Sample_processor&) = delete;
+		Sample_processor(Sample_processor&&) = default;
+		Sample_processor& operator=(const Sample_processor&) = delete;
+		Sample_processor& operator=(Sample_processor&&) = default;
+
+		// 获取处理内核，按顺序执行
+		// - 内核捕获当前的参数，调用后参数的修改不影响已获取的内核
+		virtual std::vector<Sample_kernel> get_sample_kernels() const = 0;
+
+		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
+		virtual void process_payload(
+			const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
+			const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
+			const std::atomic<bool>& stop_token,
+			std::any& user_data
+		);
+
+		virtual std::shared_ptr<infra::Processor> fuse(const infra::Processor& next) const;
+	};
+
+	// 由多个逐采样处理器融合而成的处理器
+	// - 只由Runner在启动时创建，不出现在编辑器中，也不会被序列化
+	class Fused_sample_processor : public Sample_processor
+	{
+		std::vector<Sample_kernel> kernels;
+		std::vector<std::string> names;  // 被融合的处理器的显示名称
+		infra::Processor::Info info;     // 显示名称由被融合的处理器组成，创建时生成一次
+
+	  public:
+
+		Fused_sample_processor(std::vector<Sample_kernel> kernels, std::vector<std::string> names);
+
+		virtual ~Fused_sample_processor() = default;
+
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return info; }
+
+		virtual std::vector<Sample_kernel> get_sample_kernels() const { return kernels; }
+
+		const std::vector<std::string>& get_names() const { return names; }
+
+		virtual Json::Value serialize() const { return {}; }
+		virtual void deserialize(const Json::Value& value [[maybe_unused]]) {}
+		virtual std::unique_ptr<infra::Processor> clone() const
+		{
+			return std::make_unique<Fused_sample_processor>(kernels, names);
+		}
+
+		virtual void draw_title() {}
+		virtual bool draw_content(bool readonly [[maybe_unused]]) { return false; }
+	};
+}
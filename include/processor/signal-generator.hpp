@@ -0,0 +1,74 @@
+// signal-generator.hpp
+// 提供合成信号源处理器
+
+#pragma once
+
+#include "infra/processor.hpp"
+#include "processor/audio-stream.hpp"
+#include "third-party/ui.hpp"
+
+#include <string_view>
+
+namespace processor
+{
+	// 信号发生器
+	// - 生成正弦波、白噪声、粉红噪声、脉冲或静音，不依赖磁盘上的文件
+	// - 启动时预先计算一段周期性的采样表，输出帧直接从表中复制，生成开销可以忽略
+	// - 输出结果是确定的，可用于测量纯DSP与调度的吞吐量
+	class Signal_generator : public infra::Processor
+	{
+	  public:
+
+		enum class Waveform
+		{
+			Sine,        // 正弦波
+			White_noise,  // 白噪声
+			Pink_noise,  // 粉红噪声
+			Impulse,     // 脉冲，每个采样表周期一个
+			Silence      // 静音
+		};
+
+	  private:
+
+		Waveform waveform = Waveform::Sine;
+		float frequency = 440;   // 正弦波频率（Hz）
+		float amplitude = 0.5;   // 峰值幅度
+		float duration = 10;     // 时长（秒）
+		int sample_rate = 48000;
+		int channels = 2;
+
+		// 生成交错的采样表，长度为整数个周期
+		std::vector<float> generate_table() const;
+
+	  public:
+
+		Signal_generator() = default;
+		virtual ~Signal_generator() = default;
+
+		Signal_generator(const Signal_generator&) = delete;
+		Signal_generator(Signal_generator&&) = delete;
+		Signal_generator& operator=(const Signal_generator&) = delete;
+		Signal_generator& operator=(Signal_generator&&) = delete;
+
+		static const infra::Processor::Info& get_processor_info();
+		virtual const Processor::Info& get_processor_info_non_static() const { return get_processor_info(); }
+
+		virtual std::vector<infra::Processor::Pin_attribute> get_pin_attributes() const;
+		virtual void process_payload(
+			const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
+			const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
+			const std::atomic<bool>& stop_token,
+			std::any& user_data
+		);
+
+		virtual Json::Value serialize() const;
+		virtual void deserialize(const Json::Value& value);
+		virtual std::unique_ptr<infra::Processor> clone() const;
+
+		virtual void draw_title();
+		virtual bool draw_content(bool readonly);
+	};
+
+	// 波形的显示名称
+	std::string_view get_waveform_name(Signal_generator::Waveform waveform);
+}
@@ -0,0 +1,70 @@
+// waveform.hpp
+// 在后台为音频文件生成并缓存波形峰值金字塔
+
+#pragma once
+
+#include "utility/peak-pyramid.hpp"
+
+#include <atomic>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace processor
+{
+	// 一个音频文件的波形
+	// - 创建后立即在后台线程中查找缓存，缓存不存在或已过期时解码整个文件，生成金字塔并写入缓存
+	// - 缓存位于用户缓存目录，以源文件的绝对路径区分，再次打开同一文件时只需要映射缓存
+	// - 析构时请求后台线程停止并等待其结束
+	class Waveform
+	{
+	  public:
+
+		enum class Status
+		{
+			Loading,  // 正在读取缓存或解码
+			Ready,    // 金字塔可用
+			Failed    // 文件无法解码或缓存无法写入
+		};
+
+	  private:
+
+		std::string file_path;
+		std::atomic<Status> status = Status::Loading;
+		std::atomic<float> progress = 0;      // 解码进度（0~1），不知道时长时保持为0
+		std::optional<Peak_pyramid> pyramid;  // 状态变为Ready之后不再修改
+
+		std::vector<Peak_pyramid::Peak> cached_peaks;  // 上一次按宽度查询的结果，只在UI线程访问
+
+		std::jthread thread;  // 声明在最后，析构时先等待线程结束
+
+		void load(std::stop_token stop_token);
+
+	  public:
+
+		explicit Waveform(std::string file_path);
+
+		Waveform(const Waveform&) = delete;
+		Waveform(Waveform&&) = delete;
+		Waveform& operator=(const Waveform&) = delete;
+		Waveform& operator=(Waveform&&) = delete;
+
+		const std::string& get_file_path() const { return file_path; }
+		Status get_status() const { return status.load(); }
+		float get_progress() const { return progress.load(std::memory_order_relaxed); }
+
+		// 获取峰值金字塔，只能在get_status()返回Ready之后调用
+		const Peak_pyramid& get_pyramid() const;
+
+		// 将整个文件按宽度分为若干列，获取每列的峰值
+		// - 只能在UI线程中、get_status()返回Ready之后调用
+		// - 宽度与上一次相同时直接返回缓存的结果，不再查询金字塔
+		std::span<const Peak_pyramid::Peak> get_peaks(int width);
+
+		// 音频文件对应的缓存文件路径
+		static std::string get_cache_path(const std::string& file_path);
+	};
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "config.hpp"
+#include "utility/spsc-queue.hpp"
+
+#include <SDL_audio.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+
+// 音频输出设备
+// - 以回调方式打开SDL音频设备，回调从无锁环形缓冲区中取出采样
+// - 生产者（预览纤程）通过write()写入交错采样，写入与回调均不加锁
+// - 统计欠载次数，并根据回调时刻估算输出延迟
+class Audio_device
+{
+	SDL_AudioDeviceID device_id = 0;
+	int requested_buffer_size;  // 请求的设备缓冲区大小（采样）
+	int buffer_size;            // 实际的设备缓冲区大小（采样）
+	int sample_rate;            // 写入的采样率，与硬件不符时由SDL转换
+
+	Spsc_ring_buffer<config::audio::Buffer_type> ring_buffer;
+
+	std::atomic<bool> streaming = false;         // 生产者正在输出，此时缓冲区不足算作欠载
+	std::atomic<bool> playing = false;           // 设备是否已经开始播放
+	std::atomic<uint64_t> underrun_count = 0;    // 欠载次数
+	std::atomic<uint64_t> last_callback_time = 0;  // 最近一次回调的时刻（SDL性能计数器）
+
+	static void SDLCALL audio_callback(void* userdata, Uint8* stream, int len);
+
+	Audio_device(int requested_buffer_size, int sample_rate);
+
+	// 暂停设备并清空缓冲区
+	void pause_and_clear();
+
+  public:
+
+	Audio_device(const Audio_device&) = delete;
+	Audio_device(Audio_device&&) = delete;
+	Audio_device& operator=(const Audio_device&) = delete;
+	Audio_device& operator=(Audio_device&&) = delete;
+
+	~Audio_device();
+
+	// 打开默认音频设备，失败时返回std::nullopt（可通过SDL_GetError()获取原因）
+	// - buffer_size: 设备缓冲区大小（采样），实际大小可能由系统调整
+	// - sample_rate: 写入的采样率，通常为工程采样率
+	static std::optional<std::unique_ptr<Audio_device>> open(int buffer_size, int sample_rate);
+
+	// 开始输出
+	// - 清空缓冲区，设备在缓冲区达到目标填充量后才开始播放
+	void start();
+
+	// 输入结束，播放缓冲区中剩余的采样
+	// - 之后缓冲区变空不再算作欠载
+	void drain();
+
+	// 停止输出并清空缓冲区
+	void stop();
+
+	// 写入交错采样，返回实际写入的采样个数（总是声道数的整数倍）
+	size_t write(std::span<const config::audio::Buffer_type> samples);
+
+	// 环形缓冲区中尚未播放的帧数
+	size_t get_buffered_frames() const;
+
+	// 生产者应保持的缓冲帧数，超过时应等待
+	size_t get_target_frames() const;
+
+	int get_requested_buffer_size() const { return requested_buffer_size; }
+	int get_sample_rate() const { return sample_rate; }
+
+	struct Stats
+	{
+		uint64_t underruns;     // 欠载次数
+		double latency;         // 估算的输出延迟（秒）
+		size_t buffered_frames;  // 环形缓冲区中的帧数
+		int buffer_size;        // 设备缓冲区大小（采样）
+	};
+
+	Stats get_stats() const;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 双缓冲文件写入器
+// - 调用者向前台缓冲区追加数据，缓冲区写满后与后台缓冲区交换，由写入线程整块落盘
+// - 避免每个小数据块都调用一次write()，也避免磁盘IO阻塞调用者
+// - write()与finish()只允许在同一个线程中调用
+class Double_buffered_writer
+{
+	std::ofstream file;
+
+	std::vector<std::byte> front_buffer;  // 调用者正在填充的缓冲区
+	std::vector<std::byte> back_buffer;   // 写入线程正在落盘的缓冲区
+	size_t buffer_size;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool back_pending = false;  // 后台缓冲区有待写入的数据
+	bool closing = false;       // 请求写入线程退出
+	bool io_failed = false;     // 写入过程中出现错误
+
+	std::jthread write_thread;
+
+	Double_buffered_writer(std::ofstream file, size_t buffer_size);
+
+	// 将前台缓冲区交给写入线程
+	void submit_front_buffer();
+
+  public:
+
+	Double_buffered_writer(const Double_buffered_writer&) = delete;
+	Double_buffered_writer(Double_buffered_writer&&) = delete;
+	Double_buffered_writer& operator=(const Double_buffered_writer&) = delete;
+	Double_buffered_writer& operator=(Double_buffered_writer&&) = delete;
+
+	~Double_buffered_writer();
+
+	// 以二进制方式打开文件，打开失败时返回std::nullopt
+	static std::optional<std::unique_ptr<Double_buffered_writer>> open(
+		const std::string& path,
+		size_t buffer_size
+	);
+
+	// 追加数据
+	void write(std::span<const std::byte> data);
+
+	// 写入所有剩余数据并关闭写入线程
+	// - 返回false代表写入过程中出现了IO错误
+	bool finish();
+
+	// 是否已经出现IO错误
+	bool failed();
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <json/json.h>
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// 流式JSON读取器
+// - 逐字符读取输入流，只在调用者请求时才把单个值解析为Json::Value
+// - 外层的对象与数组以回调的方式遍历，内存占用只取决于最大的单个值
+// - 格式错误时抛出 Json_stream_reader::Parse_error
+class Json_stream_reader
+{
+	std::streambuf& buffer;
+	size_t offset = 0;  // 已读取的字节数，用于错误信息
+
+	std::unique_ptr<Json::CharReader> value_reader;
+
+	int peek();
+	int get();
+	void skip_whitespace();
+	void expect(char c);
+
+	// 读取一个值的原始文本，不解析
+	void capture_value(std::string& output);
+
+  public:
+
+	struct Parse_error : public std::runtime_error
+	{
+		using std::runtime_error::runtime_error;
+	};
+
+	Json_stream_reader(std::istream& stream);
+
+	// 读取一个JSON字符串
+	std::string read_string();
+
+	// 读取一个完整的值并解析
+	Json::Value read_value();
+
+	// 跳过一个值
+	void skip_value();
+
+	// 遍历对象的成员，每个成员调用一次on_member(key)，回调中必须恰好读取或跳过一个值
+	void read_object(const std::function<void(const std::string& key)>& on_member);
+
+	// 遍历数组的元素，每个元素调用一次on_element()，回调中必须恰好读取或跳过一个值
+	void read_array(const std::function<void()>& on_element);
+
+	// 确认输入已经结束（只剩空白）
+	void expect_end();
+};
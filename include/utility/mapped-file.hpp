@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+// 只读内存映射文件
+// - 将整个文件映射到进程地址空间，避免逐块read()带来的拷贝
+// - 依赖于具体系统的实现，见`src/utility/mapped-file.cpp`
+class Mapped_file
+{
+	struct Handle;
+	std::unique_ptr<Handle> handle;
+
+	const std::byte* data_ptr = nullptr;
+	size_t data_size = 0;
+
+	Mapped_file() = default;
+
+  public:
+
+	Mapped_file(const Mapped_file&) = delete;
+	Mapped_file(Mapped_file&&) noexcept;
+	Mapped_file& operator=(const Mapped_file&) = delete;
+	Mapped_file& operator=(Mapped_file&&) noexcept;
+	~Mapped_file();
+
+	// 以只读方式映射文件
+	// - 文件不存在、为空或映射失败时，返回std::nullopt
+	static std::optional<Mapped_file> open(const std::string& path);
+
+	// 提示系统将顺序读取映射区域，以便预读
+	void advise_sequential() const;
+
+	const std::byte* data() const { return data_ptr; }
+	size_t size() const { return data_size; }
+	std::span<const std::byte> bytes() const { return {data_ptr, data_size}; }
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "utility/file-writer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <optional>
+#include <span>
+#include <vector>
+
+// MPEG音频帧头
+struct Mp3_frame_header
+{
+	int version;            // 1 = MPEG-1, 2 = MPEG-2, 3 = MPEG-2.5
+	int bitrate_index;      // 比特率索引（1~14）
+	int sample_rate_index;  // 采样率索引（0~2）
+	int sample_rate;        // 采样率
+	int bitrate;            // 比特率（kbps）
+	bool padding;           // 是否有填充字节
+	bool mono;              // 是否为单声道
+	size_t frame_size;      // 帧长度（字节，含帧头）
+	int frame_samples;      // 每帧采样数
+
+	// 解析Layer III帧头，不是有效的帧头时返回std::nullopt
+	static std::optional<Mp3_frame_header> parse(std::span<const std::byte> data);
+
+	// 边信息（side information）长度
+	size_t side_info_size() const;
+};
+
+// 分段并行MP3编码器
+// - 输入为固定采样率的交错float采样，按帧对齐切分为若干分段，每个分段在独立线程中使用独立的lame_t编码
+// - 每个分段前额外编码若干帧作为预热（priming），后额外编码若干帧作为尾部，输出时丢弃这些帧，
+//   使分段边界处的MDCT重叠与心理声学状态与顺序编码一致
+// - 关闭比特池（bit reservoir），保证每一帧都能独立解码，分段的输出可以直接按帧拼接
+// - 输出为CBR，文件开头预留一个Info帧（Xing/LAME标签），finish()返回其内容，由调用者写回文件开头
+// - 所有函数只允许在同一个线程中调用
+class Segmented_mp3_encoder
+{
+  public:
+
+	struct Params
+	{
+		int sample_rate;
+		int channels;  // 1或2
+		size_t kbps;
+		size_t thread_count;
+	};
+
+  private:
+
+	struct Segment_output
+	{
+		std::vector<std::byte> data;
+		size_t frame_count;
+	};
+
+	Params params;
+
+	int frame_samples;  // 每帧采样数
+	int encoder_delay;  // 编码器延迟（采样）
+	int lowpass_freq;   // 低通滤波频率
+
+	std::vector<float> pcm_buffer;  // 尚未提交的交错采样
+	uint64_t buffer_begin = 0;      // pcm_buffer第一个采样的绝对位置
+	uint64_t segment_begin = 0;     // 下一个分段的起始位置
+	uint64_t total_samples = 0;     // 输入的总采样数
+
+	std::deque<std::future<Segment_output>> pending_segments;  // 按顺序排列的编码任务
+
+	/* 输出统计，用于生成Info帧 */
+
+	std::optional<Mp3_frame_header> first_header;
+	std::vector<std::byte> first_header_bytes;
+	size_t info_frame_size = 0;
+	uint64_t output_frames = 0;
+	uint64_t output_bytes = 0;
+	uint16_t music_crc = 0;
+
+	// 编码一个分段
+	// - skip_frames: 丢弃开头的预热帧数
+	// - keep_frames: 保留的帧数，为空时保留全部剩余帧
+	static Segment_output encode_segment(
+		const Params& params,
+		std::vector<float> pcm,
+		size_t skip_frames,
+		std::optional<size_t> keep_frames
+	);
+
+	// 提交分段[segment_begin, segment_begin + length)，length为空时为最后一个分段
+	void submit_segment(std::optional<uint64_t> length);
+
+	// 写出已完成的分段，wait为true时等待队首分段完成
+	void write_completed(Double_buffered_writer& writer, bool wait);
+
+	void write_segment(Segment_output segment, Double_buffered_writer& writer);
+
+	// 根据输出统计生成Info帧
+	std::vector<std::byte> build_info_frame() const;
+
+	// 尽可能多地提交完整的分段
+	void submit_ready_segments(Double_buffered_writer& writer);
+
+  public:
+
+	explicit Segmented_mp3_encoder(Params params);
+
+	Segmented_mp3_encoder(const Segmented_mp3_encoder&) = delete;
+	Segmented_mp3_encoder(Segmented_mp3_encoder&&) = delete;
+	Segmented_mp3_encoder& operator=(const Segmented_mp3_encoder&) = delete;
+	Segmented_mp3_encoder& operator=(Segmented_mp3_encoder&&) = delete;
+
+	~Segmented_mp3_encoder() = default;
+
+	// 追加交错采样，samples.size()必须为声道数的整数倍
+	void append(std::span<const float> samples, Double_buffered_writer& writer);
+
+	// 追加静音
+	void append_silence(uint64_t sample_count, Double_buffered_writer& writer);
+
+	// 编码所有剩余数据并等待所有分段完成
+	// - 返回Info帧，调用者需要在writer结束后写回文件开头（覆盖预留的空白帧）
+	// - 没有任何输出时返回空数组
+	std::vector<std::byte> finish(Double_buffered_writer& writer);
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "utility/mapped-file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// 波形峰值金字塔
+// - 第0层每个条目概括base_block帧的最小值、最大值与RMS，之后每一层的一个条目合并上一层的level_factor个条目
+// - 所有声道合并为一条波形
+// - 文件通过内存映射读取，打开长音频的金字塔时不需要读入全部数据
+// - 格式见`src/utility/peak-pyramid.cpp`
+class Peak_pyramid
+{
+  public:
+
+	// 一段采样的概括
+	struct Peak
+	{
+		int16_t min;   // 最小值，满幅为-32767
+		int16_t max;   // 最大值，满幅为32767
+		uint16_t rms;  // 均方根，满幅为65535
+	};
+
+	// 源文件的大小与修改时间，用于判断金字塔是否过期
+	struct Source_info
+	{
+		uint64_t size;
+		int64_t modified_time;
+
+		bool operator==(const Source_info&) const = default;
+	};
+
+	static constexpr uint32_t base_block = 256;
+	static constexpr uint32_t level_factor = 4;
+
+	// 金字塔生成器
+	// - 逐块写入采样，全部写入后调用write()生成文件
+	class Builder
+	{
+		std::vector<Peak> base_level;
+		uint64_t total_frames = 0;
+
+		// 当前未满的块
+		float block_min = 0, block_max = 0;
+		double block_sum_squares = 0;
+		uint32_t block_frames = 0;
+		int block_channels = 1;
+
+		void flush_block();
+
+	  public:
+
+		// 写入交错的float采样，samples的长度必须是channels的整数倍
+		void push(std::span<const float> samples, int channels);
+
+		uint64_t get_total_frames() const { return total_frames; }
+
+		// 生成各层并原子地写入文件，返回false代表写入失败
+		bool write(const std::string& path, const Source_info& source, int sample_rate);
+	};
+
+  private:
+
+	Mapped_file file;
+	int sample_rate;
+	uint64_t total_frames;
+	std::vector<std::span<const Peak>> levels;  // 指向映射区域，第0层最精细
+
+	Peak_pyramid(
+		Mapped_file file,
+		int sample_rate,
+		uint64_t total_frames,
+		std::vector<std::span<const Peak>> levels
+	);
+
+  public:
+
+	Peak_pyramid(const Peak_pyramid&) = delete;
+	Peak_pyramid(Peak_pyramid&&) = default;
+	Peak_pyramid& operator=(const Peak_pyramid&) = delete;
+	Peak_pyramid& operator=(Peak_pyramid&&) = default;
+
+	// 读取源文件的大小与修改时间，失败时返回std::nullopt
+	static std::optional<Source_info> get_source_info(const std::string& path);
+
+	// 映射金字塔文件
+	// - 文件损坏、版本不符或与source记录的源文件不一致时，返回std::nullopt
+	static std::optional<Peak_pyramid> open(const std::string& path, const Source_info& source);
+
+	int get_sample_rate() const { return sample_rate; }
+	uint64_t get_total_frames() const { return total_frames; }
+
+	// 计算从first_frame开始、每个像素覆盖frames_per_pixel帧的峰值，结果写入output
+	// - 选择条目不超过一个像素的最粗的一层，每个像素最多合并level_factor + 1个条目
+	// - 超出音频范围的像素为0
+	void query(double first_frame, double frames_per_pixel, std::span<Peak> output) const;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+// 单生产者单消费者的无锁环形缓冲区
+// - 用于批量传递平凡可复制的数据（如音频采样），读写均为无等待操作
+// - 只允许一个线程调用write()，另一个线程调用read()
+// - 容量会向上取整为2的幂
+template <typename T>
+	requires std::is_trivially_copyable_v<T>
+class Spsc_ring_buffer
+{
+	static constexpr size_t cache_line_size = 64;
+
+	const size_t capacity;
+	const size_t mask;
+	std::unique_ptr<T[]> data;
+
+	alignas(cache_line_size) std::atomic<size_t> head = 0;  // 消费者位置
+	alignas(cache_line_size) std::atomic<size_t> tail = 0;  // 生产者位置
+
+  public:
+
+	explicit Spsc_ring_buffer(size_t min_capacity) :
+		capacity(std::bit_ceil(std::max<size_t>(min_capacity, 2))),
+		mask(capacity - 1),
+		data(std::make_unique<T[]>(capacity))
+	{
+	}
+
+	Spsc_ring_buffer(const Spsc_ring_buffer&) = delete;
+	Spsc_ring_buffer(Spsc_ring_buffer&&) = delete;
+	Spsc_ring_buffer& operator=(const Spsc_ring_buffer&) = delete;
+	Spsc_ring_buffer& operator=(Spsc_ring_buffer&&) = delete;
+
+	// 写入尽可能多的元素，返回实际写入的个数
+	// - granularity: 写入个数会向下取整为该值的整数倍（如音频的声道数），保证消费者总是读到完整的单元
+	size_t write(std::span<const T> input, size_t granularity = 1)
+	{
+		const size_t current_tail = tail.load(std::memory_order_relaxed);
+		const size_t free_space = capacity - (current_tail - head.load(std::memory_order_acquire));
+
+		size_t count = std::min(free_space, input.size());
+		count -= count % granularity;
+		if (count == 0) return 0;
+
+		const size_t offset = current_tail & mask;
+		const size_t first_part = std::min(count, capacity - offset);
+		std::copy_n(input.data(), first_part, data.get() + offset);
+		std::copy_n(input.data() + first_part, count - first_part, data.get());
+
+		tail.store(current_tail + count, std::memory_order_release);
+		return count;
+	}
+
+	// 读取尽可能多的元素，返回实际读取的个数
+	size_t read(std::span<T> output)
+	{
+		const size_t current_head = head.load(std::memory_order_relaxed);
+		const size_t available = tail.load(std::memory_order_acquire) - current_head;
+
+		const size_t count = std::min(available, output.size());
+		if (count == 0) return 0;
+
+		const size_t offset = current_head & mask;
+		const size_t first_part = std::min(count, capacity - offset);
+		std::copy_n(data.get() + offset, first_part, output.data());
+		std::copy_n(data.get(), count - first_part, output.data() + first_part);
+
+		head.store(current_head + count, std::memory_order_release);
+		return count;
+	}
+
+	// 丢弃所有元素
+	// - 只能在生产者与消费者都没有访问缓冲区时调用
+	void reset()
+	{
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_release);
+	}
+
+	// 当前元素个数（仅作为参考值）
+	// - 可以在生产者与消费者以外的线程调用，先读head再读tail，结果不会下溢
+	size_t size() const
+	{
+		const size_t current_head = head.load(std::memory_order_acquire);
+		const size_t current_tail = tail.load(std::memory_order_acquire);
+		return std::min(current_tail - current_head, capacity);
+	}
+
+	size_t get_capacity() const { return capacity; }
+};
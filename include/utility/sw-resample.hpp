@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <span>
+#include <string_view>
 #include <vector>
 
 extern "C"
@@ -11,16 +14,64 @@ extern "C"
 }
 
 // 音频重采样器
+// - 输入与输出格式完全相同时直通，只复制数据
+// - 采样率相同、只有采样格式不同（或单声道扩展为立体声）时，由内置的转换内核处理，不经过libswresample
+// - 采样率不同时使用libswresample，滤波器参数由质量预设决定
 class Audio_resampler
 {
-	SwrContext* resampler_context;
-
   public:
 
-	Audio_resampler() :
-		resampler_context(swr_alloc())
+	struct Format
 	{
-	}
+		AVSampleFormat format;
+		int sample_rate;
+		AVChannelLayout channel_layout;
+	};
+
+	// 重采样质量预设，只影响采样率转换
+	// - Preview: 预览使用，滤波器较短，开销较低
+	// - Export: 导出使用，FFmpeg支持时使用soxr引擎，否则使用更长的滤波器
+	enum class Quality
+	{
+		Preview,
+		Export
+	};
+
+	// 工作方式，由create()根据输入输出格式决定
+	enum class Mode
+	{
+		Passthrough,  // 格式完全相同，直接复制
+		Convert,      // 只转换采样格式或声道，逐采样处理，没有延迟
+		Resample      // 转换采样率，使用libswresample
+	};
+
+	// 转换一个声道的内核
+	// - src_stride/dst_stride: 相邻采样之间的间隔（以采样计），平面格式为1，交错格式为声道数
+	using Convert_func
+		= void (*)(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride, int count, float gain);
+
+  private:
+
+	Mode mode = Mode::Passthrough;
+	SwrContext* resampler_context = nullptr;
+
+	// 直通与转换模式使用的格式信息
+	AVSampleFormat input_sample_format = AV_SAMPLE_FMT_NONE;
+	AVSampleFormat output_sample_format = AV_SAMPLE_FMT_NONE;
+	int input_channels = 0;
+	int output_channels = 0;
+	Convert_func convert_func = nullptr;
+	float convert_gain = 1.0f;
+
+	Audio_resampler() = default;
+
+	// 直通与转换模式下处理count个采样
+	void copy_samples(const uint8_t* const* input, uint8_t* const* output, int count) const;
+	void convert_samples(const uint8_t* const* input, uint8_t* const* output, int count) const;
+
+	int process(const uint8_t* const* input, int input_samples, uint8_t* const* output, int output_samples);
+
+  public:
 
 	Audio_resampler(const Audio_resampler&) = delete;
 	Audio_resampler(Audio_resampler&&) = delete;
@@ -28,30 +79,35 @@ class Audio_resampler
 	Audio_resampler& operator=(Audio_resampler&&) = delete;
 	~Audio_resampler();
 
-	struct Format
-	{
-		AVSampleFormat format;
-		int sample_rate;
-		AVChannelLayout channel_layout;
-	};
-
 	// 创建重采样器，需要给出输入和输出的格式
-	static std::optional<std::unique_ptr<Audio_resampler>> create(Format input, Format output);
+	// - quality只在需要转换采样率时生效
+	static std::optional<std::unique_ptr<Audio_resampler>> create(
+		Format input,
+		Format output,
+		Quality quality = Quality::Preview
+	);
+
+	// 质量预设的名称，如"preview/fast"
+	static std::string_view get_quality_name(Quality quality);
+
+	Mode get_mode() const { return mode; }
+	bool is_passthrough() const { return mode == Mode::Passthrough; }
 
-	// 插入静音采样
+	// 插入静音采样，只在重采样模式下可用
 	void inject_silence(int sample_count);
 
-	// 丢弃输出采样
+	// 丢弃输出采样，只在重采样模式下可用
 	void drop_samples(int sample_count);
 
 	// 给出输入采样数，计算输出采样数
 	int calc_samples(int input_samples) const;
 
 	// 计算重采样
-	// - input: 输入采样数据，必须是包含了指针的std::span
+	// - input: 输入采样数据，必须是包含了指针的std::span；为空时冲刷重采样器中残留的采样
 	// - input_samples: 输入采样数
 	// - output: 输出采样数据，必须是包含了指针的std::span
 	// - output_samples: 输出缓冲的最大容量
+	// - 直通与转换模式下没有延迟，输出采样数为输入与容量中的较小者
 	template <typename Input_t, typename Output_t>
 	int resample(
 		std::span<const Input_t* const> input,
@@ -60,12 +116,11 @@ class Audio_resampler
 		size_t output_samples
 	)
 	{
-		return swr_convert(
-			resampler_context,
-			(uint8_t* const* const)output.data(),
-			output_samples,
-			(const uint8_t* const* const)input.data(),
-			input_samples
+		return process(
+			input.empty() ? nullptr : (const uint8_t* const*)input.data(),
+			static_cast<int>(input_samples),
+			(uint8_t* const*)output.data(),
+			static_cast<int>(output_samples)
 		);
 	}
 };
@@ -2,11 +2,30 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <optional>
 #include <string>
+#include <string_view>
 
 // 获取占用内存的大小
 std::optional<size_t> get_working_set_size();
 
 // 打开网页链接
-void open_url(std::string_view url);
\ No newline at end of file
+void open_url(std::string_view url);
+
+// 获取本程序的用户缓存目录，用于存放可以重新生成的数据
+// - Windows下位于%LOCALAPPDATA%，其余系统遵循XDG规范；都不可用时位于临时目录
+// - 目录不一定存在，由调用者创建
+std::string get_cache_directory();
+
+// 原子地替换文件内容
+// - 先写入同目录下的临时文件并刷入磁盘，再重命名覆盖目标文件
+// - 写入中途失败或崩溃时，原文件保持不变
+// - 每次写入使用不同的临时文件，多个线程或进程同时写入同一文件时，最后完成的写入生效
+// - 返回false代表写入失败
+bool write_file_atomic(const std::string& path, std::string_view content);
+
+// 原子地替换文件内容，内容由write_content直接写入临时文件的流
+// - write_content返回false时放弃写入，原文件保持不变
+bool write_file_atomic(const std::string& path, const std::function<bool(std::ostream&)>& write_content);
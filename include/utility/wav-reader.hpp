@@ -0,0 +1,67 @@
+#pragma once
+
+#include "utility/mapped-file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// 无压缩WAV文件读取器
+// - 支持RIFF/WAVE与RF64，PCM整数（8/16/24/32位）与IEEE浮点（32/64位）
+// - data块通过内存映射读取，直接转换为交错的float采样，绕过libavformat/libavcodec
+// - 不支持的文件（压缩格式、损坏的头部等）由open()返回std::nullopt，调用者应回退到通用解码路径
+class Wav_reader
+{
+  public:
+
+	// data块中采样的存储格式
+	enum class Sample_type
+	{
+		Uint8,
+		Int16,
+		Int24,
+		Int32,
+		Float32,
+		Float64
+	};
+
+	struct Format
+	{
+		Sample_type sample_type;
+		int channels;
+		int sample_rate;
+		uint32_t channel_mask;  // WAVE_FORMAT_EXTENSIBLE中的声道掩码，没有时为0
+	};
+
+  private:
+
+	Mapped_file file;
+	Format format;
+
+	const std::byte* data_begin;  // data块起始位置
+	size_t bytes_per_frame;       // 每帧（所有声道的一个采样）的字节数
+	size_t frame_count;           // data块中完整帧的数量
+	size_t position = 0;          // 当前读取到的帧
+
+	Wav_reader(Mapped_file file, Format format, const std::byte* data_begin, size_t frame_count);
+
+  public:
+
+	Wav_reader(const Wav_reader&) = delete;
+	Wav_reader(Wav_reader&&) = default;
+	Wav_reader& operator=(const Wav_reader&) = delete;
+	Wav_reader& operator=(Wav_reader&&) = default;
+
+	// 尝试以无压缩WAV格式打开文件
+	// - 不是RIFF/WAVE或RF64文件，或是格式不受支持时，返回std::nullopt
+	static std::optional<Wav_reader> open(const std::string& path);
+
+	const Format& get_format() const { return format; }
+	size_t total_frames() const { return frame_count; }
+	size_t remaining_frames() const { return frame_count - position; }
+
+	// 读取至多max_frames帧，转换为[-1, 1]范围内的交错float写入dst
+	// - 返回实际读取的帧数，到达末尾时返回0
+	size_t read_interleaved(float* dst, size_t max_frames);
+};
@@ -15,6 +15,7 @@
 #include <filesystem>
 #include <fstream>
 #include <imgui.h>
+#include <sstream>
 #include <utility>
 
 void App::draw()
@@ -203,8 +204,8 @@ void App::draw_menubar_edit()
 			for (const auto& [id, _] : graph.links) ImNodes::SelectLink(id);
 		}
 
-		if (ImGui::MenuItem("Undo", "Ctrl+Z", false, !undo_stack.empty())) undo();
-		if (ImGui::MenuItem("Redo", "Ctrl+Y", false, !redo_stack.empty())) redo();
+		if (ImGui::MenuItem("Undo", "Ctrl+Z", false, history.can_undo())) undo();
+		if (ImGui::MenuItem("Redo", "Ctrl+Y", false, history.can_redo())) redo();
 
 		if (ImGui::MenuItem(
 				"Remove Selected",
@@ -219,6 +220,30 @@ void App::draw_menubar_edit()
 
 		ImGui::Separator();
 
+		// 工程采样率随工程保存，修改可以撤销
+		if (ImGui::BeginMenu("Project Sample Rate"))
+		{
+			if (ImGui::MenuItem("Auto (Most Common Input Rate)", nullptr, graph.sample_rate == 0))
+			{
+				save_undo_state();
+				graph.sample_rate = 0;
+			}
+
+			ImGui::Separator();
+
+			for (const auto preset : config::audio::sample_rate_presets)
+			{
+				const auto label = std::format("{} Hz", preset);
+				if (ImGui::MenuItem(label.c_str(), nullptr, graph.sample_rate == preset))
+				{
+					save_undo_state();
+					graph.sample_rate = preset;
+				}
+			}
+
+			ImGui::EndMenu();
+		}
+
 		if (ImGui::MenuItem("Settings")) popup_manager.open_window(Settings_window::create(app_settings));
 	}
 	ImGui::EndDisabled();
@@ -261,8 +286,22 @@ void App::draw_side_panel()
 			selected_node.processor->get_processor_info_non_static().description,
 			false
 		);
-		if (selected_node.processor->draw_content(state != State::Editing))
-			graph.update_node_pin(selected_node_id);
+		// 参数修改没有经过save_undo_state，编辑结束时记录为一步
+		ImGui::BeginGroup();
+		const bool pins_changed = selected_node.processor->draw_content(state != State::Editing);
+		ImGui::EndGroup();
+
+		const bool edited = ImGui::IsItemEdited();
+		const bool edit_finished = ImGui::IsItemDeactivatedAfterEdit();
+
+		if (pins_changed) graph.update_node_pin(selected_node_id);
+
+		if (edited)
+		{
+			graph.modified = true;
+			history.mark_pending(selected_node_id);
+		}
+		if (edit_finished) history.commit(graph);
 	}
 }
 
@@ -314,13 +353,13 @@ void App::draw_toolbar()
 	ImGui::Separator();
 
 	// 撤销按钮
-	ImGui::BeginDisabled(undo_stack.empty() || state != State::Editing);
+	ImGui::BeginDisabled(!history.can_undo() || state != State::Editing);
 	if (ImGui::Button(ICON_UNDO "##toolbar-undo", {area_width, area_width})) undo();
 	if (ImGui::BeginItemTooltip()) ImGui::Text("Undo Action"), ImGui::EndTooltip();
 	ImGui::EndDisabled();
 
 	// 重做按钮
-	ImGui::BeginDisabled(redo_stack.empty() || state != State::Editing);
+	ImGui::BeginDisabled(!history.can_redo() || state != State::Editing);
 	if (ImGui::Button(ICON_REDO "##toolbar-redo", {area_width, area_width})) redo();
 	if (ImGui::BeginItemTooltip()) ImGui::Text("Redo Action"), ImGui::EndTooltip();
 	ImGui::EndDisabled();
@@ -334,7 +373,7 @@ void App::draw_toolbar()
 	ImGui::EndDisabled();
 
 	// 粘贴按钮
-	ImGui::BeginDisabled(copied_graph_json.empty() || state != State::Editing);
+	ImGui::BeginDisabled(clipboard.nodes.empty() || state != State::Editing);
 	if (ImGui::Button(ICON_PASTE "##toolbar-paste", {area_width, area_width})) paste_nodes();
 	if (ImGui::BeginItemTooltip()) ImGui::Text("Paste"), ImGui::EndTooltip();
 	ImGui::EndDisabled();
@@ -350,15 +389,34 @@ void App::draw_toolbar()
 // =============================================================================
 /* 应用主循环 */
 
+// 是否可以进入空闲模式
+// - 预览或导出时全速刷新，仪表与进度需要持续更新
+// - 最后一次输入后保持一段时间全速刷新，使提示框延迟、弹窗淡入等动画得以完成
+// - 正在拖动或编辑控件（如文本框的光标闪烁）时不空闲
+bool App::is_idle() const
+{
+	if (!app_settings.ui.idle_throttle || state != State::Editing) return false;
+	if (ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput) return false;
+
+	return std::chrono::steady_clock::now() - last_activity_time
+		 > std::chrono::milliseconds(config::appearance::idle_settle_ms);
+}
+
 void App::run()
 {
 	app_settings.load_from_file("settings.json");
 
 	while (true)
 	{
+		// 空闲时阻塞等待输入，超时后仍然绘制一帧，使自动保存、后台弹窗等状态得以更新
 		SDL_Event event;
-		while (SDL_PollEvent(&event))
+		bool has_event = is_idle() ? SDL_WaitEventTimeout(&event, config::appearance::idle_tick_ms) != 0
+								   : SDL_PollEvent(&event) != 0;
+
+		for (; has_event; has_event = SDL_PollEvent(&event) != 0)
 		{
+			last_activity_time = std::chrono::steady_clock::now();
+
 			imgui_context.process_event(event);
 			if (event.type == SDL_QUIT) return;
 			if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE
@@ -373,6 +431,7 @@ void App::run()
 		}
 
 		sync_ui_settings();
+		sync_audio_settings();
 
 		imgui_context.new_frame();
 		{
@@ -382,7 +441,15 @@ void App::run()
 		}
 		imgui_context.render(sdl_context.get_renderer_ptr());
 
+		// 弹窗打开或关闭时播放动画，视为一次输入
+		if (const auto count = popup_manager.get_window_count(); count != popup_window_count)
+		{
+			popup_window_count = count;
+			last_activity_time = std::chrono::steady_clock::now();
+		}
+
 		poll_state();
+		poll_autosave();
 
 		SDL_SetWindowTitle(
 			sdl_context.get_window_ptr(),
@@ -593,6 +660,8 @@ void App::show_export_window()
 	{
 		App& app;
 		size_t kbps = 320;  // 默认比特率为128kbps
+		bool parallel_encode = false;
+		processor::Export_format format = processor::Export_format::Mp3;
 		std::string export_file_path;
 		std::shared_ptr<std::atomic<double>> time;
 
@@ -606,6 +675,12 @@ void App::show_export_window()
 		bool operator()(bool close_button_pressed)
 		{
 			static constexpr auto kbps_presets = std::to_array<size_t>({64, 96, 128, 160, 192, 256, 320});
+			static constexpr auto format_presets = std::to_array<processor::Export_format>(
+				{processor::Export_format::Mp3,
+				 processor::Export_format::Wav,
+				 processor::Export_format::Flac,
+				 processor::Export_format::Opus}
+			);
 
 			if (app.state == State::Exporting)
 			{
@@ -633,7 +708,11 @@ void App::show_export_window()
 			{
 				if (ImGui::Button("Browse " ICON_EXT_LINK))
 				{
-					const auto path = save_file_dialog("Export Audio", {"Audio File", "*.mp3"}, ".");
+					const auto path = save_file_dialog(
+						"Export Audio",
+						{"Audio File", std::string(processor::get_export_format_pattern(format))},
+						"."
+					);
 					if (path.has_value()) export_file_path = path.value();
 				}
 
@@ -645,8 +724,23 @@ void App::show_export_window()
 						: export_file_path.c_str()
 				);
 
+				// 格式选择
+				if (ImGui::BeginCombo("Format", processor::get_export_format_name(format).data()))
+				{
+					for (const auto& preset : format_presets)
+					{
+						const bool is_selected = (preset == format);
+						if (ImGui::Selectable(processor::get_export_format_name(preset).data(), is_selected))
+							format = preset;
+						if (is_selected) ImGui::SetItemDefaultFocus();
+					}
+
+					ImGui::EndCombo();
+				}
+
 				// 比特率选择
-				if (ImGui::BeginCombo("Bitrate", std::format("{} kbps", kbps).c_str()))
+				if (processor::export_format_has_bitrate(format)
+					&& ImGui::BeginCombo("Bitrate", std::format("{} kbps", kbps).c_str()))
 				{
 					for (const auto& preset : kbps_presets)
 					{
@@ -659,9 +753,17 @@ void App::show_export_window()
 					ImGui::EndCombo();
 				}
 
+				if (format == processor::Export_format::Mp3)
+				{
+					ImGui::Checkbox("Multi-threaded encoding", &parallel_encode);
+					if (ImGui::BeginItemTooltip())
+						ImGui::Text("Encode segments of the audio on all CPU cores, faster for long exports"),
+							ImGui::EndTooltip();
+				}
+
 				if (ImGui::Button("Export"))
 				{
-					time = app.create_export_runner(export_file_path, kbps);
+					time = app.create_export_runner(export_file_path, format, kbps, parallel_encode);
 				}
 			}
 			ImGui::PopItemWidth();
@@ -691,7 +793,10 @@ void App::save_project()
 		|| !std::filesystem::is_regular_file(graph_path))
 	{
 		// 如果没有指定路径，则弹出保存对话框
-		const auto filename = save_file_dialog("Save Project", {"Project File", "*.json"});
+		const auto filename = save_file_dialog(
+			"Save Project",
+			{"Project File", "*.json", "Binary Project File", "*.nodey"}
+		);
 		if (!filename.has_value()) return;  // 用户取消了保存
 
 		save_project_with_path(filename.value());
@@ -711,7 +816,7 @@ void App::open_project()
 
 		bool open()
 		{
-			const auto path = open_file_dialog("Select Project File", {"Project File", "*.json"});
+			const auto path = open_file_dialog("Select Project File", {"Project File", "*.json *.nodey"});
 
 			if (!path.has_value()) return false;
 			return app_ptr.load_project_from_file(path.value());
@@ -830,54 +935,146 @@ void App::clear_project()
 	state = State::Editing;
 }
 
-//文件序列化
-std::string App::save_graph_as_string() const
+// 二进制项目文件的扩展名，其余扩展名保存为JSON
+static constexpr std::string_view binary_project_extension = ".nodey";
+
+static bool is_binary_project_path(const std::string& path)
+{
+	return std::filesystem::path(path).extension() == binary_project_extension;
+}
+
+// 将图的JSON写入项目文件流，按扩展名选择格式，可以在任意线程中调用
+static bool write_project_json(std::ostream& stream, const Json::Value& json, const std::string& path)
+{
+	if (is_binary_project_path(path))
+	{
+		const auto content = infra::Graph::encode_binary(json);
+		stream.write(content.data(), std::streamsize(content.size()));
+	}
+	else
+	{
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = "  ";  // 设置缩进为两个空格
+		const std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+		writer->write(json, &stream);
+	}
+
+	return stream.good();
+}
+
+//文件序列化，JSON格式逐个节点写入流
+// - 图中的节点位置为网格坐标，工程文件沿用旧版本的编辑器坐标，写入时加上画布平移量
+bool App::write_project_file(std::ostream& stream, const std::string& path) const
 {
-	const auto json = graph.serialize();
-	Json::StreamWriterBuilder writer;
-	writer["indentation"] = "  ";  // 设置缩进为两个空格
-	return Json::writeString(writer, json);
+	const ImVec2 panning = ImNodes::EditorContextGetPanning();
+	if (is_binary_project_path(path)) return write_project_json(stream, graph.serialize(panning), path);
+
+	graph.serialize(stream, panning);
+	return stream.good();
 }
 
-//文件反序列化
-void App::load_graph_from_string(const std::string& json_string)
+//文件反序列化，按文件头区分二进制格式与JSON
+void App::load_graph_from_stream(std::istream& stream)
 {
-	Json::Value json;
-	const auto parse_result = Json::Reader().parse(json_string, json, false);
-	if (!parse_result) throw infra::Graph::Invalid_file_error("Failed to parse JSON");
+	char magic[4];
+	stream.read(magic, sizeof(magic));
+	const std::string_view header(magic, size_t(stream.gcount()));
+
+	stream.clear();
+	stream.seekg(0);
+
+	if (infra::Graph::is_binary(header))
+	{
+		// 二进制格式本身紧凑，整体读入后解析
+		const std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		graph = infra::Graph::deserialize_binary(content);
+	}
+	else
+		graph = infra::Graph::deserialize(stream);
 
-	graph = infra::Graph::deserialize(json);
 	graph.modified = false;
 
+	// 文件中保存的是编辑器坐标，将画布平移归零后与网格坐标一致
+	ImNodes::EditorContextResetPanning(ImVec2(0, 0));
 	for (const auto& [id, node] : graph.nodes) ImNodes::SetNodeGridSpacePos(id, node.position);
 }
 
 // 使用指定路径和名称保存项目
 bool App::save_project_with_path(const std::string& filename)
 {
-	// 获取当前图的JSON字符串
-	std::string json_string = save_graph_as_string();
+	// 等待正在进行的自动保存，避免两次写入同一个临时文件
+	if (autosave_thread.joinable()) autosave_thread.join();
 
-	// 写入文件
-	std::ofstream file(filename);
-	if (!file.is_open())
+	// 直接写入临时文件后替换，写入失败时原文件不受影响
+	const auto write_content = [this, &filename](std::ostream& stream)
+	{
+		return write_project_file(stream, filename);
+	};
+
+	if (!write_file_atomic(filename, write_content))
 	{
 		add_error_popup_window(
 			"Failed to Save Project",
-			"Could not open file for writing.",
+			"Could not write the project file.",
 			"File: " + filename
 		);
 		return false;
 	}
 
-	file << json_string;
-
 	graph.modified = false;
 	graph_path = filename;
 
 	return true;
 }
 
+// 自动保存
+// - 处理器参数只能在UI线程读取，因此在UI线程中生成JSON树；格式化、写盘与刷盘都在后台线程完成
+// - 从未保存过的项目没有路径，不自动保存
+// - 保存时即清除修改标记，保存失败时再恢复
+void App::poll_autosave()
+{
+	using Clock = std::chrono::steady_clock;
+
+	if (autosave_failed.exchange(false))
+	{
+		graph.modified = true;
+		add_error_popup_window(
+			"Auto Save Failed",
+			"Could not write the project file. Save the project manually to keep your changes.",
+			"File: " + graph_path
+		);
+	}
+
+	const auto now = Clock::now();
+	const auto interval = std::chrono::seconds(app_settings.editor.auto_save_interval);
+
+	if (!app_settings.editor.auto_save || graph_path.empty() || !graph.modified)
+	{
+		last_autosave_time = now;
+		return;
+	}
+
+	if (now - last_autosave_time < interval || autosave_running) return;
+
+	last_autosave_time = now;
+	autosave_running = true;
+	graph.modified = false;
+
+	// 上一次保存已经结束，替换时的join()不会阻塞
+	autosave_thread = std::jthread(
+		[this, json = graph.serialize(ImNodes::EditorContextGetPanning()), path = graph_path]
+		{
+			const auto write_content = [&json, &path](std::ostream& stream)
+			{
+				return write_project_json(stream, json, path);
+			};
+
+			if (!write_file_atomic(path, write_content)) autosave_failed = true;
+			autosave_running = false;
+		}
+	);
+}
+
 // 加载项目文件
 bool App::load_project_from_file(const std::string& filepath)
 {
@@ -891,7 +1088,7 @@ bool App::load_project_from_file(const std::string& filepath)
 		state = State::Editing;
 	}
 
-	std::ifstream file(filepath);
+	std::ifstream file(filepath, std::ios::binary);
 	if (!file.is_open())
 	{
 		add_error_popup_window(
@@ -902,12 +1099,9 @@ bool App::load_project_from_file(const std::string& filepath)
 		return false;
 	}
 
-	redo_stack.clear();
 	graph_path = filepath;
 
-	load_graph_from_string(
-		std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>())
-	);
+	load_graph_from_stream(file);
 
 	return true;
 }
@@ -915,135 +1109,38 @@ bool App::load_project_from_file(const std::string& filepath)
 //=============================================================================
 /* 撤销重做状态实现 */
 
-// 保存当前图到撤销栈
+// 即将修改图，记录此前的修改并清空重做记录
 void App::save_undo_state()
 {
 	graph.modified = true;
 
-	// 保存当前图到撤销栈
-	undo_stack.push_back(graph);
-
-	// 如果超过限制，移除最老的状态
-	if (undo_stack.size() > size_t(app_settings.editor.max_undo_levels)) undo_stack.pop_front();
-
-	// 清空重做栈（因为新操作会使之前的重做路径失效）
-	redo_stack.clear();
-
-	//定期压缩内存
-	if (undo_stack.size() % 10 == 0) compress_undo_stack();
-}
-
-// 保存当前图到重做栈
-void App::save_redo_state()
-{
-	// 限制栈大小
-	const size_t max_redo_size = 30;
-
-	// 保存当前图到重做栈
-	redo_stack.push_back(graph);
-
-	// 如果超过限制，移除最老的状态
-	if (redo_stack.size() > max_redo_size)
-	{
-		redo_stack.pop_front();
-	}
-
-	// 清空撤销栈
-	undo_stack.clear();
+	history.set_max_levels(app_settings.editor.max_undo_levels);
+	history.begin_edit(graph);
 }
 
 // 撤销和重做操作
 void App::undo()
 {
-	if (!undo_stack.empty())
-	{
-		// 限制重做栈大小
-		const size_t max_redo_size = 30;
-
-		redo_stack.push_back(graph);
-
-		// 如果重做栈超过限制，移除最老的状态
-		if (redo_stack.size() > max_redo_size)
-		{
-			redo_stack.pop_front();
-		}
-
-		graph = undo_stack.back();
-		undo_stack.pop_back();
-
-		restore_node_positions();
-	}
+	if (history.undo(graph)) restore_node_positions();
 }
 
 void App::redo()
 {
-	if (!redo_stack.empty())
-	{
-		// 限制撤销栈大小
-		const size_t max_undo_size = 30;
-
-		undo_stack.push_back(graph);
-
-		// 如果撤销栈超过限制，移除最老的状态
-		if (undo_stack.size() > max_undo_size)
-		{
-			undo_stack.pop_front();
-		}
-
-		graph = redo_stack.back();
-		redo_stack.pop_back();
-
-		restore_node_positions();
-	}
-}
-
-// 压缩撤销栈
-void App::compress_undo_stack()
-{
-	// 内存压缩策略：每10个状态合并为一个检查点
-	if (undo_stack.size() < 20) return;  // 少于20个状态时不压缩
-
-	// 保留最近的10个状态，每隔5个状态保留一个检查点
-	std::list<infra::Graph> compressed_stack;
-
-	auto it = undo_stack.begin();
-
-	// 从较早的状态中每隔5个保留一个检查点
-	size_t recent_start = undo_stack.size() >= 10 ? undo_stack.size() - 10 : 0;
-	for (size_t i = 0; i < recent_start && it != undo_stack.end(); i += 5)
-	{
-		auto checkpoint_it = it;
-		std::advance(it, std::min(5UL, static_cast<size_t>(std::distance(it, undo_stack.end()))));
-		compressed_stack.push_back(std::move(*checkpoint_it));
-	}
-
-	// 保留最近的10个状态
-	auto recent_it = undo_stack.begin();
-	std::advance(recent_it, recent_start);
-	for (auto iter = recent_it; iter != undo_stack.end(); ++iter)
-	{
-		compressed_stack.push_back(std::move(*iter));
-	}
-
-	undo_stack = std::move(compressed_stack);
+	if (history.redo(graph)) restore_node_positions();
 }
 
 // 恢复节点位置
 void App::restore_node_positions()
 {
-	for (const auto& [id, node] : graph.nodes)
-	{
-		if (node.position.x != 0.0f || node.position.y != 0.0f)
-		{
-			ImNodes::SetNodeGridSpacePos(id, node.position);
-		}
-	}
+	// 位置按网格坐标记录，与画布平移无关
+	for (const auto& [id, node] : graph.nodes) ImNodes::SetNodeGridSpacePos(id, node.position);
 }
 
 // =============================================================================
 /* 复制粘贴操作 */
 
 // 复制选中的节点和连线
+// - 剪贴板保存子图与处理器的副本，不经过JSON
 void App::copy_selected_nodes()
 {
 	const auto selected_node_count = ImNodes::NumSelectedNodes();
@@ -1057,99 +1154,10 @@ void App::copy_selected_nodes()
 	if (selected_node_count > 0) ImNodes::GetSelectedNodes(selected_nodes.data());
 	if (selected_link_count > 0) ImNodes::GetSelectedLinks(selected_links.data());
 
-	// 创建一个临时图来保存选中的内容
-	infra::Graph temp_graph;
-	std::map<infra::Id_t, infra::Id_t> node_id_mapping;  // 原ID -> 新ID映射
-
 	try
 	{
-		// 复制选中的节点
-		for (auto original_node_id : selected_nodes)
-		{
-			if (graph.nodes.contains(original_node_id))
-			{
-				const auto& original_node = graph.nodes.at(original_node_id);
-
-				// 创建新的处理器实例
-				const auto processor_info = original_node.processor->get_processor_info_non_static();
-				auto new_processor = infra::Processor::processor_map.at(processor_info.identifier).generate();
-
-				// 复制处理器配置
-				new_processor->deserialize(original_node.processor->serialize());
-
-				// 添加到临时图并记录ID映射
-				const auto new_node_id = temp_graph.add_node(std::move(new_processor));
-				temp_graph.nodes[new_node_id].position = original_node.position;
-				node_id_mapping[original_node_id] = new_node_id;
-			}
-		}
-
-		// 复制选中的连线（只复制两端都是选中节点的连线）
-		for (auto original_link_id : selected_links)
-		{
-			if (graph.links.contains(original_link_id))
-			{
-				const auto& original_link = graph.links.at(original_link_id);
-				const auto& from_pin = graph.pins.at(original_link.from);
-				const auto& to_pin = graph.pins.at(original_link.to);
-
-				// 检查连线的两端节点是否都被选中
-				if (node_id_mapping.contains(from_pin.parent) && node_id_mapping.contains(to_pin.parent))
-				{
-					const auto new_from_node_id = node_id_mapping[from_pin.parent];
-					const auto new_to_node_id = node_id_mapping[to_pin.parent];
-
-					// 在临时图中找到对应的引脚
-					const auto& from_pin_map = temp_graph.nodes.at(new_from_node_id).pin_name_map;
-					const auto& to_pin_map = temp_graph.nodes.at(new_to_node_id).pin_name_map;
-
-					if (from_pin_map.contains(from_pin.attribute.identifier)
-						&& to_pin_map.contains(to_pin.attribute.identifier))
-					{
-						const auto new_from_pin_id = from_pin_map.at(from_pin.attribute.identifier);
-						const auto new_to_pin_id = to_pin_map.at(to_pin.attribute.identifier);
-
-						temp_graph.add_link(new_from_pin_id, new_to_pin_id);
-					}
-				}
-			}
-		}
-
-		// 如果没有选中连线，也要复制节点之间的内部连线
-		if (selected_link_count == 0 && selected_node_count > 0)
-		{
-			for (const auto& [link_id, link] : graph.links)
-			{
-				const auto& from_pin = graph.pins.at(link.from);
-				const auto& to_pin = graph.pins.at(link.to);
-
-				// 检查连线的两端节点是否都被选中
-				if (node_id_mapping.contains(from_pin.parent) && node_id_mapping.contains(to_pin.parent))
-				{
-					const auto new_from_node_id = node_id_mapping[from_pin.parent];
-					const auto new_to_node_id = node_id_mapping[to_pin.parent];
-
-					// 在临时图中找到对应的引脚
-					const auto& from_pin_map = temp_graph.nodes.at(new_from_node_id).pin_name_map;
-					const auto& to_pin_map = temp_graph.nodes.at(new_to_node_id).pin_name_map;
-
-					if (from_pin_map.contains(from_pin.attribute.identifier)
-						&& to_pin_map.contains(to_pin.attribute.identifier))
-					{
-						const auto new_from_pin_id = from_pin_map.at(from_pin.attribute.identifier);
-						const auto new_to_pin_id = to_pin_map.at(to_pin.attribute.identifier);
-
-						temp_graph.add_link(new_from_pin_id, new_to_pin_id);
-					}
-				}
-			}
-		}
-
-		// 序列化临时图
-		const auto json = temp_graph.serialize();
-		Json::StreamWriterBuilder writer;
-		writer["indentation"] = "";  // 紧凑格式
-		copied_graph_json = Json::writeString(writer, json);
+		// 只选中连线时不复制任何节点，子图为空
+		if (selected_node_count > 0) clipboard = graph.extract(selected_nodes, selected_links);
 
 		// 显示复制成功的提示
 		std::string message;
@@ -1165,7 +1173,7 @@ void App::copy_selected_nodes()
 		}
 		else if (selected_node_count > 0)
 		{
-			const auto internal_links = temp_graph.links.size();
+			const auto internal_links = clipboard.links.size();
 			if (internal_links > 0)
 			{
 				message = std::format(
@@ -1201,31 +1209,15 @@ void App::copy_selected_nodes()
 }
 
 // 粘贴节点和连线
+// - 整个子图一次插入，ID按顺序分配
 void App::paste_nodes()
 {
-	if (copied_graph_json.empty()) return;
+	if (clipboard.nodes.empty()) return;
 
 	save_undo_state();
 
 	try
 	{
-		// 反序列化复制的图
-		Json::Value json;
-		const auto parse_result = Json::Reader().parse(copied_graph_json, json, false);
-		if (!parse_result)
-		{
-			throw std::runtime_error("Failed to parse copied graph JSON");
-		}
-
-		infra::Graph temp_graph = infra::Graph::deserialize(json);
-
-		// 如果临时图为空，提前返回
-		if (temp_graph.nodes.empty())
-		{
-			add_info_popup_window("Paste Failed", "No nodes to paste.", "");
-			return;
-		}
-
 		// 计算粘贴偏移量
 		const ImVec2 paste_offset = ImGui::GetMousePos();
 		last_paste_position.x += paste_offset.x;
@@ -1238,93 +1230,27 @@ void App::paste_nodes()
 		}
 
 		// 计算位置偏移量（基于第一个节点的位置）
-		ImVec2 position_offset = last_paste_position;
-		if (!temp_graph.nodes.empty())
-		{
-			const auto& first_node = temp_graph.nodes.begin()->second;
-			position_offset.x -= first_node.position.x;
-			position_offset.y -= first_node.position.y;
-		}
-
-		std::map<infra::Id_t, infra::Id_t> node_id_mapping;  // 临时图ID -> 目标图ID映射
-		std::vector<infra::Id_t> pasted_node_ids;
-		size_t skipped_singleton_count = 0;
-
-		// 粘贴节点
-		for (const auto& [temp_node_id, temp_node] : temp_graph.nodes)
-		{
-			const auto processor_info = temp_node.processor->get_processor_info_non_static();
-
-			// 检查是否为单例处理器且已存在
-			if (processor_info.singleton && graph.singleton_node_map.contains(processor_info.identifier))
-			{
-				skipped_singleton_count++;
-				continue;
-			}
-
-			// 创建新的处理器实例
-			auto new_processor = infra::Processor::processor_map.at(processor_info.identifier).generate();
-			new_processor->deserialize(temp_node.processor->serialize());
-
-			// 添加到目标图
-			const auto new_node_id = graph.add_node(std::move(new_processor));
-
-			// 设置新位置
-			ImVec2 new_position = temp_node.position;
-			new_position.x += position_offset.x;
-			new_position.y += position_offset.y;
-
-			ImNodes::SetNodeGridSpacePos(new_node_id, new_position);
-			graph.nodes[new_node_id].position = new_position;
-
-			node_id_mapping[temp_node_id] = new_node_id;
-			pasted_node_ids.push_back(new_node_id);
-		}
-
-		// 粘贴连线
-		size_t pasted_link_count = 0;
-		for (const auto& [temp_link_id, temp_link] : temp_graph.links)
-		{
-			const auto& temp_from_pin = temp_graph.pins.at(temp_link.from);
-			const auto& temp_to_pin = temp_graph.pins.at(temp_link.to);
-
-			// 检查两端节点是否都已成功粘贴
-			if (node_id_mapping.contains(temp_from_pin.parent)
-				&& node_id_mapping.contains(temp_to_pin.parent))
-			{
-				const auto new_from_node_id = node_id_mapping[temp_from_pin.parent];
-				const auto new_to_node_id = node_id_mapping[temp_to_pin.parent];
-
-				// 在目标图中找到对应的引脚
-				const auto& from_pin_map = graph.nodes.at(new_from_node_id).pin_name_map;
-				const auto& to_pin_map = graph.nodes.at(new_to_node_id).pin_name_map;
-
-				if (from_pin_map.contains(temp_from_pin.attribute.identifier)
-					&& to_pin_map.contains(temp_to_pin.attribute.identifier))
-				{
-					const auto new_from_pin_id = from_pin_map.at(temp_from_pin.attribute.identifier);
-					const auto new_to_pin_id = to_pin_map.at(temp_to_pin.attribute.identifier);
-
-					try
-					{
-						graph.add_link(new_from_pin_id, new_to_pin_id);
-						pasted_link_count++;
-					}
-					catch (const std::exception& e)
-					{
-						{
-						}
-					}
-				}
-			}
-		}
-
-		// 选中粘贴的节点
+		const auto& first_node = clipboard.nodes.front();
+		const ImVec2 position_offset{
+			last_paste_position.x - first_node.position.x,
+			last_paste_position.y - first_node.position.y
+		};
+
+		const auto link_count_before = graph.links.size();
+		const auto node_id_mapping = graph.insert(clipboard, position_offset);
+		const auto pasted_link_count = graph.links.size() - link_count_before;
+		const auto skipped_singleton_count = clipboard.nodes.size() - node_id_mapping.size();
+
+		// 设置新位置并选中粘贴的节点
 		ImNodes::ClearNodeSelection();
 		ImNodes::ClearLinkSelection();
-		for (auto node_id : pasted_node_ids)
+		std::vector<infra::Id_t> pasted_node_ids;
+		pasted_node_ids.reserve(node_id_mapping.size());
+		for (const auto& [_, node_id] : node_id_mapping)
 		{
+			ImNodes::SetNodeGridSpacePos(node_id, graph.nodes.at(node_id).position);
 			ImNodes::SelectNode(node_id);
+			pasted_node_ids.push_back(node_id);
 		}
 
 		// 显示粘贴结果的提示
@@ -1382,6 +1308,56 @@ void App::paste_nodes()
 	}
 }
 
+// 将选中的节点以JSON格式复制到系统剪贴板
+// - 同时更新内部剪贴板
+void App::copy_selected_nodes_to_system()
+{
+	if (ImNodes::NumSelectedNodes() == 0) return;
+
+	copy_selected_nodes();
+
+	try
+	{
+		// 临时图与剪贴板共享处理器，只用于序列化
+		const auto temp_graph = infra::Graph::build(clipboard.nodes, clipboard.links);
+
+		Json::StreamWriterBuilder writer;
+		writer["indentation"] = "";  // 紧凑格式
+		ImGui::SetClipboardText(Json::writeString(writer, temp_graph.serialize()).c_str());
+	}
+	catch (const std::exception& e)
+	{
+		add_error_popup_window("Copy Failed", "Failed to export nodes to system clipboard.", e.what());
+	}
+}
+
+// 从系统剪贴板读取JSON并粘贴
+// - 读取成功后替换内部剪贴板
+void App::paste_nodes_from_system()
+{
+	const char* text = ImGui::GetClipboardText();
+	if (text == nullptr || *text == '\0') return;
+
+	try
+	{
+		std::istringstream stream(text);
+		const auto temp_graph = infra::Graph::deserialize(stream);
+
+		std::vector<infra::Id_t> node_ids;
+		node_ids.reserve(temp_graph.nodes.size());
+		for (const auto& [id, _] : temp_graph.nodes) node_ids.push_back(id);
+
+		clipboard = temp_graph.extract(node_ids, {});
+	}
+	catch (const std::exception& e)
+	{
+		add_error_popup_window("Paste Failed", "System clipboard does not contain valid nodes.", e.what());
+		return;
+	}
+
+	paste_nodes();
+}
+
 // =============================================================================
 /* 视图和缩放窗口绘制 */
 
@@ -1440,6 +1416,32 @@ void App::sync_ui_settings() const
 		style.Flags &= ~ImNodesStyleFlags_GridSnapping;
 }
 
+// 仅在编辑状态下重新打开设备，避免打断正在进行的预览
+void App::sync_audio_settings()
+{
+	if (state != State::Editing) return;
+
+	const int requested_size = sdl_context.get_audio_device()->get_requested_buffer_size();
+	if (requested_size == app_settings.audio.device_buffer_size) return;
+
+	try
+	{
+		sdl_context.reopen_audio_device(
+			app_settings.audio.device_buffer_size,
+			sdl_context.get_audio_device()->get_sample_rate()
+		);
+	}
+	catch (const std::runtime_error& e)
+	{
+		add_error_popup_window(
+			"Failed to reopen audio device",
+			"Cannot open the audio device with the selected buffer size. The previous setting is restored.",
+			e.what()
+		);
+		app_settings.audio.device_buffer_size = requested_size;
+	}
+}
+
 // 辅助函数：获取当前状态文本
 std::string App::get_current_state_text(App::State state)
 {
@@ -1458,34 +1460,6 @@ std::string App::get_current_state_text(App::State state)
 	}
 }
 
-// 辅助函数：统计处理器状态数量
-std::tuple<size_t, size_t, size_t> App::count_processor_states(const auto& resources) const
-{
-	size_t running_count = 0;
-	size_t finished_count = 0;
-	size_t error_count = 0;
-
-	for (const auto& [id, resource] : resources)
-	{
-		switch (resource->state)
-		{
-		case infra::Runner::State::Running:
-			running_count++;
-			break;
-		case infra::Runner::State::Finished:
-			finished_count++;
-			break;
-		case infra::Runner::State::Error:
-			error_count++;
-			break;
-		default:
-			break;
-		}
-	}
-
-	return {running_count, finished_count, error_count};
-}
-
 // =============================================================================
 /*性能窗口*/
 
@@ -1549,7 +1523,7 @@ void App::draw_diagnostics_overlay()
 			ImGui::Text("%s", state_text.c_str());
 
 			// 撤销/重做状态
-			ImGui::Text("Undo: %zu | Redo: %zu", undo_stack.size(), redo_stack.size());
+			ImGui::Text("Undo: %zu | Redo: %zu", history.undo_size(), history.redo_size());
 		}
 
 		// 如果在预览状态，显示处理器统计
@@ -1557,41 +1531,83 @@ void App::draw_diagnostics_overlay()
 		{
 			ImGui::SeparatorText("Audio");
 
-			auto& processor_resources = runner->get_processor_resources();
-			auto [running_count, finished_count, error_count] = count_processor_states(processor_resources);
-
+			// 状态计数由运行器即时维护，不需要遍历处理器
 			ImGui::Text(
 				"%d Running | %d Finished | %d Errors",
-				(int)running_count,
-				(int)finished_count,
-				(int)error_count
+				(int)runner->get_state_count(infra::Runner::State::Running),
+				(int)runner->get_state_count(infra::Runner::State::Finished),
+				(int)runner->get_state_count(infra::Runner::State::Error)
 			);
 
-			// 显示音频链路状态（简化版）
-			auto& link_products = runner->get_link_products();
-			if (!link_products.empty())
+			// 音频设备状态
+			const auto device_stats = sdl_context.get_audio_device()->get_stats();
+			ImGui::Text(
+				"Latency: %.1fms | Buffer: %d | %d Hz",
+				device_stats.latency * 1000.0,
+				device_stats.buffer_size,
+				sdl_context.get_audio_device()->get_sample_rate()
+			);
+			ImGui::TextColored(
+				device_stats.underruns > 0 ? ImVec4(1, 0.4, 0.4, 1) : ImVec4(1, 1, 1, 1),
+				"Underruns: %llu",
+				(unsigned long long)device_stats.underruns
+			);
+
+			// 音频链路状态，曲线取自统计快照的历史：左为缓冲区占用，右为取空次数
+			if (!metrics_history.empty())
 			{
-				for (const auto& [id, link] : link_products)
+				const size_t history_size = metrics_history.size();
+				const auto snapshot_at = [&](size_t index) -> const infra::Runner::Metrics&
+				{ return metrics_history[(metrics_history_head + index) % history_size]; };
+
+				std::vector<float> fill_values(history_size), stall_values(history_size);
+				const ImVec2 plot_size(80 * runtime_config::ui_scale, ImGui::GetTextLineHeight());
+
+				// 同一个运行器的快照中，连结的数量与顺序不变
+				const auto& latest_links = snapshot_at(history_size - 1).links;
+				for (size_t link_index = 0; link_index < latest_links.size(); link_index++)
 				{
-					try
+					const auto& link = latest_links[link_index];
+
+					for (size_t i = 0; i < history_size; i++)
 					{
-						const auto& product = dynamic_cast<const processor::Audio_stream&>(*link);
-						const float fill_ratio
-							= (float)product.buffered_count() / config::processor::audio_stream::buffer_size;
+						const auto& links = snapshot_at(i).links;
+						const bool valid = link_index < links.size();
+						fill_values[i] = valid ? links[link_index].fill : 0.0f;
+						stall_values[i] = valid ? (float)links[link_index].stalls : 0.0f;
+					}
 
-						// < 60%: 红色
-						// 60% - 80%: 黄色
-						// > 80%: 绿色
-						const ImVec4 buffer_color
-							= ImVec4(fill_ratio < 0.8 ? 1 : 0, fill_ratio > 0.6 ? 1 : 0, 0, 1);
+					// < 60%: 红色
+					// 60% - 80%: 黄色
+					// > 80%: 绿色
+					const ImVec4 buffer_color
+						= ImVec4(link.fill < 0.8 ? 1 : 0, link.fill > 0.6 ? 1 : 0, 0, 1);
 
-						ImGui::TextColored(buffer_color, "L%d: %.0f%%", id, fill_ratio * 100.0f);
-					}
-					catch (const std::bad_cast&)
+					ImGui::PushID(link.id);
+
+					ImGui::TextColored(buffer_color, "L%d: %3.0f%%", link.id, link.fill * 100.0f);
+					if (ImGui::BeginItemTooltip())
 					{
-						{
-						}
+						ImGui::Text("Throughput: %.1f frames/s", link.throughput);
+						ImGui::Text("Stalls: %llu", (unsigned long long)link.stalls);
+						ImGui::EndTooltip();
 					}
+
+					ImGui::SameLine();
+					ImGui::PlotLines("##fill", fill_values.data(), history_size, 0, nullptr, 0, 1, plot_size);
+					ImGui::SameLine();
+					ImGui::PlotLines(
+						"##stall",
+						stall_values.data(),
+						history_size,
+						0,
+						nullptr,
+						0,
+						FLT_MAX,
+						plot_size
+					);
+
+					ImGui::PopID();
 				}
 			}
 		}
@@ -1621,12 +1637,7 @@ void App::draw_node_editor()
 	}
 	ImNodes::EndNodeEditor();
 
-	//保存节点位置
-	for (auto& [id, item] : graph.nodes)
-	{
-		const auto new_position = ImNodes::GetNodeEditorSpacePos(id);
-		item.position = new_position;
-	}
+	sync_dragged_node_positions();
 
 	// 直接右键节点/连结选中并打开菜单
 	if (state == State::Editing && ImGui::IsMouseClicked(ImGuiMouseButton_Right))
@@ -1653,6 +1664,24 @@ void App::draw_node_editor()
 	handle_node_actions();
 }
 
+// 保存节点位置
+// - 节点只能通过拖动选中的节点移动，因此只在按住或松开左键时读取选中节点的位置，不逐个读取所有节点
+// - 使用网格坐标，与画布平移无关
+void App::sync_dragged_node_positions()
+{
+	if (!ImGui::IsMouseDown(ImGuiMouseButton_Left) && !ImGui::IsMouseReleased(ImGuiMouseButton_Left)) return;
+
+	const int selected_count = ImNodes::NumSelectedNodes();
+	if (selected_count <= 0) return;
+
+	std::vector<infra::Id_t> selected_nodes(selected_count);
+	ImNodes::GetSelectedNodes(selected_nodes.data());
+
+	for (const auto id : selected_nodes)
+		if (const auto find = graph.nodes.find(id); find != graph.nodes.end())
+			find->second.position = ImNodes::GetNodeGridSpacePos(id);
+}
+
 // 绘制单个节点
 void App::draw_node(infra::Id_t id, const infra::Graph::Node& node)
 {
@@ -1665,6 +1694,7 @@ void App::draw_node(infra::Id_t id, const infra::Graph::Node& node)
 
 		// 绘制节点本体
 		//if (node.processor->draw_content(false) && state == State::Editing) graph.update_node_pin(id);
+		node.processor->draw_preview();
 
 		// 绘制节点输入输出端口
 		ImGui::NewLine();
@@ -1712,6 +1742,7 @@ void App::draw_add_node_menu()
 			save_undo_state();
 			const auto new_id = graph.add_node(item.second.generate());
 			ImNodes::SetNodeScreenSpacePos(new_id, ImGui::GetMousePos());
+			graph.nodes.at(new_id).position = ImNodes::GetNodeGridSpacePos(new_id);
 		}
 	}
 }
@@ -1761,19 +1792,24 @@ void App::draw_node_editor_context_menu()
 			}
 		}
 
-		ImGui::BeginDisabled(copied_graph_json.empty());
+		ImGui::BeginDisabled(clipboard.nodes.empty());
 		if (ImGui::MenuItem("Paste", "Ctrl+V"))
 		{
 			paste_nodes();
 		}
 		ImGui::EndDisabled();
 
-		// 分隔符（如果有复制粘贴选项的话）
-		if (ImNodes::NumSelectedNodes() > 0 || !copied_graph_json.empty())
+		// 与系统剪贴板交换JSON
+		if (ImGui::BeginMenu("System Clipboard"))
 		{
-			ImGui::Separator();
+			if (ImGui::MenuItem("Copy as JSON", "Ctrl+Shift+C", false, ImNodes::NumSelectedNodes() > 0))
+				copy_selected_nodes_to_system();
+			if (ImGui::MenuItem("Paste JSON", "Ctrl+Shift+V")) paste_nodes_from_system();
+			ImGui::EndMenu();
 		}
 
+		ImGui::Separator();
+
 		// 新增节点的菜单
 		if (ImGui::BeginMenu("Add"))
 		{
@@ -1847,6 +1883,15 @@ void App::handle_keyboard_shortcuts()
 	// Ctrl+V 粘贴
 	if (ImGui::IsKeyChordPressed(ImGuiKey_ModCtrl | ImGuiKey_V) && state == State::Editing) paste_nodes();
 
+	// Ctrl+Shift+C / Ctrl+Shift+V 与系统剪贴板交换JSON
+	if (state == State::Editing)
+	{
+		if (ImGui::IsKeyChordPressed(ImGuiKey_ModCtrl | ImGuiKey_ModShift | ImGuiKey_C))
+			copy_selected_nodes_to_system();
+		if (ImGui::IsKeyChordPressed(ImGuiKey_ModCtrl | ImGuiKey_ModShift | ImGuiKey_V))
+			paste_nodes_from_system();
+	}
+
 	// Ctrl+Z 撤销
 	if (ImGui::IsKeyChordPressed(ImGuiKey_ModCtrl | ImGuiKey_Z) && state == State::Editing) undo();
 
@@ -1921,23 +1966,17 @@ void App::poll_state()
 	{
 		if (runner == nullptr) THROW_LOGIC_ERROR("Unexpected state: Preview when runner is not running");
 
-		auto& processor_resources = runner->get_processor_resources();
-		size_t finished_count = 0;
+		record_runner_metrics();
 
-		for (auto& [_, resource] : processor_resources)
+		if (runner->get_state_count(infra::Runner::State::Error) > 0)
 		{
-			if (resource->state == infra::Runner::State::Error)
-			{
-				show_preview_runner_error(resource->exception);
-				runner.reset();
-				state = State::Editing;
-				break;
-			}
-
-			finished_count += resource->state == infra::Runner::State::Finished ? 1 : 0;
+			show_preview_runner_error(*runner->get_error());
+			runner.reset();
+			state = State::Editing;
+			break;
 		}
 
-		if (finished_count == processor_resources.size())
+		if (runner->is_finished())
 		{
 			runner.reset();
 			state = State::Editing;
@@ -1968,23 +2007,17 @@ void App::poll_state()
 	{
 		if (runner == nullptr) THROW_LOGIC_ERROR("Unexpected state: Exporting when runner is not running");
 
-		auto& processor_resources = runner->get_processor_resources();
-		size_t finished_count = 0;
+		record_runner_metrics();
 
-		for (auto& [_, resource] : processor_resources)
+		if (runner->get_state_count(infra::Runner::State::Error) > 0)
 		{
-			if (resource->state == infra::Runner::State::Error)
-			{
-				show_export_runner_error(resource->exception);
-				runner.reset();
-				state = State::Editing;
-				break;
-			}
-
-			finished_count += resource->state == infra::Runner::State::Finished ? 1 : 0;
+			show_export_runner_error(*runner->get_error());
+			runner.reset();
+			state = State::Editing;
+			break;
 		}
 
-		if (finished_count == processor_resources.size())
+		if (runner->is_finished())
 		{
 			runner.reset();
 			state = State::Editing;
@@ -1997,6 +2030,60 @@ void App::poll_state()
 	}
 }
 
+// 记录运行器新发布的统计快照
+// - 快照按固定间隔发布，序号不变时不复制
+void App::record_runner_metrics()
+{
+	const auto sequence = runner->get_metrics_sequence();
+	if (sequence == metrics_sequence) return;
+	metrics_sequence = sequence;
+
+	auto metrics = runner->get_metrics();
+	if (metrics_history.size() < config::appearance::metrics_history_size)
+		metrics_history.push_back(std::move(metrics));
+	else
+	{
+		metrics_history[metrics_history_head] = std::move(metrics);
+		metrics_history_head = (metrics_history_head + 1) % metrics_history.size();
+	}
+}
+
+void App::reset_metrics_history()
+{
+	metrics_history.clear();
+	metrics_history_head = 0;
+	metrics_sequence = 0;
+}
+
+// 获取工程采样率
+// - 工程中指定了采样率时直接使用
+// - 否则取输入文件中最常见的采样率，个数相同时取较高者；所有输入采样率相同时，整个处理过程不需要重采样
+int App::get_project_sample_rate() const
+{
+	if (graph.sample_rate > 0) return graph.sample_rate;
+
+	std::map<int, size_t> counts;
+	for (const auto& [id, node] : graph.nodes)
+	{
+		const auto audio_input = std::dynamic_pointer_cast<processor::Audio_input>(node.processor);
+		if (audio_input == nullptr) continue;
+
+		for (const int sample_rate : audio_input->probe_sample_rates()) counts[sample_rate]++;
+	}
+
+	// 按采样率升序遍历，个数相同时后者覆盖前者
+	int dominant_rate = config::audio::default_sample_rate;
+	size_t dominant_count = 0;
+	for (const auto& [sample_rate, count] : counts)
+	{
+		if (count < dominant_count) continue;
+		dominant_rate = sample_rate;
+		dominant_count = count;
+	}
+
+	return dominant_rate;
+}
+
 // 创建预览运行器
 void App::create_preview_runner()
 {
@@ -2010,11 +2097,34 @@ void App::create_preview_runner()
 		return;
 	}
 
+	// 设备按工程采样率重新打开，预览输出不再经过SDL转换
+	runtime_config::sample_rate = get_project_sample_rate();
+	if (sdl_context.get_audio_device()->get_sample_rate() != runtime_config::sample_rate)
+	{
+		try
+		{
+			sdl_context.reopen_audio_device(
+				sdl_context.get_audio_device()->get_requested_buffer_size(),
+				runtime_config::sample_rate
+			);
+		}
+		catch (const std::runtime_error& e)
+		{
+			add_error_popup_window(
+				"Failed to launch preview",
+				std::format("Cannot open the audio device at {} Hz.", runtime_config::sample_rate),
+				e.what()
+			);
+			state = State::Editing;
+			return;
+		}
+	}
+
 	std::map<infra::Id_t, std::shared_ptr<std::any>> node_data;
 
 	for (auto& [idx, node] : graph.nodes)
 	{
-		const auto processor_info = node.processor->get_processor_info_non_static();
+		const auto& processor_info = node.processor->get_processor_info_non_static();
 
 		if (processor_info.identifier == config::logic::audio_output_node_name)
 			node_data[idx] = std::make_shared<std::any>(processor::Audio_output::Process_context{
@@ -2025,7 +2135,10 @@ void App::create_preview_runner()
 
 	try
 	{
+		runtime_config::block_size = app_settings.audio.preview_block_size;
+		runtime_config::exporting = false;
 		runner = infra::Runner::create_and_run(graph, std::move(node_data));
+		reset_metrics_history();
 		state = State::Previewing;
 	}
 	catch (const std::runtime_error& e)
@@ -2041,7 +2154,9 @@ void App::create_preview_runner()
 
 std::shared_ptr<std::atomic<double>> App::create_export_runner(
 	const std::string& export_file_path,
-	size_t kbps
+	processor::Export_format format,
+	size_t kbps,
+	bool parallel_encode
 )
 {
 	if (graph.nodes.empty())
@@ -2060,14 +2175,16 @@ std::shared_ptr<std::atomic<double>> App::create_export_runner(
 
 	for (auto& [idx, node] : graph.nodes)
 	{
-		const auto processor_info = node.processor->get_processor_info_non_static();
+		const auto& processor_info = node.processor->get_processor_info_non_static();
 
 		if (processor_info.identifier == config::logic::audio_output_node_name)
 		{
 			const auto context = processor::Audio_output::Process_context{
 				.do_export = true,
 				.export_path = export_file_path,
-				.kbps = kbps
+				.format = format,
+				.kbps = kbps,
+				.parallel_encode = parallel_encode
 			};
 
 			node_data[idx] = std::make_shared<std::any>(context);
@@ -2078,7 +2195,11 @@ std::shared_ptr<std::atomic<double>> App::create_export_runner(
 	try
 	{
 		state = State::Exporting;
+		runtime_config::block_size = app_settings.audio.export_block_size;
+		runtime_config::sample_rate = get_project_sample_rate();
+		runtime_config::exporting = true;
 		runner = infra::Runner::create_and_run(graph, std::move(node_data));
+		reset_metrics_history();
 	}
 	catch (const std::runtime_error& e)
 	{
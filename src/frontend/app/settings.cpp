@@ -4,7 +4,9 @@
 #include "utility/dialog-utility.hpp"
 
 #include <SDL.h>
+#include <algorithm>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <imgui.h>
 #include <iostream>
@@ -24,6 +26,7 @@ Json::Value UI_settings::serialize() const
 	SET_KEY(grid_size, Float);
 	SET_KEY(snap_to_grid, Bool);
 	SET_KEY(side_panel_width, Int);
+	SET_KEY(idle_throttle, Bool);
 	return json;
 }
 
@@ -35,6 +38,7 @@ void UI_settings::deserialize(const Json::Value& json)
 	GET_KEY(grid_size, Float);
 	GET_KEY(snap_to_grid, Bool);
 	GET_KEY(side_panel_width, Int);
+	GET_KEY(idle_throttle, Bool);
 }
 
 // EditorSettings
@@ -54,6 +58,32 @@ void Editor_settings::deserialize(const Json::Value& json)
 	GET_KEY(max_undo_levels, Int);
 }
 
+// Audio_settings
+Json::Value Audio_settings::serialize() const
+{
+	Json::Value json;
+	SET_KEY(device_buffer_size, Int);
+	SET_KEY(preview_block_size, Int);
+	SET_KEY(export_block_size, Int);
+	return json;
+}
+
+void Audio_settings::deserialize(const Json::Value& json)
+{
+	GET_KEY(device_buffer_size, Int);
+	GET_KEY(preview_block_size, Int);
+	GET_KEY(export_block_size, Int);
+
+	// 只接受预设中的块大小
+	const auto is_preset = [](int size)
+	{
+		const auto& presets = config::audio::block_size_presets;
+		return std::ranges::find(presets, size) != std::ranges::end(presets);
+	};
+	if (!is_preset(preview_block_size)) preview_block_size = Audio_settings().preview_block_size;
+	if (!is_preset(export_block_size)) export_block_size = Audio_settings().export_block_size;
+}
+
 // Export_settings
 Json::Value Export_settings::serialize() const
 {
@@ -73,6 +103,7 @@ Json::Value App_settings::serialize() const
 	Json::Value json;
 	json["ui"] = ui.serialize();
 	json["editor"] = editor.serialize();
+	json["audio"] = audio.serialize();
 	json["render"] = export_settings.serialize();
 	return json;
 }
@@ -81,6 +112,7 @@ void App_settings::deserialize(const Json::Value& json)
 {
 	if (json.isMember("ui")) ui.deserialize(json["ui"]);
 	if (json.isMember("editor")) editor.deserialize(json["editor"]);
+	if (json.isMember("audio")) audio.deserialize(json["audio"]);
 	if (json.isMember("render")) export_settings.deserialize(json["render"]);
 }
 // 设置文件管理
@@ -112,6 +144,7 @@ void App_settings::reset_to_defaults()
 {
 	ui = UI_settings();
 	editor = Editor_settings();
+	audio = Audio_settings();
 	export_settings = Export_settings();
 }
 
@@ -123,6 +156,14 @@ void Settings_window::draw_ui_tab()
 	ImGui::Checkbox("Show Toolbar", &new_settings.ui.show_toolbar);
 	ImGui::Checkbox("Show Minimap", &new_settings.ui.show_minimap);
 
+	// 无操作时阻塞等待输入，只以低帧率刷新
+	ImGui::Checkbox("Reduce Redraw When Idle", &new_settings.ui.idle_throttle);
+	if (ImGui::BeginItemTooltip())
+	{
+		ImGui::Text("Redraw at a low rate when there is no input and no preview or export running.");
+		ImGui::EndTooltip();
+	}
+
 	ImGui::SeparatorText("Grid Settings");
 
 	ImGui::Checkbox("Show Grid", &new_settings.ui.show_grid);
@@ -148,6 +189,59 @@ void Settings_window::draw_editor_tab()
 	ImGui::SliderInt("Max Undo Levels", &new_settings.editor.max_undo_levels, 10, 100);
 }
 
+void Settings_window::draw_audio_tab()
+{
+	ImGui::SeparatorText("Audio Preview");
+
+	// 缓冲区越小延迟越低，但更容易出现欠载（爆音）
+	ImGui::SetNextItemWidth(150);
+	if (ImGui::BeginCombo(
+			"Device Buffer Size",
+			std::format("{} samples", new_settings.audio.device_buffer_size).c_str()
+		))
+	{
+		for (const auto preset : config::audio::buffer_size_presets)
+		{
+			const bool is_selected = (preset == new_settings.audio.device_buffer_size);
+			if (ImGui::Selectable(
+					std::format(
+						"{} samples ({:.1f} ms)",
+						preset,
+						preset * 1000.0 / config::audio::default_sample_rate
+					)
+						.c_str(),
+					is_selected
+				))
+				new_settings.audio.device_buffer_size = preset;
+			if (is_selected) ImGui::SetItemDefaultFocus();
+		}
+
+		ImGui::EndCombo();
+	}
+
+	ImGui::SeparatorText("Processing");
+
+	// 输入与混音节点按固定长度的块输出
+	const auto block_size_combo = [](const char* label, int& block_size)
+	{
+		ImGui::SetNextItemWidth(150);
+		if (!ImGui::BeginCombo(label, std::format("{} samples", block_size).c_str())) return;
+
+		for (const auto preset : config::audio::block_size_presets)
+		{
+			const bool is_selected = (preset == block_size);
+			if (ImGui::Selectable(std::format("{} samples", preset).c_str(), is_selected))
+				block_size = preset;
+			if (is_selected) ImGui::SetItemDefaultFocus();
+		}
+
+		ImGui::EndCombo();
+	};
+
+	block_size_combo("Preview Block Size", new_settings.audio.preview_block_size);
+	block_size_combo("Export Block Size", new_settings.audio.export_block_size);
+}
+
 void Settings_window::draw_export_tab()
 {
 	ImGui::SeparatorText("Export Settings");
@@ -174,6 +268,7 @@ bool Settings_window::operator()(bool close_button_pressed)
 {
 	draw_ui_tab();
 	draw_editor_tab();
+	draw_audio_tab();
 	draw_export_tab();
 
 	ImGui::PushItemWidth(100);
@@ -8,6 +8,11 @@ namespace runtime_config
 {
 	// UI参数
 	float ui_scale = 1.0f;
+
+	// 处理参数
+	int block_size = config::audio::default_block_size;
+	int sample_rate = config::audio::default_sample_rate;
+	bool exporting = false;
 }
 
 SDL_context::SDL_context()
@@ -37,26 +42,15 @@ SDL_context::SDL_context()
 		throw std::runtime_error(std::format("Failed to create renderer: {}", SDL_GetError()));
 	}
 
-	SDL_AudioSpec audio_spec = {
-		.freq = config::audio::sample_rate,
-		.format = config::audio::buffer_format,
-		.channels = config::audio::channels,
-		.silence = 0,
-		.samples = config::audio::buffer_size,
-		.padding = 0,
-		.size = sizeof(config::audio::Buffer_type) * (config::audio::buffer_size * 3 / 2),
-		.callback = nullptr,
-		.userdata = nullptr,
-	};
-
-	audio_device = SDL_OpenAudioDevice(nullptr, false, &audio_spec, nullptr, SDL_AUDIO_ALLOW_ANY_CHANGE);
-	if (audio_device < 2)
+	auto audio_device_open = Audio_device::open(config::audio::buffer_size, runtime_config::sample_rate);
+	if (!audio_device_open.has_value())
 	{
 		SDL_DestroyRenderer(renderer);
 		SDL_DestroyWindow(window);
 		SDL_Quit();
 		throw std::runtime_error(std::format("Failed to open audio device: {}", SDL_GetError()));
 	}
+	audio_device = std::move(audio_device_open.value());
 
 	// determine scaling
 	// float dpi = 96;
@@ -70,13 +64,18 @@ SDL_context::SDL_context()
 	);
 }
 
+void SDL_context::reopen_audio_device(int buffer_size, int sample_rate)
+{
+	auto audio_device_open = Audio_device::open(buffer_size, sample_rate);
+	if (!audio_device_open.has_value())
+		throw std::runtime_error(std::format("Failed to open audio device: {}", SDL_GetError()));
+
+	audio_device = std::move(audio_device_open.value());
+}
+
 SDL_context::~SDL_context()
 {
-	if (audio_device >= 2)
-	{
-		SDL_ClearQueuedAudio(audio_device);
-		SDL_CloseAudioDevice(audio_device);
-	}
+	audio_device.reset();
 
 	if (renderer != nullptr) SDL_DestroyRenderer(renderer);
 	if (window != nullptr) SDL_DestroyWindow(window);
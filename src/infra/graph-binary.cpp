@@ -0,0 +1,226 @@
+#include "infra/graph.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+
+// 二进制工程格式（版本1），所有整数与浮点数均为小端序
+//
+// 文件头
+//   char[4]  magic = "NDYG"
+//   u32      version
+//   i32      sample_rate         // 0表示自动选择
+// 节点表
+//   u32      node_count
+//   node_count × {
+//     i32    id
+//     str    identifier
+//     f32    x, y                // 节点位置
+//     str    info                // 处理器参数，紧凑JSON
+//   }
+// 连结表
+//   u32      link_count
+//   link_count × {
+//     i32    from_node
+//     str    from_pin
+//     i32    to_node
+//     str    to_pin
+//   }
+//
+// str为u32长度加上不含结尾0的UTF-8字节
+
+namespace infra
+{
+	static_assert(std::endian::native == std::endian::little, "Binary project format assumes little endian");
+
+	static constexpr char binary_magic[4] = {'N', 'D', 'Y', 'G'};
+	static constexpr uint32_t binary_version = 1;
+
+	namespace
+	{
+		class Binary_writer
+		{
+			std::string buffer;
+
+		  public:
+
+			template <typename T>
+			void put(T value)
+			{
+				const auto offset = buffer.size();
+				buffer.resize(offset + sizeof(T));
+				std::memcpy(buffer.data() + offset, &value, sizeof(T));
+			}
+
+			void put_string(std::string_view value)
+			{
+				put(uint32_t(value.size()));
+				buffer.append(value);
+			}
+
+			void put_bytes(std::string_view value) { buffer.append(value); }
+
+			std::string take() { return std::move(buffer); }
+		};
+
+		class Binary_reader
+		{
+			std::string_view data;
+			size_t offset = 0;
+
+			void require(size_t size) const
+			{
+				if (data.size() - offset < size)
+					throw Graph::Invalid_file_error(
+						std::format("Binary project truncated at offset {}", offset)
+					);
+			}
+
+		  public:
+
+			Binary_reader(std::string_view data) :
+				data(data)
+			{
+			}
+
+			template <typename T>
+			T get()
+			{
+				require(sizeof(T));
+
+				T value;
+				std::memcpy(&value, data.data() + offset, sizeof(T));
+				offset += sizeof(T);
+				return value;
+			}
+
+			// 返回的视图指向原数据，不复制
+			std::string_view get_string()
+			{
+				const auto size = get<uint32_t>();
+				require(size);
+
+				const auto result = data.substr(offset, size);
+				offset += size;
+				return result;
+			}
+
+			bool at_end() const { return offset == data.size(); }
+		};
+	}
+
+	std::string Graph::encode_binary(const Json::Value& value)
+	{
+		const auto& nodes_json = value["nodes"];
+		const auto& links_json = value["links"];
+
+		Json::StreamWriterBuilder info_writer;
+		info_writer["indentation"] = "";
+
+		Binary_writer writer;
+
+		writer.put_bytes({binary_magic, sizeof(binary_magic)});
+		writer.put(binary_version);
+		writer.put(int32_t(value.get("sample_rate", 0).asInt()));
+
+		writer.put(uint32_t(nodes_json.size()));
+		for (auto it = nodes_json.begin(); it != nodes_json.end(); ++it)
+		{
+			const auto& node_json = *it;
+
+			writer.put(int32_t(std::stoi(it.name())));
+			writer.put_string(node_json["identifier"].asString());
+			writer.put(node_json["position"]["x"].asFloat());
+			writer.put(node_json["position"]["y"].asFloat());
+			writer.put_string(Json::writeString(info_writer, node_json["info"]));
+		}
+
+		writer.put(uint32_t(links_json.size()));
+		for (const auto& link : links_json)
+		{
+			writer.put(int32_t(link["from"]["node"].asInt()));
+			writer.put_string(link["from"]["pin"].asString());
+			writer.put(int32_t(link["to"]["node"].asInt()));
+			writer.put_string(link["to"]["pin"].asString());
+		}
+
+		return writer.take();
+	}
+
+	bool Graph::is_binary(std::string_view data)
+	{
+		return data.size() >= sizeof(binary_magic)
+			&& std::memcmp(data.data(), binary_magic, sizeof(binary_magic)) == 0;
+	}
+
+	Graph Graph::deserialize_binary(std::string_view data)
+	try
+	{
+		if (!is_binary(data)) throw Invalid_file_error("Not a binary project file");
+
+		Binary_reader reader(data.substr(sizeof(binary_magic)));
+
+		const auto version = reader.get<uint32_t>();
+		if (version != binary_version)
+			throw Invalid_file_error(std::format("Unsupported binary project version {}", version));
+
+		const auto sample_rate = reader.get<int32_t>();
+		if (sample_rate < 0) throw Invalid_file_error("Invalid sample rate, expected non-negative integer");
+
+		const std::unique_ptr<Json::CharReader> info_reader(Json::CharReaderBuilder().newCharReader());
+
+		// 数量来自文件，预留空间前不可信，逐个读取时再检查长度
+		const auto node_count = reader.get<uint32_t>();
+		std::vector<Node_description> node_list;
+
+		for (uint32_t i = 0; i < node_count; i++)
+		{
+			const auto id = reader.get<int32_t>();
+			const auto identifier = reader.get_string();
+			const auto x = reader.get<float>();
+			const auto y = reader.get<float>();
+			const auto info_string = reader.get_string();
+
+			Json::Value info;
+			std::string errors;
+			const char* const info_end = info_string.data() + info_string.size();
+			if (!info_reader->parse(info_string.data(), info_end, &info, &errors))
+				throw Invalid_file_error(std::format("Invalid processor info for node {}: {}", id, errors));
+
+			node_list.push_back(
+				Node_description{
+					.id = id,
+					.processor = create_processor(std::string(identifier), info),
+					.position = ImVec2(x, y)
+				}
+			);
+		}
+
+		const auto link_count = reader.get<uint32_t>();
+		std::vector<Link_description> link_list;
+
+		for (uint32_t i = 0; i < link_count; i++)
+		{
+			Link_description link;
+			link.from_node = reader.get<int32_t>();
+			link.from_pin = reader.get_string();
+			link.to_node = reader.get<int32_t>();
+			link.to_pin = reader.get_string();
+
+			link_list.push_back(std::move(link));
+		}
+
+		if (!reader.at_end()) throw Invalid_file_error("Unexpected trailing data in binary project");
+
+		Graph graph = build(std::move(node_list), link_list);
+		graph.sample_rate = sample_rate;
+
+		return graph;
+	}
+	catch (const Json::Exception& e)
+	{
+		throw Invalid_file_error(std::format("Failed to deserialize graph due to JSON error: {}", e.what()));
+	}
+}
@@ -0,0 +1,358 @@
+#include "infra/graph-history.hpp"
+#include "utility/logic-error-utility.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iterator>
+#include <source_location>
+
+namespace infra
+{
+	namespace
+	{
+		// 节点位置在编辑器坐标与网格坐标之间换算时会有舍入误差，不视为修改
+		bool same_position(ImVec2 a, ImVec2 b)
+		{
+			constexpr float tolerance = 1e-3f;
+			return std::abs(a.x - b.x) < tolerance && std::abs(a.y - b.y) < tolerance;
+		}
+
+		// 由节点ID与引脚名找到连结两端的引脚ID，节点或引脚不存在时返回std::nullopt
+		template <typename Link_record>
+		std::optional<std::pair<Id_t, Id_t>> find_link_pins(const Graph& graph, const Link_record& record)
+		{
+			const auto find_from_node = graph.nodes.find(record.from_node);
+			const auto find_to_node = graph.nodes.find(record.to_node);
+			if (find_from_node == graph.nodes.end() || find_to_node == graph.nodes.end()) return std::nullopt;
+
+			const auto& from_pin_map = find_from_node->second.pin_name_map;
+			const auto& to_pin_map = find_to_node->second.pin_name_map;
+
+			const auto find_from_pin = from_pin_map.find(record.from_pin);
+			const auto find_to_pin = to_pin_map.find(record.to_pin);
+			if (find_from_pin == from_pin_map.end() || find_to_pin == to_pin_map.end()) return std::nullopt;
+
+			return std::make_pair(find_from_pin->second, find_to_pin->second);
+		}
+	}
+
+	Graph_history::Graph_history(size_t max_levels) :
+		max_levels(max_levels)
+	{
+	}
+
+	Graph_history::Snapshot Graph_history::take_snapshot(const Graph& graph)
+	{
+		Snapshot snapshot;
+		snapshot.sample_rate = graph.sample_rate;
+
+		std::erase_if(
+			tracked_processors,
+			[&graph](const auto& item) { return !graph.nodes.contains(item.first); }
+		);
+
+		for (const auto& [id, node] : graph.nodes)
+		{
+			// 处理器被替换（如加载工程）时，即使ID与之前的节点相同也需要重新序列化
+			auto& tracked_processor = tracked_processors[id];
+			const bool same_processor = tracked_processor.lock() == node.processor;
+			if (!same_processor) tracked_processor = node.processor;
+
+			const auto find = tracked.nodes.find(id);
+			const auto& identifier = node.processor->get_processor_info_non_static().identifier;
+			const std::shared_ptr<const Node_record> record
+				= find != tracked.nodes.end() ? find->second : nullptr;
+
+			std::shared_ptr<const Json::Value> shared_info;
+			if (record != nullptr && same_processor && !dirty_nodes.contains(id))
+			{
+				// 处理器未被替换也未被标记修改，参数不变，不需要序列化
+				shared_info = record->info;
+			}
+			else
+			{
+				auto info = node.processor->serialize();
+
+				// 参数未变化时沿用上一次的记录，只比较不复制
+				if (record != nullptr && record->identifier == identifier && *record->info == info)
+					shared_info = record->info;
+				else
+					shared_info = std::make_shared<const Json::Value>(std::move(info));
+			}
+
+			if (record != nullptr && shared_info == record->info
+				&& same_position(record->position, node.position))
+			{
+				snapshot.nodes.emplace(id, record);
+				continue;
+			}
+
+			snapshot.nodes.emplace(
+				id,
+				std::make_shared<const Node_record>(
+					Node_record{
+						.identifier = identifier,
+						.info = std::move(shared_info),
+						.position = node.position
+					}
+				)
+			);
+		}
+
+		dirty_nodes.clear();
+
+		for (const auto& [_, link] : graph.links)
+		{
+			const auto& from_pin = graph.pins.at(link.from);
+			const auto& to_pin = graph.pins.at(link.to);
+
+			snapshot.links.emplace(
+				Link_record{
+					.from_node = from_pin.parent,
+					.from_pin = from_pin.attribute.identifier,
+					.to_node = to_pin.parent,
+					.to_pin = to_pin.attribute.identifier
+				}
+			);
+		}
+
+		return snapshot;
+	}
+
+	std::optional<Graph_history::Delta> Graph_history::diff(const Snapshot& before, const Snapshot& after)
+	{
+		Delta delta;
+
+		// 未变化的节点共享同一份记录，比较指针即可
+		for (const auto& [id, record] : before.nodes)
+		{
+			const auto find = after.nodes.find(id);
+			if (find == after.nodes.end())
+				delta.nodes.emplace(id, std::make_pair(record, nullptr));
+			else if (find->second != record)
+				delta.nodes.emplace(id, std::make_pair(record, find->second));
+		}
+
+		for (const auto& [id, record] : after.nodes)
+			if (!before.nodes.contains(id)) delta.nodes.emplace(id, std::make_pair(nullptr, record));
+
+		std::ranges::set_difference(
+			before.links,
+			after.links,
+			std::inserter(delta.removed_links, delta.removed_links.end())
+		);
+		std::ranges::set_difference(
+			after.links,
+			before.links,
+			std::inserter(delta.added_links, delta.added_links.end())
+		);
+
+		delta.sample_rate_before = before.sample_rate;
+		delta.sample_rate_after = after.sample_rate;
+
+		if (delta.nodes.empty() && delta.removed_links.empty() && delta.added_links.empty()
+			&& delta.sample_rate_before == delta.sample_rate_after)
+			return std::nullopt;
+
+		return delta;
+	}
+
+	void Graph_history::apply(Graph& graph, const Delta& delta, bool forward)
+	{
+		const auto& removed_links = forward ? delta.removed_links : delta.added_links;
+		const auto& added_links = forward ? delta.added_links : delta.removed_links;
+
+		// 先删除连结，再修改节点，最后添加连结；修改节点时与之相连的连结会被保留
+		for (const auto& record : removed_links)
+			if (const auto pins = find_link_pins(graph, record)) graph.remove_link(pins->first, pins->second);
+
+		for (const auto& [id, states] : delta.nodes)
+		{
+			const auto& target = forward ? states.second : states.first;
+			const auto find = graph.nodes.find(id);
+
+			if (target == nullptr)
+			{
+				if (find != graph.nodes.end()) graph.remove_node(id);
+				continue;
+			}
+
+			// 参数未变化（只移动了位置）时保留现有的处理器，未序列化的状态不会丢失
+			const auto& current = forward ? states.first : states.second;
+			if (find != graph.nodes.end() && current != nullptr && current->info == target->info
+				&& current->identifier == target->identifier)
+			{
+				find->second.position = target->position;
+				continue;
+			}
+
+			auto processor = Graph::create_processor(target->identifier, *target->info);
+
+			// 同类节点只替换处理器，原有引脚与连结按引脚名保留
+			if (find != graph.nodes.end()
+				&& find->second.processor->get_processor_info_non_static().identifier == target->identifier)
+			{
+				find->second.processor = std::move(processor);
+				find->second.position = target->position;
+				graph.update_node_pin(id);
+				continue;
+			}
+
+			if (find != graph.nodes.end()) graph.remove_node(id);
+
+			if (processor->get_processor_info_non_static().singleton)
+				graph.singleton_node_map.emplace(target->identifier, id);
+
+			graph.nodes.emplace(
+				id,
+				Graph::Node{
+					.processor = std::move(processor),
+					.pins = std::set<Id_t>(),
+					.pin_name_map = {},
+					.position = target->position
+				}
+			);
+			graph.update_node_pin(id);
+		}
+
+		for (const auto& record : added_links)
+		{
+			const auto pins = find_link_pins(graph, record);
+			if (!pins.has_value())
+				THROW_LOGIC_ERROR(
+					"Link {}.{} -> {}.{} in graph history references a missing pin",
+					record.from_node,
+					record.from_pin,
+					record.to_node,
+					record.to_pin
+				);
+
+			const bool exists = std::ranges::any_of(
+				graph.links,
+				[&pins](const auto& item)
+				{ return item.second.from == pins->first && item.second.to == pins->second; }
+			);
+			if (!exists) graph.add_link(pins->first, pins->second);
+		}
+
+		graph.sample_rate = forward ? delta.sample_rate_after : delta.sample_rate_before;
+		graph.modified = true;
+	}
+
+	void Graph_history::apply(Snapshot& snapshot, const Delta& delta, bool forward)
+	{
+		for (const auto& [id, states] : delta.nodes)
+		{
+			const auto& target = forward ? states.second : states.first;
+
+			if (target == nullptr)
+				snapshot.nodes.erase(id);
+			else
+				snapshot.nodes.insert_or_assign(id, target);
+		}
+
+		const auto& removed_links = forward ? delta.removed_links : delta.added_links;
+		const auto& added_links = forward ? delta.added_links : delta.removed_links;
+
+		for (const auto& record : removed_links) snapshot.links.erase(record);
+		for (const auto& record : added_links) snapshot.links.insert(record);
+
+		snapshot.sample_rate = forward ? delta.sample_rate_after : delta.sample_rate_before;
+	}
+
+	void Graph_history::track_processors(const Graph& graph, const Delta& delta)
+	{
+		for (const auto& [id, _] : delta.nodes)
+		{
+			if (const auto find = graph.nodes.find(id); find != graph.nodes.end())
+				tracked_processors.insert_or_assign(id, find->second.processor);
+			else
+				tracked_processors.erase(id);
+		}
+	}
+
+	void Graph_history::set_max_levels(size_t levels)
+	{
+		max_levels = levels;
+		while (undo_log.size() > max_levels) undo_log.pop_front();
+		while (redo_log.size() > max_levels) redo_log.pop_front();
+	}
+
+	void Graph_history::begin_edit(const Graph& graph)
+	{
+		commit(graph);
+
+		pending = true;
+		redo_log.clear();
+	}
+
+	bool Graph_history::commit(const Graph& graph)
+	{
+		pending = false;
+
+		auto snapshot = take_snapshot(graph);
+		auto delta = diff(tracked, snapshot);
+		tracked = std::move(snapshot);
+
+		if (!delta.has_value()) return false;
+
+		undo_log.push_back(std::move(*delta));
+		while (undo_log.size() > max_levels) undo_log.pop_front();
+
+		// 新的修改使重做记录失效
+		redo_log.clear();
+
+		return true;
+	}
+
+	bool Graph_history::undo(Graph& graph)
+	{
+		// 先记录尚未记录的修改，撤销的就是这一步
+		commit(graph);
+		if (undo_log.empty()) return false;
+
+		Delta delta = std::move(undo_log.back());
+		undo_log.pop_back();
+
+		apply(graph, delta, false);
+		apply(tracked, delta, false);
+		track_processors(graph, delta);
+
+		redo_log.push_back(std::move(delta));
+		while (redo_log.size() > max_levels) redo_log.pop_front();
+
+		return true;
+	}
+
+	bool Graph_history::redo(Graph& graph)
+	{
+		// 撤销后又做了修改时，重做记录已经失效
+		commit(graph);
+		if (redo_log.empty()) return false;
+
+		Delta delta = std::move(redo_log.back());
+		redo_log.pop_back();
+
+		apply(graph, delta, true);
+		apply(tracked, delta, true);
+		track_processors(graph, delta);
+
+		undo_log.push_back(std::move(delta));
+		while (undo_log.size() > max_levels) undo_log.pop_front();
+
+		return true;
+	}
+
+	void Graph_history::reset(const Graph& graph)
+	{
+		tracked = {};
+		tracked_processors.clear();
+		dirty_nodes.clear();
+		tracked = take_snapshot(graph);
+
+		undo_log.clear();
+		redo_log.clear();
+		pending = false;
+	}
+}
@@ -1,15 +1,29 @@
 #include "infra/graph.hpp"
+#include "utility/json-stream.hpp"
 #include "utility/logic-error-utility.hpp"
 
 #include <algorithm>
-#include <stack>
+#include <memory>
+#include <ostream>
 
 namespace infra
 {
+	std::shared_ptr<Processor> Graph::create_processor(const std::string& identifier, const Json::Value& info)
+	{
+		// 查找对应的节点元信息
+		const auto find_metadata = Processor::processor_map.find(identifier);
+		if (find_metadata == Processor::processor_map.end())
+			throw Invalid_file_error(std::format("Unknown processor identifier: {}", identifier));
+
+		std::shared_ptr<Processor> processor = find_metadata->second.generate();
+		processor->deserialize(info);
+		return processor;
+	}
+
 	Id_t Graph::add_node(std::unique_ptr<Processor> processor)
 	{
 		Id_t id = find_empty(nodes);
-		const auto info = processor->get_processor_info_non_static();
+		const auto& info = processor->get_processor_info_non_static();
 
 		nodes[id] = {.processor = std::move(processor), .pins = std::set<Id_t>(), .pin_name_map = {}};
 		update_node_pin(id);
@@ -25,7 +39,7 @@ namespace infra
 	{
 		auto& item = nodes[id];
 		auto& set = item.pins;
-		const auto info = item.processor->get_processor_info_non_static();
+		const auto& info = item.processor->get_processor_info_non_static();
 		if (info.singleton)
 		{
 			auto it = singleton_node_map.find(info.identifier);
@@ -162,189 +176,162 @@ namespace infra
 	std::map<Id_t, std::set<Id_t>> Graph::get_node_input_map() const
 	{
 		std::map<Id_t, std::set<Id_t>> map;
-		const auto pin_to_node = get_pin_to_node_map();
+		for (const auto& [idx, _] : nodes) map.emplace(idx, std::set<Id_t>());
 
-		for (const auto& [idx, _] : nodes)
-		{
-			auto count_view
-				= links | std::views::values
-				| std::views::filter([idx, this](Link link) { return pins.at(link.to).parent == idx; })
-				| std::views::transform(Link::Transform::from);
-
-			map.emplace(idx, std::set<Id_t>(count_view.begin(), count_view.end()));
-		}
+		// 只遍历一遍连结，不对每个节点重复扫描
+		for (const auto& [_, link] : links) map[pins.at(link.to).parent].insert(link.from);
 
 		return map;
 	}
 
 	void Graph::check_graph() const
 	{
-		std::map<Id_t, Id_t> pin_to_node = get_pin_to_node_map();
+		std::map<Id_t, size_t> input_count;
 		std::map<Id_t, std::set<Id_t>> node_to_output_map;
-		std::map<Id_t, std::set<Id_t>> node_to_input_map = get_node_input_map();
 		std::map<Id_t, size_t> node_in_degree;
-		std::set<Id_t> zero_degree_set;
 
-		for (const auto& [idx, input_set] : node_to_input_map) node_in_degree.emplace(idx, input_set.size());
+		for (const auto& [idx, _] : nodes) node_in_degree.emplace(idx, 0);
 
 		// 统计节点关系和入度
-		for (const auto [idx, item] : links)
+		for (const auto& [idx, item] : links)
 		{
 			const auto [from, to] = item;
 
 			if (!check_node_type_match(from, to)) throw Mismatched_pin_error{from, to};
-			if (!check_multiple_input(to)) [[unlikely]]
+			if (++input_count[to] > 1) [[unlikely]]
 				throw Multiple_input_error(to);
 
-			node_to_output_map[pins.at(from).parent].insert(pins.at(to).parent);
+			if (node_to_output_map[pins.at(from).parent].insert(pins.at(to).parent).second)
+				node_in_degree[pins.at(to).parent]++;
 		}
 
-		/* 寻找0入度的节点 */
-		{
-			auto zero_degree_nodes = node_in_degree
-								   | std::views::filter([](const auto& item) { return item.second == 0; })
-								   | std::views::keys;
-
-			zero_degree_set.insert_range(zero_degree_nodes);
+		/* 拓扑排序，无法排完的节点在环上 */
 
-			if (!nodes.empty() && zero_degree_set.empty()) [[unlikely]]
-				throw Loop_detected_error{};
-		}
+		std::vector<Id_t> zero_degree_nodes;
+		for (const auto& [idx, degree] : node_in_degree)
+			if (degree == 0) zero_degree_nodes.push_back(idx);
 
-		/* 使用状态机遍历 */
-
-		enum class State
+		size_t visited_count = 0;
+		while (!zero_degree_nodes.empty())
 		{
-			Check_node,
-			Push_node,
-			Traverse_children,
-			Pop_node
-		};
+			const Id_t node = zero_degree_nodes.back();
+			zero_degree_nodes.pop_back();
+			visited_count++;
 
-		struct Traverse_stack_element
-		{
-			std::set<Id_t>::const_iterator node, begin, end;
-		};
+			const auto find = node_to_output_map.find(node);
+			if (find == node_to_output_map.end()) continue;
 
-		State state = State::Traverse_children;
-		std::vector<Traverse_stack_element> traverse_stack = {
-			Traverse_stack_element{.node = {}, .begin = zero_degree_set.begin(), .end = zero_degree_set.end()}
-		};
-		std::set<Id_t>::const_iterator node;
-		std::set<Id_t> visited_nodes;
+			for (const auto child : find->second)
+				if (--node_in_degree[child] == 0) zero_degree_nodes.push_back(child);
+		}
 
-		auto check_node = [&](std::set<Id_t>::const_iterator it) -> bool
-		{
-			return std::ranges::all_of(traverse_stack, [&](const auto& elem) { return it != elem.node; });
-		};
+		if (visited_count != nodes.size()) [[unlikely]]
+			throw Loop_detected_error{};
+	}
 
-		while (!traverse_stack.empty())
-		{
-			switch (state)
-			{
-			case State::Check_node:
-				if (!check_node(node)) throw Loop_detected_error{};
-				visited_nodes.insert(*node);
-				state = State::Push_node;
-				break;
-
-			case State::Push_node:
-				traverse_stack.push_back(
-					Traverse_stack_element{
-						.node = node,
-						.begin = node_to_output_map[*node].begin(),
-						.end = node_to_output_map[*node].end()
-					}
-				);
-				state = State::Traverse_children;
-				break;
+	// 节点格式 <node>
+	// "0": {
+	//     "identifier": "node_identifier",
+	//     "info": { ... },  // 节点信息
+	//     "position": { // 节点位置
+	//         "x": 0,
+	//         "y": 0
+	//     }
+	// }
+	static Json::Value serialize_node(const Graph::Node& node, ImVec2 position_offset)
+	{
+		Json::Value item;
 
-			case State::Traverse_children:
-				if (traverse_stack.back().begin == traverse_stack.back().end)
-				{
-					state = State::Pop_node;
-					break;
-				}
-				node = traverse_stack.back().begin++;
-				state = State::Check_node;
-				break;
-
-			case State::Pop_node:
-				traverse_stack.pop_back();
-				state = State::Traverse_children;
-				break;
-			}
-		}
+		item["identifier"] = node.processor->get_processor_info_non_static().identifier;
+		item["info"] = node.processor->serialize();
+		item["position"]["x"] = node.position.x + position_offset.x;
+		item["position"]["y"] = node.position.y + position_offset.y;
 
-		for (auto node : visited_nodes) node_in_degree.erase(node);
-		if (!node_in_degree.empty()) [[unlikely]]
-			throw Loop_detected_error{};
+		return item;
 	}
 
-	Json::Value Graph::serialize() const
+	// 连结格式 <link>
+	// {
+	//     "from": {
+	//         "node": 0,
+	//         "pin": "from_pin_name"
+	//     },
+	//     "to": {
+	//         "node": 1,
+	//         "pin": "to_pin_name"
+	//     }
+	// }
+	static Json::Value serialize_link(const Graph& graph, const Graph::Link& link)
 	{
-		Json::Value node_json(Json::ValueType::objectValue);
+		const auto& from_pin = graph.pins.at(link.from);
+		const auto& to_pin = graph.pins.at(link.to);
 
-		// 节点格式 <node>
-		// "0": {
-		//     "identifier": "node_identifier",
-		//     "info": { ... },  // 节点信息
-		//     "position": { // 节点位置
-		//         "x": 0,
-		//         "y": 0
-		//     }
-		// }
+		Json::Value from_json;
+		from_json["node"] = from_pin.parent;
+		from_json["pin"] = from_pin.attribute.identifier;
 
-		for (const auto& [id, node] : nodes)
-		{
-			const auto processor_info = node.processor->get_processor_info_non_static();
+		Json::Value to_json;
+		to_json["node"] = to_pin.parent;
+		to_json["pin"] = to_pin.attribute.identifier;
 
-			Json::Value item;
+		Json::Value item;
+		item["from"] = std::move(from_json);
+		item["to"] = std::move(to_json);
 
-			item["identifier"] = processor_info.identifier;
-			item["info"] = node.processor->serialize();
-			item["position"]["x"] = node.position.x;
-			item["position"]["y"] = node.position.y;
+		return item;
+	}
 
-			node_json[std::to_string(id)] = std::move(item);
-		}
+	static Graph::Node_description parse_node(const std::string& key, const Json::Value& node_json)
+	{
+		// id转int
+		size_t integer_processed;
+		const Id_t id = std::stoi(key, &integer_processed);
+		if (integer_processed != key.length())
+			throw Graph::Invalid_file_error(std::format("Invalid node ID: {}", key));
+
+		if (!node_json.isObject())
+			throw Graph::Invalid_file_error(std::format("Invalid node JSON format for ID: {}", id));
+
+		return Graph::Node_description{
+			.id = id,
+			.processor = Graph::create_processor(node_json["identifier"].asString(), node_json["info"]),
+			.position = ImVec2(node_json["position"]["x"].asFloat(), node_json["position"]["y"].asFloat())
+		};
+	}
 
-		Json::Value link_json(Json::ValueType::arrayValue);
+	static Graph::Link_description parse_link(const Json::Value& link)
+	{
+		if (!link.isObject()) throw Graph::Invalid_file_error("Invalid link JSON format, expected object");
 
-		// 连结格式 <link>
-		// {
-		//     "from": {
-		//         "node": 0,
-		//         "pin": "from_pin_name"
-		//     },
-		//     "to": {
-		//         "node": 1,
-		//         "pin": "to_pin_name"
-		//     }
-		// }
+		const auto& from_json = link["from"];
+		const auto& to_json = link["to"];
 
-		for (const auto& [idx, link] : links)
-		{
-			const auto [from, to] = link;
-			const auto& from_pin = pins.at(from);
-			const auto& to_pin = pins.at(to);
+		if (!from_json.isObject() || !to_json.isObject())
+			throw Graph::Invalid_file_error("Invalid link 'from' or 'to' JSON format, expected object");
 
-			const auto& from_name = from_pin.attribute.identifier;
-			const auto& to_name = to_pin.attribute.identifier;
+		return Graph::Link_description{
+			.from_node = from_json["node"].asInt(),
+			.from_pin = from_json["pin"].asString(),
+			.to_node = to_json["node"].asInt(),
+			.to_pin = to_json["pin"].asString()
+		};
+	}
 
-			Json::Value from_json;
-			from_json["node"] = from_pin.parent;
-			from_json["pin"] = from_name;
+	static int parse_sample_rate(const Json::Value& value)
+	{
+		if (!value.isInt() || value.asInt() <= 0)
+			throw Graph::Invalid_file_error("Invalid sample rate, expected positive integer");
+		return value.asInt();
+	}
 
-			Json::Value to_json;
-			to_json["node"] = to_pin.parent;
-			to_json["pin"] = to_name;
+	Json::Value Graph::serialize(ImVec2 position_offset) const
+	{
+		Json::Value node_json(Json::ValueType::objectValue);
+		for (const auto& [id, node] : nodes)
+			node_json[std::to_string(id)] = serialize_node(node, position_offset);
 
-			Json::Value item;
-			item["from"] = std::move(from_json);
-			item["to"] = std::move(to_json);
-			link_json.append(std::move(item));
-		}
+		Json::Value link_json(Json::ValueType::arrayValue);
+		for (const auto& [idx, link] : links) link_json.append(serialize_link(*this, link));
 
 		// 最终输出格式
 		// {
@@ -361,120 +348,330 @@ namespace infra
 		//         {
 		//             ...
 		//         }
-		//     ]
+		//     ],
+		//     "sample_rate": 44100  // 工程采样率，自动选择时省略
 		// }
 
 		Json::Value result;
 		result["nodes"] = std::move(node_json);
 		result["links"] = std::move(link_json);
+		if (sample_rate > 0) result["sample_rate"] = sample_rate;
 
 		return result;
 	}
 
-	Graph Graph::deserialize(const Json::Value& value)
-	try
+	void Graph::serialize(std::ostream& stream, ImVec2 position_offset) const
 	{
-		if (!value.isObject()) throw Invalid_file_error("Invalid graph format, expected object");
+		// 每个节点与连结单独生成JSON并直接写入流，占一行，不生成整个图的JSON树
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = "";
+		const std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
 
-		const auto& nodes_json = value["nodes"];
-		const auto& links_json = value["links"];
+		stream << "{\n  \"nodes\": {";
 
-		if (!nodes_json.isObject()) throw Invalid_file_error("Invalid nodes format, expected object");
-		if (!links_json.isArray()) throw Invalid_file_error("Invalid links format, expected array");
+		bool first = true;
+		for (const auto& [id, node] : nodes)
+		{
+			stream << (first ? "\n    \"" : ",\n    \"") << id << "\": ";
+			writer->write(serialize_node(node, position_offset), &stream);
+			first = false;
+		}
 
-		Graph graph;
+		stream << (first ? "},\n  \"links\": [" : "\n  },\n  \"links\": [");
 
-		for (const auto& key : nodes_json.getMemberNames())
+		first = true;
+		for (const auto& [idx, link] : links)
 		{
-			// id转int
-			size_t integer_processed;
-			const Id_t id = std::stoi(key, &integer_processed);
-			if (integer_processed != key.length())
-				throw Invalid_file_error(std::format("Invalid node ID: {}", key));
+			stream << (first ? "\n    " : ",\n    ");
+			writer->write(serialize_link(*this, link), &stream);
+			first = false;
+		}
 
-			const auto& node_json = nodes_json[key];
-			if (!node_json.isObject())
-				throw Invalid_file_error(std::format("Invalid node JSON format for ID: {}", id));
+		stream << (first ? "]" : "\n  ]");
+		if (sample_rate > 0) stream << ",\n  \"sample_rate\": " << sample_rate;
+		stream << "\n}\n";
+	}
 
-			const std::string identifier = node_json["identifier"].asString();
+	void Graph::add_node_pins(Id_t id, Node& node, Id_t& next_pin_id)
+	{
+		for (auto& attribute : node.processor->get_pin_attributes())
+		{
+			const Id_t pin_id = next_pin_id++;
 
-			// 查找对应的节点元信息
-			const auto find_metadata = Processor::processor_map.find(identifier);
-			if (find_metadata == Processor::processor_map.end())
-				throw Invalid_file_error(std::format("Unknown processor identifier: {}", identifier));
-			const auto& metadata = find_metadata->second;
+			if (!node.pin_name_map.emplace(attribute.identifier, pin_id).second)
+				THROW_LOGIC_ERROR("Pin name {} already exists for node ID {}", attribute.identifier, id);
 
-			std::shared_ptr<Processor> processor = metadata.generate();
-			processor->deserialize(node_json["info"]);
+			node.pins.emplace_hint(node.pins.end(), pin_id);
+			pins.emplace_hint(pins.end(), pin_id, Pin{.parent = id, .attribute = std::move(attribute)});
+		}
+	}
 
-			// 单例处理逻辑
-			if (metadata.singleton)
-			{
-				if (graph.singleton_node_map.contains(identifier))
-					throw Invalid_file_error(std::format("Duplicating singleton node \"{}\"", identifier));
+	Graph Graph::build(std::vector<Node_description> node_list, std::span<const Link_description> link_list)
+	{
+		Graph graph;
 
-				graph.singleton_node_map.emplace(identifier, id);
-			}
+		// 引脚与连结的ID按顺序分配，不逐个查找空闲ID
+		Id_t next_pin_id = 0;
 
-			graph.nodes.emplace(
-				id,
-				Graph::Node{
-					.processor = std::move(processor),
+		for (auto& description : node_list)
+		{
+			const auto& info = description.processor->get_processor_info_non_static();
+
+			if (info.singleton && !graph.singleton_node_map.emplace(info.identifier, description.id).second)
+				throw Invalid_file_error(std::format("Duplicating singleton node \"{}\"", info.identifier));
+
+			const auto [node_it, inserted] = graph.nodes.emplace(
+				description.id,
+				Node{
+					.processor = std::move(description.processor),
 					.pins = std::set<Id_t>(),
 					.pin_name_map = {},
-					.position
-					= ImVec2(node_json["position"]["x"].asFloat(), node_json["position"]["y"].asFloat())
+					.position = description.position
 				}
 			);
+			if (!inserted) throw Invalid_file_error(std::format("Duplicating node ID: {}", description.id));
 
-			graph.update_node_pin(id);
+			graph.add_node_pins(description.id, node_it->second, next_pin_id);
 		}
 
-		for (const auto& link : links_json)
-		{
-			if (!link.isObject()) throw Invalid_file_error("Invalid link JSON format, expected object");
-
-			const auto& from_json = link["from"];
-			const auto& to_json = link["to"];
+		Id_t next_link_id = 0;
 
-			if (!from_json.isObject() || !to_json.isObject())
-				throw Invalid_file_error("Invalid link 'from' or 'to' JSON format, expected object");
-
-			const Id_t from_node = from_json["node"].asInt();
-			const Id_t to_node = to_json["node"].asInt();
-
-			const std::string from_pin_name = from_json["pin"].asString();
-			const std::string to_pin_name = to_json["pin"].asString();
+		for (const auto& description : link_list)
+		{
+			const auto find_from_node = graph.nodes.find(description.from_node);
+			const auto find_to_node = graph.nodes.find(description.to_node);
 
-			if (!graph.nodes.contains(from_node) || !graph.nodes.contains(to_node))
+			if (find_from_node == graph.nodes.end() || find_to_node == graph.nodes.end())
 				throw Invalid_file_error(
-					std::format("Link references non-existent node: {} -> {}", from_node, to_node)
+					std::format(
+						"Link references non-existent node: {} -> {}",
+						description.from_node,
+						description.to_node
+					)
 				);
 
-			const auto& from_pin_map = graph.nodes.at(from_node).pin_name_map;
-			const auto& to_pin_map = graph.nodes.at(to_node).pin_name_map;
+			const auto& from_pin_map = find_from_node->second.pin_name_map;
+			const auto& to_pin_map = find_to_node->second.pin_name_map;
 
-			if (!from_pin_map.contains(from_pin_name) || !to_pin_map.contains(to_pin_name))
+			const auto find_from_pin = from_pin_map.find(description.from_pin);
+			const auto find_to_pin = to_pin_map.find(description.to_pin);
+
+			if (find_from_pin == from_pin_map.end() || find_to_pin == to_pin_map.end())
 				throw Invalid_file_error(
 					std::format(
 						"Link references non-existent pin: {}.{} -> {}.{}",
-						from_node,
-						from_pin_name,
-						to_node,
-						to_pin_name
+						description.from_node,
+						description.from_pin,
+						description.to_node,
+						description.to_pin
 					)
 				);
 
-			const Id_t from_id = from_pin_map.at(from_pin_name);
-			const Id_t to_id = to_pin_map.at(to_pin_name);
+			graph.links.emplace_hint(
+				graph.links.end(),
+				next_link_id++,
+				Link{.from = find_from_pin->second, .to = find_to_pin->second}
+			);
+		}
 
-			graph.add_link(from_id, to_id);
+		// 所有连结添加完成后统一检查一次
+		try
+		{
+			graph.check_graph();
+		}
+		catch (const Invalid_file_error&)
+		{
+			throw;
 		}
+		catch (const std::runtime_error& e)
+		{
+			throw Invalid_file_error(e.what());
+		}
+
+		return graph;
+	}
+
+	Graph Graph::deserialize(const Json::Value& value)
+	try
+	{
+		if (!value.isObject()) throw Invalid_file_error("Invalid graph format, expected object");
+
+		const auto& nodes_json = value["nodes"];
+		const auto& links_json = value["links"];
+
+		if (!nodes_json.isObject()) throw Invalid_file_error("Invalid nodes format, expected object");
+		if (!links_json.isArray()) throw Invalid_file_error("Invalid links format, expected array");
+
+		std::vector<Node_description> node_list;
+		node_list.reserve(nodes_json.size());
+		for (auto it = nodes_json.begin(); it != nodes_json.end(); ++it)
+			node_list.push_back(parse_node(it.name(), *it));
+
+		std::vector<Link_description> link_list;
+		link_list.reserve(links_json.size());
+		for (const auto& link : links_json) link_list.push_back(parse_link(link));
+
+		Graph graph = build(std::move(node_list), link_list);
+
+		// 旧版本的工程文件没有该字段，按自动选择处理
+		if (value.isMember("sample_rate")) graph.sample_rate = parse_sample_rate(value["sample_rate"]);
+
+		return graph;
+	}
+	catch (const Json::Exception& e)
+	{
+		throw Invalid_file_error(std::format("Failed to deserialize graph due to JSON error: {}", e.what()));
+	}
+
+	Graph Graph::deserialize(std::istream& stream)
+	try
+	{
+		Json_stream_reader reader(stream);
+
+		std::vector<Node_description> node_list;
+		std::vector<Link_description> link_list;
+		int sample_rate = 0;
+		bool has_nodes = false, has_links = false;
+
+		// 每次只解析一个节点或连结的JSON，解析后立即生成处理器
+		reader.read_object(
+			[&](const std::string& key)
+			{
+				if (key == "nodes")
+				{
+					has_nodes = true;
+					reader.read_object(
+						[&](const std::string& id)
+						{ node_list.push_back(parse_node(id, reader.read_value())); }
+					);
+				}
+				else if (key == "links")
+				{
+					has_links = true;
+					reader.read_array([&] { link_list.push_back(parse_link(reader.read_value())); });
+				}
+				else if (key == "sample_rate")
+					sample_rate = parse_sample_rate(reader.read_value());
+				else
+					reader.skip_value();
+			}
+		);
+		reader.expect_end();
+
+		if (!has_nodes) throw Invalid_file_error("Invalid nodes format, expected object");
+		if (!has_links) throw Invalid_file_error("Invalid links format, expected array");
+
+		Graph graph = build(std::move(node_list), link_list);
+		graph.sample_rate = sample_rate;
 
 		return graph;
 	}
+	catch (const Json_stream_reader::Parse_error& e)
+	{
+		throw Invalid_file_error(std::format("Failed to parse JSON: {}", e.what()));
+	}
 	catch (const Json::Exception& e)
 	{
 		throw Invalid_file_error(std::format("Failed to deserialize graph due to JSON error: {}", e.what()));
 	}
-}
\ No newline at end of file
+
+	Graph::Subgraph Graph::extract(std::span<const Id_t> node_ids, std::span<const Id_t> link_ids) const
+	{
+		Subgraph subgraph;
+		std::set<Id_t> extracted;
+
+		subgraph.nodes.reserve(node_ids.size());
+		for (const auto id : node_ids)
+		{
+			const auto find = nodes.find(id);
+			if (find == nodes.end() || !extracted.insert(id).second) continue;
+
+			subgraph.nodes.push_back(
+				{.id = id, .processor = find->second.processor->clone(), .position = find->second.position}
+			);
+		}
+
+		const auto append_link = [&](const Link& link)
+		{
+			const auto& from_pin = pins.at(link.from);
+			const auto& to_pin = pins.at(link.to);
+			if (!extracted.contains(from_pin.parent) || !extracted.contains(to_pin.parent)) return;
+
+			subgraph.links.push_back(
+				{.from_node = from_pin.parent,
+				 .from_pin = from_pin.attribute.identifier,
+				 .to_node = to_pin.parent,
+				 .to_pin = to_pin.attribute.identifier}
+			);
+		};
+
+		if (link_ids.empty())
+			for (const auto& [_, link] : links) append_link(link);
+		else
+			for (const auto id : link_ids)
+				if (const auto find = links.find(id); find != links.end()) append_link(find->second);
+
+		return subgraph;
+	}
+
+	std::map<Id_t, Id_t> Graph::insert(const Subgraph& subgraph, ImVec2 offset)
+	{
+		const auto next_id = [](const auto& map) -> Id_t
+		{ return map.empty() ? 0 : map.rbegin()->first + 1; };
+
+		Id_t next_node_id = next_id(nodes);
+		Id_t next_pin_id = next_id(pins);
+		Id_t next_link_id = next_id(links);
+
+		std::map<Id_t, Id_t> node_id_map;
+
+		for (const auto& description : subgraph.nodes)
+		{
+			const auto& info = description.processor->get_processor_info_non_static();
+			if (info.singleton && singleton_node_map.contains(info.identifier)) continue;
+
+			const Id_t id = next_node_id++;
+			const ImVec2 position(description.position.x + offset.x, description.position.y + offset.y);
+
+			const auto node_it = nodes.emplace_hint(
+				nodes.end(),
+				id,
+				Node{
+					.processor = description.processor->clone(),
+					.pins = std::set<Id_t>(),
+					.pin_name_map = {},
+					.position = position
+				}
+			);
+
+			add_node_pins(id, node_it->second, next_pin_id);
+			if (info.singleton) singleton_node_map.emplace(info.identifier, id);
+			node_id_map.emplace(description.id, id);
+		}
+
+		for (const auto& description : subgraph.links)
+		{
+			const auto find_from_node = node_id_map.find(description.from_node);
+			const auto find_to_node = node_id_map.find(description.to_node);
+			if (find_from_node == node_id_map.end() || find_to_node == node_id_map.end()) continue;
+
+			const auto& from_pin_map = nodes.at(find_from_node->second).pin_name_map;
+			const auto& to_pin_map = nodes.at(find_to_node->second).pin_name_map;
+
+			const auto find_from_pin = from_pin_map.find(description.from_pin);
+			const auto find_to_pin = to_pin_map.find(description.to_pin);
+			if (find_from_pin == from_pin_map.end() || find_to_pin == to_pin_map.end()) continue;
+			if (!check_node_type_match(find_from_pin->second, find_to_pin->second)) continue;
+
+			links.emplace_hint(
+				links.end(),
+				next_link_id++,
+				Link{.from = find_from_pin->second, .to = find_to_pin->second}
+			);
+		}
+
+		modified = true;
+
+		return node_id_map;
+	}
+}
@@ -3,4 +3,14 @@
 namespace infra
 {
 	std::map<std::string, Processor::Info> Processor::processor_map = {};
+
+	std::unique_ptr<Processor> Processor::clone() const
+	{
+		const auto& info = get_processor_info_non_static();
+		if (info.generate == nullptr) THROW_LOGIC_ERROR("Processor \"{}\" can't be cloned", info.identifier);
+
+		auto result = info.generate();
+		result->deserialize(serialize());
+		return result;
+	}
 }
\ No newline at end of file
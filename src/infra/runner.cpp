@@ -1,10 +1,13 @@
 #include "infra/runner.hpp"
 
+#include <algorithm>
 #include <barrier>
 #include <boost/fiber/algo/work_stealing.hpp>
 #include <boost/fiber/operations.hpp>
 
+#include <condition_variable>
 #include <print>
+#include <ranges>
 
 namespace infra
 {
@@ -48,10 +51,19 @@ namespace infra
 
 			link_products.emplace(idx, product);
 		}
+
+		state_counts[std::to_underlying(State::Ready)] = processor_resources.size();
 	}
 
 	Runner::~Runner()
 	{
+		// 统计线程会读取连结产品，先于资源停止
+		if (metrics_thread.joinable())
+		{
+			metrics_thread.request_stop();
+			metrics_thread.join();
+		}
+
 		for (auto& [_, resource] : processor_resources)
 		{
 			resource->stop_source = true;
@@ -74,7 +86,7 @@ namespace infra
 
 					try
 					{
-						ptr->state = State::Running;
+						set_state(*ptr, State::Running);
 						ptr->processor->process_payload(
 							ptr->input_payloads,
 							ptr->output_payloads,
@@ -82,17 +94,17 @@ namespace infra
 							find_node_data == node_data.end() ? fallback : *(find_node_data->second)
 						);
 
-						ptr->state = State::Finished;
+						set_state(*ptr, State::Finished);
 					}
 					catch (const Processor::Runtime_error& e)
 					{
 						ptr->exception = e;
-						ptr->state = State::Error;
+						set_state(*ptr, State::Error);
 					}
 					catch (const std::runtime_error& e)
 					{
 						ptr->exception = e;
-						ptr->state = State::Error;
+						set_state(*ptr, State::Error);
 					}
 					catch (const std::bad_any_cast& e)
 					{
@@ -102,7 +114,7 @@ namespace infra
 								ptr->processor->get_processor_info_non_static().identifier
 							)
 						);
-						ptr->state = State::Error;
+						set_state(*ptr, State::Error);
 					}
 					catch (const std::bad_alloc& e)
 					{
@@ -112,7 +124,7 @@ namespace infra
 								ptr->processor->get_processor_info_non_static().identifier
 							)
 						);
-						ptr->state = State::Error;
+						set_state(*ptr, State::Error);
 					}
 					catch (const std::bad_optional_access& e)
 					{
@@ -122,33 +134,182 @@ namespace infra
 								ptr->processor->get_processor_info_non_static().identifier
 							)
 						);
-						ptr->state = State::Error;
+						set_state(*ptr, State::Error);
 					}
 					catch (const std::logic_error& e)
 					{
 						ptr->exception = e;
-						ptr->state = State::Error;
+						set_state(*ptr, State::Error);
 					}
 					catch (...)
 					{
 						ptr->exception = std::exception();
-						ptr->state = State::Error;
+						set_state(*ptr, State::Error);
 					}
 				}
 			);
 		}
 	}
 
+	void Runner::set_state(Processor_resource& resource, State state)
+	{
+		// 先修改状态再更新计数，读取者看到计数变化时可以找到对应状态的处理器
+		const State previous = resource.state.exchange(state);
+		++state_counts[std::to_underlying(state)];
+		--state_counts[std::to_underlying(previous)];
+	}
+
+	void Runner::publish_metrics(std::stop_token stop_token)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		const auto start_time = Clock::now();
+		auto previous_time = start_time;
+		std::map<Id_t, Processor::Product::Buffer_stats> previous_stats;
+
+		std::mutex wait_mutex;
+		std::condition_variable_any condition;
+		std::unique_lock lock(wait_mutex);
+
+		while (!condition.wait_for(lock, stop_token, metrics_interval, [] { return false; })
+			   && !stop_token.stop_requested())
+		{
+			const auto now = Clock::now();
+			const double elapsed = std::chrono::duration<double>(now - previous_time).count();
+			previous_time = now;
+
+			Metrics snapshot;
+			snapshot.time = std::chrono::duration<double>(now - start_time).count();
+			for (size_t i = 0; i < state_count; i++) snapshot.state_counts[i] = state_counts[i].load();
+
+			snapshot.links.reserve(link_products.size());
+			for (const auto& [id, product] : link_products)
+			{
+				const auto stats = product->get_buffer_stats();
+				if (!stats.has_value()) continue;
+
+				// 速率与取空次数按两次快照之间的差值计算
+				auto& previous = previous_stats[id];
+				const auto transferred = stats->transferred - previous.transferred;
+
+				snapshot.links.push_back(
+					{.id = id,
+					 .fill = stats->capacity > 0 ? (float)stats->buffered / stats->capacity : 0.0f,
+					 .throughput = elapsed > 0 ? (float)(transferred / elapsed) : 0.0f,
+					 .stalls = stats->stalls - previous.stalls}
+				);
+
+				previous = *stats;
+			}
+
+			std::lock_guard metrics_lock(metrics_mutex);
+			snapshot.sequence = metrics.sequence + 1;
+			metrics = std::move(snapshot);
+			metrics_sequence = metrics.sequence;
+		}
+	}
+
+	std::optional<std::any> Runner::get_error() const
+	{
+		for (const auto& [_, resource] : processor_resources)
+			if (resource->state == State::Error) return resource->exception;
+
+		return std::nullopt;
+	}
+
+	Runner::Metrics Runner::get_metrics() const
+	{
+		std::lock_guard lock(metrics_mutex);
+		return metrics;
+	}
+
+	Graph Runner::fuse_processors(const Graph& graph)
+	{
+		Graph result = graph;
+
+		// 每次融合一对处理器，直到没有可以融合的连结为止
+		bool fused = true;
+		while (fused)
+		{
+			fused = false;
+
+			for (const auto& [link_id, link] : result.links)
+			{
+				const Id_t from_id = result.pins.at(link.from).parent;
+				const Id_t to_id = result.pins.at(link.to).parent;
+
+				const auto link_view = result.links | std::views::values;
+				const auto from_parent = [&result](const Graph::Link& other)
+				{ return result.pins.at(other.from).parent; };
+				const auto to_parent = [&result](const Graph::Link& other)
+				{ return result.pins.at(other.to).parent; };
+
+				// 上游只有这一条输出连结，下游只有这一条输入连结
+				if (std::ranges::count(link_view, from_id, from_parent) != 1) continue;
+				if (std::ranges::count(link_view, to_id, to_parent) != 1) continue;
+
+				auto& from_node = result.nodes.at(from_id);
+				const auto& to_node = result.nodes.at(to_id);
+
+				// 下游的输出引脚需要在上游找到同名引脚
+				const bool pins_match = std::ranges::all_of(
+					to_node.pins,
+					[&](Id_t pin_id)
+					{
+						const auto& attribute = result.pins.at(pin_id).attribute;
+						return attribute.is_input || from_node.pin_name_map.contains(attribute.identifier);
+					}
+				);
+				if (!pins_match) continue;
+
+				auto fused_processor = from_node.processor->fuse(*to_node.processor);
+				if (fused_processor == nullptr) continue;
+
+				// 下游发出的连结改为从上游的同名引脚发出
+				std::map<Id_t, Graph::Link> new_links;
+				for (const auto& [id, other] : result.links)
+				{
+					if (id == link_id) continue;
+
+					const auto& from_pin = result.pins.at(other.from);
+					if (from_pin.parent == to_id)
+					{
+						const Id_t new_from = from_node.pin_name_map.at(from_pin.attribute.identifier);
+						new_links.emplace(id, Graph::Link{.from = new_from, .to = other.to});
+					}
+					else
+						new_links.emplace(id, other);
+				}
+
+				for (const auto pin_id : to_node.pins) result.pins.erase(pin_id);
+				result.links = std::move(new_links);
+				from_node.processor = std::move(fused_processor);
+				result.nodes.erase(to_id);
+
+				fused = true;
+				break;
+			}
+		}
+
+		return result;
+	}
+
 	std::unique_ptr<Runner> Runner::create_and_run(
 		const Graph& graph,
-		std::map<Id_t, std::shared_ptr<std::any>> node_data
+		std::map<Id_t, std::shared_ptr<std::any>> node_data,
+		bool fuse
 	)
 	{
 		auto runner = std::make_unique<Runner>();
 		runner->node_data = std::move(node_data);
 
-		runner->generate_processor_resources(graph);
+		// 先检查原图，避免融合时遇到环
+		graph.check_graph();
+		runner->generate_processor_resources(fuse ? fuse_processors(graph) : graph);
 		std::thread(&Runner::launch_threads, runner.get()).detach();
+		runner->metrics_thread = std::jthread(
+			[ptr = runner.get()](std::stop_token stop_token) { ptr->publish_metrics(std::move(stop_token)); }
+		);
 
 		return runner;
 	}
@@ -1,4 +1,6 @@
 #include "processor/audio-amix.hpp"
+#include "processor/audio-kernel.hpp"
+#include "processor/frame-rechunker.hpp"
 #include "config.hpp"
 #include "imgui.h"
 #include "infra/processor.hpp"
@@ -24,9 +26,9 @@ namespace processor
 
 	Audio_amix::Audio_amix() = default;
 
-	infra::Processor::Info Audio_amix::get_processor_info()
+	const infra::Processor::Info& Audio_amix::get_processor_info()
 	{
-		return infra::Processor::Info{
+		static const infra::Processor::Info info{
 			.identifier = "audio_amix",
 			.display_name = "Audio Amix",
 			.singleton = false,
@@ -35,9 +37,10 @@ namespace processor
 						   "## Functionality\n"
 						   "- Mix multiple audio input streams into a single stereo output\n"
 						   "- Support 1-16 configurable input channels with real-time adjustment\n"
-						   "- Volume lock mechanism to prevent accidental changes to critical channels\n\n"
+						   "- Volume lock mechanism to prevent accidental changes to critical channels\n"
+						   "- Inputs are resampled and mixed block by block in lockstep\n\n"
 						   "## Output Format\n"
-						   "- Sample Rate: 48kHz\n"
+						   "- Sample Rate: project sample rate\n"
 						   "- Format: 32-bit Float Planar\n"
 						   "- Channels: Stereo (Left/Right)\n\n"
 						   "## Usage\n"
@@ -46,6 +49,8 @@ namespace processor
 						   "- Adjust volume levels for each channel using sliders\n"
 						   "- Use 'Locked' checkbox to prevent accidental volume changes"
 		};
+
+		return info;
 	}
 
 	std::vector<infra::Processor::Pin_attribute> Audio_amix::get_pin_attributes() const
@@ -87,33 +92,15 @@ namespace processor
 		const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
 		const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
 		const std::atomic<bool>& stop_token,
-		std::any& user_data
+		std::any& user_data [[maybe_unused]]
 	)
 	{
-
-		std::unique_ptr<bool> initial;
 		const auto input_num = this->input_num;
-		int ret;
-		int count = 0;
-		double time_seconds = 0;
-		std::vector<bool> eofs;
-		eofs.resize(input_num);
-		std::ranges::fill(eofs, false);
-
-		std::vector<std::vector<std::shared_ptr<const Audio_frame>>> buffers;
-		buffers.resize(input_num);
+		const int block_size = runtime_config::block_size;
 
 		std::vector<std::reference_wrapper<Audio_stream>> input_items;
 		input_items.reserve(input_num);
 
-		std::vector<SwrContext*> resamplers;
-		resamplers.resize(input_num);
-		std::ranges::fill(resamplers, nullptr);
-
-		std::vector<Free_utility> resamplers_free;
-		resamplers_free.reserve(input_num);
-		for (auto& i : resamplers) resamplers_free.emplace_back(std::bind(swr_free, &i));
-
 		for (int i = 0; i < input_num; i++)
 		{
 			const auto try_item = get_input_item<Audio_stream>(input, std::format("input_{}", i + 1));
@@ -146,178 +133,82 @@ namespace processor
 			}
 		};
 
+		// 每路输入先转换为平面float双声道，再重新分块，各路逐块同步混合
+		const Audio_resampler::Format mix_format{
+			.format = AV_SAMPLE_FMT_FLTP,
+			.sample_rate = runtime_config::sample_rate,
+			.channel_layout = AV_CHANNEL_LAYOUT_STEREO
+		};
+
+		const auto quality = get_resample_quality();
+
+		std::vector<std::unique_ptr<Frame_rechunker>> rechunkers;
+		rechunkers.reserve(input_num);
+		for (int i = 0; i < input_num; i++)
+			rechunkers.push_back(std::make_unique<Frame_rechunker>(block_size, mix_format, quality));
+
+		std::vector<std::shared_ptr<Audio_frame>> blocks;
+		std::vector<uint8_t**> block_datas;
+		std::vector<float> block_volumes;
+		int64_t sample_index = 0;
+
 		while (!stop_token)
 		{
+			// 等待每一路都凑满一块或者结束
+			bool waiting = false;
 			for (int i = 0; i < input_num; i++)
+				if (!rechunkers[i]->fill_from(input_items[i].get())) waiting = true;
+
+			if (waiting)
 			{
-				auto pop_result = input_items[i].get().try_pop();
-				if (!pop_result.has_value())
-				{
-					if (pop_result.error() == boost::fibers::channel_op_status::empty)
-					{
-						if (input_items[i].get().eof()) eofs[i] = true;
-					}
-					else if (pop_result.error() == boost::fibers::channel_op_status::closed)
-						THROW_LOGIC_ERROR("Unexpected channel closed in Audio_output::process_payload");
-				}
-				else
-				{
-					buffers[i].push_back(pop_result.value());
-				}
+				boost::this_fiber::yield();
+				continue;
 			}
 
-			bool check = false;
+			// 只有流结束时的最后一块会不足，以最长的一路为准，其余补静音
+			int sample_count = 0;
+			for (const auto& rechunker : rechunkers)
+				if (rechunker->ready())
+					sample_count = std::max(sample_count, std::min(rechunker->available(), block_size));
 
-			count = 0;
+			// 所有输入都已结束
+			if (sample_count == 0) break;
+
+			blocks.clear();
+			block_datas.clear();
+			block_volumes.clear();
 
 			for (int i = 0; i < input_num; i++)
 			{
-				if (buffers[i].empty() && !eofs[i])
-				{
-					boost::this_fiber::yield();
-					check = true;
-					break;
-				}
-			}
-			if (check) continue;
+				if (!rechunkers[i]->ready()) continue;
 
-			const auto front_view
-				= buffers
-				| std::views::transform([](const auto& buffer)
-										{ return buffer.empty() ? nullptr : buffer.front()->data(); });
-			const std::vector<const AVFrame*> frames(front_view.begin(), front_view.end());
+				blocks.push_back(rechunkers[i]->pop(sample_count));
+				block_datas.push_back(blocks.back()->data()->extended_data);
+				block_volumes.push_back(volumes[i]);
+			}
 
 			std::shared_ptr<Audio_frame> new_frame = std::make_shared<Audio_frame>();
 			AVFrame* out_frame = new_frame->data();
-			out_frame->nb_samples = std::numeric_limits<int>::max();
-			for (auto& i : frames)
-				if (i) out_frame->nb_samples = std::min(out_frame->nb_samples, i->nb_samples);
-			if (out_frame->nb_samples == std::numeric_limits<int>::max()) out_frame->nb_samples = 1152;
+			out_frame->nb_samples = sample_count;
 			out_frame->ch_layout = AV_CHANNEL_LAYOUT_STEREO;
-			out_frame->sample_rate = config::processor::audio_amix::std_sample_rate;
+			out_frame->sample_rate = mix_format.sample_rate;
 			out_frame->format = AV_SAMPLE_FMT_FLTP;
-			time_seconds += out_frame->nb_samples / double(out_frame->sample_rate);
-			out_frame->pts = time_seconds * 1000000;
-			out_frame->time_base = {.num = 1, .den = 1000000};
+			out_frame->pts = sample_index;
+			out_frame->time_base = {.num = 1, .den = mix_format.sample_rate};
 
-			av_frame_get_buffer(out_frame, 32);
-			av_frame_make_writable(out_frame);
+			if (av_frame_get_buffer(out_frame, 0) < 0) throw std::bad_alloc();
 
-			if (!initial)
-			{
-				const AVChannelLayout dst_layout = AV_CHANNEL_LAYOUT_STEREO;
-
-				for (int i = 0; i < input_num; i++)
-				{
-					resamplers[i] = swr_alloc();
-					const AVChannelLayout input_layout_r = frames[i]->ch_layout.nb_channels == 2
-															 ? AVChannelLayout(AV_CHANNEL_LAYOUT_STEREO)
-															 : AVChannelLayout(AV_CHANNEL_LAYOUT_MONO);
-
-					av_opt_set_chlayout(resamplers[i], "in_chlayout", &input_layout_r, 0);
-					av_opt_set_int(resamplers[i], "in_sample_rate", frames[i]->sample_rate, 0);
-					av_opt_set_sample_fmt(
-						resamplers[i],
-						"in_sample_fmt",
-						(AVSampleFormat)frames[i]->format,
-						0
-					);
-					av_opt_set_chlayout(resamplers[i], "out_chlayout", &dst_layout, 0);
-					av_opt_set_int(
-						resamplers[i],
-						"out_sample_rate",
-						config::processor::audio_amix::std_sample_rate,
-						0
-					);
-					av_opt_set_sample_fmt(resamplers[i], "out_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
-
-					if (swr_init(resamplers[i]) < 0)
-						throw Runtime_error(
-							"Failed to initialize software resampler",
-							"Cannot start the audio resampling process. Internal error may have "
-							"occurred.",
-							"swr_init() returned error"
-						);
-				}
-				initial = std::make_unique<bool>();
-			}
-			std::vector<uint8_t**> datas;
-			std::vector<int> linesizes;
-			datas.resize(input_num);
-			linesizes.resize(input_num);
-			std::ranges::fill(datas, nullptr);
-			std::ranges::fill(linesizes, 0);
-
-			for (int i = 0; i < input_num; i++)
-			{
-				av_samples_alloc_array_and_samples(
-					&datas[i],
-					&linesizes[i],
-					2,
-					out_frame->nb_samples,
-					static_cast<AVSampleFormat>(out_frame->format),
-					0
-				);
-				if (frames[i])
-				{
-					const auto convert_count = swr_convert(
-						resamplers[i],
-						datas[i],
-						out_frame->nb_samples,
-						(const uint8_t**)frames[i]->data,
-						frames[i]->nb_samples
-					);
-
-					if (convert_count < 0)
-						throw Runtime_error(
-							"Software resampler failed",
-							"Cannot convert audio sample rate or format. Internal error may have "
-							"occurred.",
-							std::format("swr_convert() returned error {} at input channel {}", ret, i)
-						);
-				}
-				else if (!frames[i])
-				{
-					const auto convert_count
-						= swr_convert(resamplers[i], datas[i], out_frame->nb_samples, 0, 0);
-
-					if (convert_count < 0)
-						throw Runtime_error(
-							"Software resampler failed",
-							"Cannot convert audio sample rate or format. Internal error may have occurred.",
-							std::format("swr_convert() returned error {} at input channel {}", ret, i)
-						);
-					if (convert_count < out_frame->nb_samples) count++;
-				}
-			}
-			auto* out_left = (float*)out_frame->data[0];
-			auto* out_right = (float*)out_frame->data[1];
-
-			for (int j = 0; j < out_frame->nb_samples; j++)
-			{
-				float temp_l = 0.0f;
-				float temp_r = 0.0f;
-				for (int i = 0; i < input_num; i++)
-				{
-					temp_l += ((const float*)datas[i][0])[j] * volumes[i];
-					temp_r += ((const float*)datas[i][1])[j] * volumes[i];
-				}
-				out_left[j] = temp_l;
-				out_right[j] = temp_r;
-			}
+			mix_stereo_planar(
+				(float*)out_frame->data[0],
+				(float*)out_frame->data[1],
+				block_datas,
+				block_volumes,
+				sample_count
+			);
 
-			for (auto& i : buffers)
-				if (!i.empty()) i.erase(i.begin());
+			sample_index += sample_count;
 
 			push_frame(new_frame);
-
-			for (auto& i : datas)
-			{
-				if (i) av_freep(&i[0]);
-				av_freep(i);
-			}
-
-			if (count == input_num) break;
 		}
 
 		for (auto& output : output_item) output->set_eof();
@@ -421,4 +312,13 @@ namespace processor
 			locks.push_back(value[std::format("locks{}", i)].asBool());
 		}
 	}
+
+	std::unique_ptr<infra::Processor> Audio_amix::clone() const
+	{
+		auto processor = std::make_unique<Audio_amix>();
+		processor->input_num = input_num;
+		processor->volumes = volumes;
+		processor->locks = locks;
+		return processor;
+	}
 }
@@ -2,6 +2,7 @@
 #include "config.hpp"
 #include "libavutil/channel_layout.h"
 #include "libavutil/samplefmt.h"
+#include "processor/frame-rechunker.hpp"
 #include "utility/free-utility.hpp"
 #include "utility/imgui-utility.hpp"
 #include "utility/sw-resample.hpp"
@@ -21,9 +22,9 @@
 namespace processor
 {
 
-	infra::Processor::Info Audio_bimix::get_processor_info()
+	const infra::Processor::Info& Audio_bimix::get_processor_info()
 	{
-		return infra::Processor::Info{
+		static const infra::Processor::Info info{
 			.identifier = "audio_bimix",
 			.display_name = "Audio Bimix",
 			.singleton = false,
@@ -36,7 +37,7 @@ namespace processor
 						   "- Time-accurate channel synchronization\n"
 						   "- Bias control for channel balance adjustment\n\n"
 						   "## Output Format\n"
-						   "- Sample Rate: 48kHz (configurable)\n"
+						   "- Sample Rate: project sample rate\n"
 						   "- Format: 32-bit Float Interleaved\n"
 						   "- Channels: Stereo (Left/Right)\n\n"
 						   "## Usage\n"
@@ -45,6 +46,8 @@ namespace processor
 						   "- Supports different sample rates and formats on inputs\n"
 						   "- Automatically handles timing misalignment between channels\n\n"
 		};
+
+		return info;
 	}
 
 	std::vector<infra::Processor::Pin_attribute> Audio_bimix::get_pin_attributes() const
@@ -84,24 +87,9 @@ namespace processor
 		const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
 		const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
 		const std::atomic<bool>& stop_token,
-		std::any& user_data
+		std::any& user_data [[maybe_unused]]
 	)
 	{
-		std::vector<std::shared_ptr<const Audio_frame>> buf_l, buf_r;
-		std::unique_ptr<bool> initial;
-
-		// 初始化软件重采样器
-		SwrContext* resampler_l = nullptr;
-		SwrContext* resampler_r = nullptr;
-
-		bool left_eof = false;
-		bool right_eof = false;
-
-		Free_utility resampler_l_free{std::bind(swr_free, &resampler_l)};
-		Free_utility resampler_r_free{std::bind(swr_free, &resampler_r)};
-
-		double time_seconds;
-
 		const auto input_item_optional_l = get_input_item<Audio_stream>(input, "input_l");
 		const auto input_item_optional_r = get_input_item<Audio_stream>(input, "input_r");
 		const auto output_item = get_output_item<Audio_stream>(output, "output");
@@ -132,177 +120,54 @@ namespace processor
 			}
 		};
 
-		int input_num = 2;
+		// 左右输入先转换为平面float双声道，再重新分块，逐块同步混合
+		const int target_sample_rate = runtime_config::sample_rate;
+		const Audio_resampler::Format mix_format{
+			.format = AV_SAMPLE_FMT_FLTP,
+			.sample_rate = target_sample_rate,
+			.channel_layout = AV_CHANNEL_LAYOUT_STEREO
+		};
+		const auto quality = get_resample_quality();
+
+		const int block_size = runtime_config::block_size;
+		Frame_rechunker rechunker_l(block_size, mix_format, quality);
+		Frame_rechunker rechunker_r(block_size, mix_format, quality);
+		int64_t sample_index = 0;
 
 		while (!stop_token)
 		{
-			// 获取数据
-
-			const auto pop_result_l = input_item_l.try_pop();
-			if (!pop_result_l.has_value())
-			{
-				if (pop_result_l.error() == boost::fibers::channel_op_status::empty)
-					if (input_item_l.eof()) left_eof = true;
-				if (pop_result_l.error() == boost::fibers::channel_op_status::closed)
-					THROW_LOGIC_ERROR("Unexpected channel closed in Audio_output::process_payload");
-			}
-			else
-				buf_l.push_back(pop_result_l.value());
-
-			const auto pop_result_r = input_item_r.try_pop();
-			if (!pop_result_r.has_value())
-			{
-				if (pop_result_r.error() == boost::fibers::channel_op_status::empty)
-					if (input_item_r.eof()) right_eof = true;
-				if (pop_result_r.error() == boost::fibers::channel_op_status::closed)
-					THROW_LOGIC_ERROR("Unexpected channel closed in Audio_output::process_payload");
-			}
-			else
-				buf_r.push_back(pop_result_r.value());
+			const bool filled_l = rechunker_l.fill_from(input_item_l);
+			const bool filled_r = rechunker_r.fill_from(input_item_r);
 
-			if ((buf_r.empty() && !right_eof) || (buf_l.empty() && !left_eof))
+			if (!filled_l || !filled_r)
 			{
 				boost::this_fiber::yield();
 				continue;
 			}
 
-			// 获取帧参数
-			std::shared_ptr<Audio_frame> new_frame = std::make_shared<Audio_frame>();
+			// 只有流结束时的最后一块会不足，以较长的一路为准，另一路补静音
+			int sample_count = 0;
+			if (rechunker_l.ready()) sample_count = std::min(rechunker_l.available(), block_size);
+			if (rechunker_r.ready())
+				sample_count = std::max(sample_count, std::min(rechunker_r.available(), block_size));
 
-			const auto& frame_l = buf_l.empty() ? nullptr : buf_l.front()->data();
-			const auto& frame_r = buf_r.empty() ? nullptr : buf_r.front()->data();
+			// 两路输入都已结束
+			if (sample_count == 0) break;
 
+			// 已经结束的一路没有数据块，视为静音
+			const auto block_l = rechunker_l.pop(sample_count);
+			const auto block_r = rechunker_r.pop(sample_count);
+
+			std::shared_ptr<Audio_frame> new_frame = std::make_shared<Audio_frame>();
 			AVFrame* out_frame = new_frame->data();
-			if (frame_r && frame_l)
-				out_frame->nb_samples = std::min(frame_r->nb_samples, frame_l->nb_samples);
-			if (!frame_r && frame_l)
-				out_frame->nb_samples = frame_l->nb_samples;
-			else if (frame_r && !frame_l)
-				out_frame->nb_samples = frame_r->nb_samples;
-			else
-				out_frame->nb_samples = 1152;
+			out_frame->nb_samples = sample_count;
 			out_frame->ch_layout = AV_CHANNEL_LAYOUT_STEREO;
-			out_frame->sample_rate = 48000;
+			out_frame->sample_rate = target_sample_rate;
 			out_frame->format = AV_SAMPLE_FMT_FLTP;
+			out_frame->pts = sample_index;
+			out_frame->time_base = {.num = 1, .den = target_sample_rate};
 
-			time_seconds += out_frame->nb_samples / double(out_frame->sample_rate);
-
-			out_frame->pts = time_seconds * 1000000;
-			out_frame->time_base = {.num = 1, .den = 1000000};
-
-			av_frame_get_buffer(out_frame, 32);
-			av_frame_make_writable(out_frame);
-
-			if (!initial)
-			{
-				resampler_l = swr_alloc();
-				resampler_r = swr_alloc();
-
-				const AVChannelLayout dst_layout = AV_CHANNEL_LAYOUT_STEREO;
-
-				const AVChannelLayout input_layout_r = frame_r->ch_layout.nb_channels == 2
-														 ? AVChannelLayout(AV_CHANNEL_LAYOUT_STEREO)
-														 : AVChannelLayout(AV_CHANNEL_LAYOUT_MONO);
-				const AVChannelLayout input_layout_l = frame_l->ch_layout.nb_channels == 2
-														 ? AVChannelLayout(AV_CHANNEL_LAYOUT_STEREO)
-														 : AVChannelLayout(AV_CHANNEL_LAYOUT_MONO);
-
-				av_opt_set_chlayout(resampler_r, "in_chlayout", &input_layout_r, 0);
-				av_opt_set_int(resampler_r, "in_sample_rate", frame_r->sample_rate, 0);
-				av_opt_set_sample_fmt(resampler_r, "in_sample_fmt", (AVSampleFormat)frame_r->format, 0);
-
-				av_opt_set_chlayout(resampler_r, "out_chlayout", &dst_layout, 0);
-				av_opt_set_int(resampler_r, "out_sample_rate", 48000, 0);
-				av_opt_set_sample_fmt(resampler_r, "out_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
-
-				av_opt_set_chlayout(resampler_l, "in_chlayout", &input_layout_l, 0);
-				av_opt_set_int(resampler_l, "in_sample_rate", frame_l->sample_rate, 0);
-				av_opt_set_sample_fmt(resampler_l, "in_sample_fmt", (AVSampleFormat)frame_l->format, 0);
-
-				av_opt_set_chlayout(resampler_l, "out_chlayout", &dst_layout, 0);
-				av_opt_set_int(resampler_l, "out_sample_rate", 48000, 0);
-				av_opt_set_sample_fmt(resampler_l, "out_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
-
-				if (swr_init(resampler_r) < 0)
-					throw Runtime_error(
-						"Failed to initialize software resampler",
-						"Cannot start the audio resampling process. Internal error may have "
-						"occurred.",
-						"swr_init() returned error"
-					);
-
-				if (swr_init(resampler_l) < 0)
-					throw Runtime_error(
-						"Failed to initialize software resampler",
-						"Cannot start the audio resampling process. Internal error may have "
-						"occurred.",
-						"swr_init() returned error"
-					);
-
-				initial = std::make_unique<bool>();
-			}
-
-			uint8_t** data1 = nullptr;
-			uint8_t** data2 = nullptr;
-
-			int linesize_l;
-			av_samples_alloc_array_and_samples(
-				&data1,
-				&linesize_l,
-				2,
-				out_frame->nb_samples,
-				static_cast<AVSampleFormat>(out_frame->format),
-				0
-			);
-			int convert_count_l = 0;
-			if (frame_l)
-				convert_count_l = swr_convert(
-					resampler_l,
-					data1,
-					out_frame->nb_samples,
-					(const uint8_t**)frame_l->data,
-					frame_l->nb_samples
-				);
-			else
-				convert_count_l = swr_convert(resampler_l, data1, out_frame->nb_samples, 0, 0);
-			if (convert_count_l < 0)
-				throw Runtime_error(
-					"Software resampler failed",
-					"Cannot convert audio sample rate or format. Internal error may have occurred.",
-					"swr_convert() returned error"
-				);
-
-			int linesize_r;
-			av_samples_alloc_array_and_samples(
-				&data2,
-				&linesize_r,
-				2,
-				out_frame->nb_samples,
-				static_cast<AVSampleFormat>(out_frame->format),
-				0
-			);
-			int convert_count_r = 0;
-			if (frame_r)
-				convert_count_r = swr_convert(
-					resampler_r,
-					data2,
-					out_frame->nb_samples,
-					(const uint8_t**)frame_r->data,
-					frame_r->nb_samples
-				);
-			else
-				convert_count_l = swr_convert(resampler_r, data2, out_frame->nb_samples, 0, 0);
-			if (convert_count_r < 0)
-				throw Runtime_error(
-					"Software resampler failed",
-					"Cannot convert audio sample rate or format. Internal error may have occurred.",
-					"swr_convert() returned error"
-				);
-
-			const auto* float_data_ll = (const float*)data1[0];
-			const auto* float_data_lr = (const float*)data1[1];
-			const auto* float_data_rl = (const float*)data2[0];
-			const auto* float_data_rr = (const float*)data2[1];
+			if (av_frame_get_buffer(out_frame, 0) < 0) throw std::bad_alloc();
 
 			auto* out_left = (float*)out_frame->data[0];
 			auto* out_right = (float*)out_frame->data[1];
@@ -310,21 +175,31 @@ namespace processor
 			const float bias_minus = (1 - bias);
 			const float bias_plus = (1 + bias);
 
-			for (size_t i = 0; i < out_frame->nb_samples; i++)
+			if (block_l != nullptr)
 			{
-				out_left[i] = (float_data_ll[i] / 2 + float_data_lr[i] / 2) * bias_minus;
-				out_right[i] = (float_data_rl[i] / 2 + float_data_rr[i] / 2) * bias_plus;
+				const auto* float_data_ll = (const float*)block_l->data()->data[0];
+				const auto* float_data_lr = (const float*)block_l->data()->data[1];
+
+				for (int i = 0; i < sample_count; i++)
+					out_left[i] = (float_data_ll[i] / 2 + float_data_lr[i] / 2) * bias_minus;
 			}
+			else
+				std::fill_n(out_left, sample_count, 0.0f);
 
-			if (frame_l) buf_l.erase(buf_l.begin());
-			if (frame_r) buf_r.erase(buf_r.begin());
+			if (block_r != nullptr)
+			{
+				const auto* float_data_rl = (const float*)block_r->data()->data[0];
+				const auto* float_data_rr = (const float*)block_r->data()->data[1];
 
-			push_frame(new_frame);
+				for (int i = 0; i < sample_count; i++)
+					out_right[i] = (float_data_rl[i] / 2 + float_data_rr[i] / 2) * bias_plus;
+			}
+			else
+				std::fill_n(out_right, sample_count, 0.0f);
 
-			if (data1) av_freep(&data1[0]);
-			if (data2) av_freep(&data2[0]);
+			sample_index += sample_count;
 
-			if (convert_count_r == 0 && convert_count_l == 0) break;
+			push_frame(new_frame);
 		}
 
 		for (auto& output : output_item) output->set_eof();
@@ -382,9 +257,17 @@ namespace processor
 		bias = std::clamp<float>(bias, -1, 1);
 	}
 
-	infra::Processor::Info Audio_bimix_v2::get_processor_info()
+	std::unique_ptr<infra::Processor> Audio_bimix::clone() const
 	{
-		return infra::Processor::Info{
+		auto processor = std::make_unique<Audio_bimix>();
+		processor->bias = bias;
+		processor->buf_max_num = buf_max_num;
+		return processor;
+	}
+
+	const infra::Processor::Info& Audio_bimix_v2::get_processor_info()
+	{
+		static const infra::Processor::Info info{
 			.identifier = "audio_bimix_v2",
 			.display_name = "Audio Bimix V2",
 			.singleton = false,
@@ -397,7 +280,7 @@ namespace processor
 						   "- Time-accurate channel synchronization\n"
 						   "- Bias control for channel balance adjustment\n\n"
 						   "## Output Format\n"
-						   "- Sample Rate: 48kHz (configurable)\n"
+						   "- Sample Rate: project sample rate\n"
 						   "- Format: 32-bit Float Interleaved\n"
 						   "- Channels: Stereo (Left/Right)\n\n"
 						   "## Usage\n"
@@ -406,6 +289,8 @@ namespace processor
 						   "- Supports different sample rates and formats on inputs\n"
 						   "- Automatically handles timing misalignment between channels\n\n"
 		};
+
+		return info;
 	}
 
 	std::vector<infra::Processor::Pin_attribute> Audio_bimix_v2::get_pin_attributes() const
@@ -450,6 +335,7 @@ namespace processor
 
 	static std::shared_ptr<Audio_frame> make_audio_frame_flt_interleaved(
 		std::span<float> samples,
+		int sample_rate,
 		double time_seconds
 	)
 	{
@@ -458,7 +344,7 @@ namespace processor
 
 		data->nb_samples = samples.size() / 2;
 		data->ch_layout = AV_CHANNEL_LAYOUT_STEREO;
-		data->sample_rate = config::processor::audio_bimix::std_sample_rate;
+		data->sample_rate = sample_rate;
 		data->format = AV_SAMPLE_FMT_FLT;
 
 		data->pts = time_seconds * 1000000;
@@ -493,7 +379,7 @@ namespace processor
 		auto& input_stream_r = input_item_optional_r.value().get();
 		auto output_stream = get_output_item<Audio_stream>(output, "output");
 
-		auto push_frame = [&stop_token, &output_stream](const std::shared_ptr<Audio_frame>& frame)
+		auto push_block = [&stop_token, &output_stream](const std::shared_ptr<Audio_frame>& frame)
 		{
 			for (auto& channel : output_stream)
 			{
@@ -507,21 +393,32 @@ namespace processor
 			}
 		};
 
-		constexpr auto target_sample_rate = config::processor::audio_bimix::std_sample_rate;
+		// 对齐后生成的帧长度不定，重新分块后再输出
+		Frame_rechunker output_rechunker(runtime_config::block_size);
+
+		auto push_frame = [&output_rechunker, &push_block](const std::shared_ptr<Audio_frame>& frame)
+		{
+			output_rechunker.push(*frame->data());
+			while (output_rechunker.ready()) push_block(output_rechunker.pop());
+		};
+
+		const int target_sample_rate = runtime_config::sample_rate;
+		const auto quality = get_resample_quality();
 
 		// 单帧，只记录单声道
 		struct Frame
 		{
 			std::vector<float> samples;
+			int sample_rate = 0;
 			double time_seconds = 0.0;
 
-			double elapsed_seconds() const { return double(samples.size()) / target_sample_rate; }
+			double elapsed_seconds() const { return double(samples.size()) / sample_rate; }
 			double end_time() const { return time_seconds + elapsed_seconds(); }
 			void drop_samples(size_t count)
 			{
 				assert(count <= samples.size());
 				samples.erase(samples.begin(), samples.begin() + count);
-				time_seconds += double(count) / target_sample_rate;
+				time_seconds += double(count) / sample_rate;
 			}
 		};
 
@@ -578,7 +475,7 @@ namespace processor
 							.channel_layout = AV_CHANNEL_LAYOUT_STEREO,
 						};
 
-						auto create_result = Audio_resampler::create(input_format, output_format);
+						auto create_result = Audio_resampler::create(input_format, output_format, quality);
 						if (!create_result.has_value())
 							throw Runtime_error(
 								"Failed to create audio resampler",
@@ -591,8 +488,10 @@ namespace processor
 
 					/* 重采样并放到缓冲区 */
 
-					shared_buffer[0].resize(data.nb_samples * 2);
-					shared_buffer[1].resize(data.nb_samples * 2);
+					// 工程采样率可能远高于输入，按重采样器给出的上限分配
+					const int capacity = resampler_l->calc_samples(data.nb_samples);
+					shared_buffer[0].resize(capacity);
+					shared_buffer[1].resize(capacity);
 
 					float* shared_buffer_ptr[2] = {shared_buffer[0].data(), shared_buffer[1].data()};
 
@@ -600,7 +499,7 @@ namespace processor
 						std::span((const float* const*)data.data, data.ch_layout.nb_channels),
 						data.nb_samples,
 						std::span<float*>(shared_buffer_ptr, 2),
-						shared_buffer[0].size()
+						capacity
 					);
 
 					if (resampled_count < 0)
@@ -618,6 +517,7 @@ namespace processor
 					time_l += double(resampled_count) / target_sample_rate;
 
 					Frame new_frame;
+					new_frame.sample_rate = target_sample_rate;
 					new_frame.time_seconds = time_l;
 					new_frame.samples.resize(resampled_count);
 
@@ -671,7 +571,7 @@ namespace processor
 							.channel_layout = AV_CHANNEL_LAYOUT_STEREO,
 						};
 
-						auto create_result = Audio_resampler::create(input_format, output_format);
+						auto create_result = Audio_resampler::create(input_format, output_format, quality);
 						if (!create_result.has_value())
 							throw Runtime_error(
 								"Failed to create audio resampler",
@@ -684,8 +584,10 @@ namespace processor
 
 					/* 重采样并放到缓冲区 */
 
-					shared_buffer[0].resize(data.nb_samples * 2);
-					shared_buffer[1].resize(data.nb_samples * 2);
+					// 工程采样率可能远高于输入，按重采样器给出的上限分配
+					const int capacity = resampler_r->calc_samples(data.nb_samples);
+					shared_buffer[0].resize(capacity);
+					shared_buffer[1].resize(capacity);
 
 					float* const shared_buffer_ptr[2] = {shared_buffer[0].data(), shared_buffer[1].data()};
 
@@ -693,7 +595,7 @@ namespace processor
 						std::span((const float* const*)data.data, data.ch_layout.nb_channels),
 						data.nb_samples,
 						std::span<float* const>(shared_buffer_ptr, 2),
-						data.nb_samples * 2
+						capacity
 					);
 
 					if (resampled_count < 0)
@@ -711,6 +613,7 @@ namespace processor
 					time_r += double(resampled_count) / target_sample_rate;
 
 					Frame new_frame;
+					new_frame.sample_rate = target_sample_rate;
 					new_frame.time_seconds = time_r;
 					new_frame.samples.resize(resampled_count);
 
@@ -743,6 +646,7 @@ namespace processor
 
 					push_frame(make_audio_frame_flt_interleaved(
 						std::span(remaining_samples_buffer),
+						target_sample_rate,
 						frames_l.front().time_seconds
 					));
 
@@ -766,6 +670,7 @@ namespace processor
 
 					push_frame(make_audio_frame_flt_interleaved(
 						std::span(remaining_samples_buffer),
+						target_sample_rate,
 						frames_r.front().time_seconds
 					));
 
@@ -803,7 +708,11 @@ namespace processor
 						}
 
 						push_frame(
-							make_audio_frame_flt_interleaved(std::span(frame_samples), eariler_begin_time)
+							make_audio_frame_flt_interleaved(
+								std::span(frame_samples),
+								target_sample_rate,
+								eariler_begin_time
+							)
 						);
 
 						eariler_stream.pop_front();
@@ -867,12 +776,21 @@ namespace processor
 					if (!later_stream.empty() && later_stream.front().samples.empty())
 						later_stream.pop_front();
 
-					push_frame(make_audio_frame_flt_interleaved(std::span(frame_samples), eariler_begin_time)
-					);
+					push_frame(make_audio_frame_flt_interleaved(
+						std::span(frame_samples),
+						target_sample_rate,
+						eariler_begin_time
+					));
 				}
 			}
 		}
 
+		if (!stop_token)
+		{
+			output_rechunker.finish();
+			while (output_rechunker.ready()) push_block(output_rechunker.pop());
+		}
+
 		for (auto& stream : output_stream) stream->set_eof();
 	}
 
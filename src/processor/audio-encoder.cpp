@@ -0,0 +1,1087 @@
+#include "processor/audio-encoder.hpp"
+#include "config.hpp"
+#include "infra/processor.hpp"
+#include "utility/logic-error-utility.hpp"
+#include "utility/mp3-segment-encoder.hpp"
+#include "utility/sw-resample.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <span>
+#include <thread>
+
+#include <lame/lame.h>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/mathematics.h>
+#include <libavutil/samplefmt.h>
+}
+
+namespace processor
+{
+	std::string_view get_export_format_name(Export_format format)
+	{
+		switch (format)
+		{
+		case Export_format::Mp3:
+			return "MP3";
+		case Export_format::Wav:
+			return "WAV";
+		case Export_format::Flac:
+			return "FLAC";
+		case Export_format::Opus:
+			return "Opus";
+		}
+
+		return "Unknown";
+	}
+
+	std::string_view get_export_format_pattern(Export_format format)
+	{
+		switch (format)
+		{
+		case Export_format::Mp3:
+			return "*.mp3";
+		case Export_format::Wav:
+			return "*.wav";
+		case Export_format::Flac:
+			return "*.flac";
+		case Export_format::Opus:
+			return "*.opus";
+		}
+
+		return "*";
+	}
+
+	bool export_format_has_bitrate(Export_format format)
+	{
+		return format == Export_format::Mp3 || format == Export_format::Opus;
+	}
+
+	// =============================================================================
+	/* MP3 */
+
+	// MP3的输出采样率
+	// - 输入的采样率受MP3支持时直接沿用，避免导出时再重采样一次；否则使用默认采样率
+	static int get_mp3_sample_rate(int input_rate)
+	{
+		constexpr int supported[] = {8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100, 48000};
+		if (std::ranges::contains(supported, input_rate)) return input_rate;
+		return config::audio::default_sample_rate;
+	}
+
+	// LAME编码器的封装
+	// - 编码输出缓冲区与静音缓冲区均被复用，避免每帧分配内存
+	class Lame_encoder final : public Audio_encoder
+	{
+		lame_t lame;
+		size_t kbps;
+		int channels = 0;
+		bool initialized = false;
+
+		std::vector<std::byte> output_buffer;  // 编码输出缓冲区
+		std::vector<short> silence_buffer;     // 静音采样缓冲区（交错双声道）
+
+		// 确保输出缓冲区足够容纳sample_count个采样的编码结果
+		unsigned char* reserve_output(int sample_count)
+		{
+			const size_t buffer_size = 5 * size_t(sample_count) / 4 + 7200;  // LAME 的缓冲区大小
+			if (output_buffer.size() < buffer_size) output_buffer.resize(buffer_size);
+			return reinterpret_cast<unsigned char*>(output_buffer.data());
+		}
+
+		void write_output(int written, Double_buffered_writer& writer, const char* action)
+		{
+			if (written < 0)
+				throw infra::Processor::Runtime_error(
+					std::format("Failed to encode {}", action),
+					std::format("Cannot encode {}. Internal error may have occurred.", action),
+					std::format("LAME Error: {}", written)
+				);
+
+			if (written == 0) return;
+			writer.write(std::span(output_buffer.data(), size_t(written)));
+		}
+
+	  public:
+
+		Lame_encoder(size_t kbps) :
+			lame(lame_init()),
+			kbps(kbps)
+		{
+			if (lame == nullptr) throw std::bad_alloc();
+		}
+
+		~Lame_encoder() override { lame_close(lame); }
+
+		bool is_initialized() const override { return initialized; }
+
+		void initialize(const AVFrame& frame, Double_buffered_writer& writer [[maybe_unused]]) override
+		{
+			channels = frame.ch_layout.nb_channels;
+
+			if (channels != 1 && channels != 2)
+				throw infra::Processor::Runtime_error(
+					"Invalid channel count",
+					"Only mono and stereo audio are supported.",
+					std::format("Got {} channels", channels)
+				);
+
+			lame_set_in_samplerate(lame, frame.sample_rate);
+			lame_set_num_channels(lame, channels);
+			lame_set_quality(lame, 2);
+			lame_set_mode(lame, channels == 2 ? MPEG_mode::STEREO : MPEG_mode::MONO);
+			lame_set_out_samplerate(lame, get_mp3_sample_rate(frame.sample_rate));
+			lame_set_VBR(lame, vbr_off);
+			lame_set_brate(lame, kbps);
+
+			if (lame_init_params(lame) == -1)
+				throw infra::Processor::Runtime_error(
+					"Failed to initialize LAME parameters",
+					"Cannot set LAME parameters for encoding. Internal error may have occurred."
+				);
+
+			initialized = true;
+		}
+
+		// 按固定大小分块提交静音，静音缓冲区只分配一次
+		void encode_silence(int64_t sample_count, Double_buffered_writer& writer) override
+		{
+			constexpr int chunk_samples = config::processor::audio_output::silence_chunk_samples;
+			if (silence_buffer.empty()) silence_buffer.resize(chunk_samples * 2, 0);
+
+			while (sample_count > 0)
+			{
+				const int count = static_cast<int>(std::min<int64_t>(sample_count, chunk_samples));
+				unsigned char* const buffer = reserve_output(count);
+
+				const int written
+					= channels == 2
+						? lame_encode_buffer_interleaved(
+							  lame,
+							  silence_buffer.data(),
+							  count,
+							  buffer,
+							  static_cast<int>(output_buffer.size())
+						  )
+						: lame_encode_buffer(
+							  lame,
+							  silence_buffer.data(),
+							  silence_buffer.data(),
+							  count,
+							  buffer,
+							  static_cast<int>(output_buffer.size())
+						  );
+
+				write_output(written, writer, "silence");
+				sample_count -= count;
+			}
+		}
+
+		// 交错格式的接口只接受双声道，单声道统一使用非交错接口，左右声道传入同一指针
+		void encode_frame(const AVFrame& frame, Double_buffered_writer& writer) override
+		{
+			unsigned char* const buffer = reserve_output(frame.nb_samples);
+			const int buffer_size = static_cast<int>(output_buffer.size());
+			const int right_plane = channels == 2 ? 1 : 0;
+			const bool stereo = channels == 2;
+
+			int written;
+
+			switch ((AVSampleFormat)frame.format)
+			{
+			case AV_SAMPLE_FMT_S16:
+			{
+				const auto data = reinterpret_cast<short*>(frame.data[0]);
+				written = stereo ? lame_encode_buffer_interleaved(lame, data, frame.nb_samples, buffer, buffer_size)
+								 : lame_encode_buffer(lame, data, data, frame.nb_samples, buffer, buffer_size);
+				break;
+			}
+			case AV_SAMPLE_FMT_S16P:
+			{
+				written = lame_encode_buffer(
+					lame,
+					reinterpret_cast<short*>(frame.data[0]),
+					reinterpret_cast<short*>(frame.data[right_plane]),
+					frame.nb_samples,
+					buffer,
+					buffer_size
+				);
+				break;
+			}
+			case AV_SAMPLE_FMT_S32:
+			{
+				const auto data = reinterpret_cast<int*>(frame.data[0]);
+				written = stereo
+							? lame_encode_buffer_interleaved_int(lame, data, frame.nb_samples, buffer, buffer_size)
+							: lame_encode_buffer_int(lame, data, data, frame.nb_samples, buffer, buffer_size);
+				break;
+			}
+			case AV_SAMPLE_FMT_S32P:
+			{
+				written = lame_encode_buffer_int(
+					lame,
+					reinterpret_cast<int*>(frame.data[0]),
+					reinterpret_cast<int*>(frame.data[right_plane]),
+					frame.nb_samples,
+					buffer,
+					buffer_size
+				);
+				break;
+			}
+			case AV_SAMPLE_FMT_FLT:
+			{
+				const auto data = reinterpret_cast<const float*>(frame.data[0]);
+				written = stereo ? lame_encode_buffer_interleaved_ieee_float(
+									   lame,
+									   data,
+									   frame.nb_samples,
+									   buffer,
+									   buffer_size
+								   )
+								 : lame_encode_buffer_ieee_float(lame, data, data, frame.nb_samples, buffer, buffer_size);
+				break;
+			}
+			case AV_SAMPLE_FMT_FLTP:
+			{
+				written = lame_encode_buffer_ieee_float(
+					lame,
+					reinterpret_cast<const float*>(frame.data[0]),
+					reinterpret_cast<const float*>(frame.data[right_plane]),
+					frame.nb_samples,
+					buffer,
+					buffer_size
+				);
+				break;
+			}
+			default:
+				throw infra::Processor::Runtime_error(
+					"Unsupported sample format",
+					"The audio sample format is not supported for encoding.",
+					std::format("Sample format: {}", frame.format)
+				);
+			}
+
+			write_output(written, writer, "audio frame");
+		}
+
+		void flush(Double_buffered_writer& writer) override
+		{
+			if (!initialized) return;
+
+			unsigned char* const buffer = reserve_output(0);
+			const int written = lame_encode_flush(lame, buffer, static_cast<int>(output_buffer.size()));
+			write_output(written, writer, "remaining audio");
+		}
+	};
+
+	// 分段并行MP3编码器的封装
+	// - 先将输入统一重采样为输出采样率的交错float，再交给Segmented_mp3_encoder，
+	//   保证各分段的编码器不需要内部重采样，分段可以按帧对齐
+	class Segmented_lame_encoder final : public Audio_encoder
+	{
+		size_t kbps;
+		int input_sample_rate = 0;
+		int output_sample_rate = 0;
+		int channels = 0;
+
+		std::unique_ptr<Audio_resampler> resampler;
+		std::optional<Segmented_mp3_encoder> encoder;
+		std::vector<float> resample_buffer;
+		std::vector<std::byte> info_frame;
+
+		// 重采样并提交给编码器，input为空时冲刷重采样器
+		void resample_and_append(const AVFrame* input, Double_buffered_writer& writer)
+		{
+			const int input_samples = input == nullptr ? 0 : input->nb_samples;
+			const int output_capacity = resampler->calc_samples(input_samples);
+			if (output_capacity <= 0) return;
+
+			resample_buffer.resize(size_t(output_capacity) * channels);
+			const auto output_ptr_array = std::to_array({resample_buffer.data()});
+
+			const auto convert_count = resampler->resample<uint8_t, float>(
+				input == nullptr
+					? std::span<const uint8_t* const>()
+					: std::span<const uint8_t* const>{input->data, input->data + input->ch_layout.nb_channels},
+				input_samples,
+				std::span(output_ptr_array),
+				output_capacity
+			);
+
+			if (convert_count < 0)
+				throw infra::Processor::Runtime_error(
+					"Software resampler failed",
+					"Cannot convert audio sample rate or format. Internal error may have occurred.",
+					"swr_convert() returned error"
+				);
+
+			encoder->append(std::span(resample_buffer.data(), size_t(convert_count) * channels), writer);
+		}
+
+	  public:
+
+		Segmented_lame_encoder(size_t kbps) :
+			kbps(kbps)
+		{
+		}
+
+		bool is_initialized() const override { return encoder.has_value(); }
+
+		void initialize(const AVFrame& frame, Double_buffered_writer& writer [[maybe_unused]]) override
+		{
+			input_sample_rate = frame.sample_rate;
+			output_sample_rate = get_mp3_sample_rate(frame.sample_rate);
+			channels = frame.ch_layout.nb_channels;
+
+			if (channels != 1 && channels != 2)
+				throw infra::Processor::Runtime_error(
+					"Invalid channel count",
+					"Only mono and stereo audio are supported.",
+					std::format("Got {} channels", channels)
+				);
+
+			const AVChannelLayout layout
+				= channels == 2 ? AVChannelLayout(AV_CHANNEL_LAYOUT_STEREO) : AVChannelLayout(AV_CHANNEL_LAYOUT_MONO);
+
+			const Audio_resampler::Format input_format{
+				.format = (AVSampleFormat)frame.format,
+				.sample_rate = frame.sample_rate,
+				.channel_layout = layout
+			};
+
+			const Audio_resampler::Format output_format{
+				.format = AV_SAMPLE_FMT_FLT,
+				.sample_rate = output_sample_rate,
+				.channel_layout = layout
+			};
+
+			auto resampler_create
+				= Audio_resampler::create(input_format, output_format, Audio_resampler::Quality::Export);
+			if (!resampler_create.has_value())
+				throw infra::Processor::Runtime_error(
+					"Failed to create audio resampler",
+					"Cannot create audio resampler for the input audio format. Internal error may have occurred.",
+					std::format(
+						"Input format: {}, sample rate: {}, channels: {}",
+						frame.format,
+						frame.sample_rate,
+						channels
+					)
+				);
+
+			resampler = std::move(resampler_create.value());
+
+			try
+			{
+				encoder.emplace(Segmented_mp3_encoder::Params{
+					.sample_rate = output_sample_rate,
+					.channels = channels,
+					.kbps = kbps,
+					.thread_count = std::max(std::thread::hardware_concurrency(), 1u)
+				});
+			}
+			catch (const std::runtime_error& e)
+			{
+				throw infra::Processor::Runtime_error(
+					"Failed to initialize LAME parameters",
+					"Cannot set LAME parameters for encoding. Internal error may have occurred.",
+					e.what()
+				);
+			}
+		}
+
+		void encode_silence(int64_t sample_count, Double_buffered_writer& writer) override
+		{
+			if (sample_count <= 0) return;
+			encoder->append_silence(av_rescale(sample_count, output_sample_rate, input_sample_rate), writer);
+		}
+
+		void encode_frame(const AVFrame& frame, Double_buffered_writer& writer) override
+		{
+			resample_and_append(&frame, writer);
+		}
+
+		// 冲刷重采样器，等待所有分段编码完成
+		void flush(Double_buffered_writer& writer) override
+		{
+			if (!encoder.has_value()) return;
+
+			resample_and_append(nullptr, writer);
+			info_frame = encoder->finish(writer);
+		}
+
+		// 文件开头预留了Info帧的位置，所有数据写入后再回填
+		std::optional<Header_patch> get_header_patch() const override
+		{
+			if (info_frame.empty()) return std::nullopt;
+			return Header_patch{.offset = 0, .data = info_frame};
+		}
+	};
+
+	// =============================================================================
+	/* WAV */
+
+	// 无压缩WAV写入器
+	// - 采样按第一帧的格式原样写入（平面格式转为交错），不做任何转换
+	// - 文件头预留ds64块的空间（JUNK），数据超过4GB时回填为RF64
+	// - 超过2个声道或每个采样超过16位时使用WAVE_FORMAT_EXTENSIBLE，写入声道掩码与有效位数
+	class Wav_encoder final : public Audio_encoder
+	{
+		static constexpr size_t fmt_offset = 48;  // RIFF(12) + JUNK/ds64(36)
+
+		AVSampleFormat format = AV_SAMPLE_FMT_NONE;  // 输入帧的格式
+		int channels = 0;
+		int sample_rate = 0;
+		size_t bytes_per_sample = 0;
+		uint32_t channel_mask = 0;  // 声道布局不是标准布局时为0（未指定）
+		bool extensible = false;
+		bool initialized = false;
+
+		uint64_t data_bytes = 0;
+		std::vector<std::byte> interleave_buffer;
+		std::vector<std::byte> silence_buffer;
+
+		template <typename T>
+		static void write_le(std::byte* dst, T value)
+		{
+			std::memcpy(dst, &value, sizeof(T));
+		}
+
+		// fmt块的内容长度，WAVEFORMATEXTENSIBLE为40字节
+		size_t get_fmt_size() const { return extensible ? 40 : 16; }
+
+		// 文件头长度（到data块的内容为止），初始化后不再变化，回填时长度相同
+		size_t get_header_size() const { return fmt_offset + 8 + get_fmt_size() + 8; }
+
+		std::vector<std::byte> build_header() const
+		{
+			const size_t header_size = get_header_size();
+			std::vector<std::byte> header(header_size, std::byte(0));
+			std::byte* const ptr = header.data();
+
+			const uint64_t riff_size = header_size - 8 + data_bytes + (data_bytes & 1);
+			const bool rf64 = riff_size > 0xFFFFFFFF;
+
+			const auto packed_format = av_get_packed_sample_fmt(format);
+			const bool is_float = packed_format == AV_SAMPLE_FMT_FLT || packed_format == AV_SAMPLE_FMT_DBL;
+			const auto block_align = uint16_t(bytes_per_sample * channels);
+
+			std::memcpy(ptr, rf64 ? "RF64" : "RIFF", 4);
+			write_le<uint32_t>(ptr + 4, rf64 ? 0xFFFFFFFF : uint32_t(riff_size));
+			std::memcpy(ptr + 8, "WAVE", 4);
+
+			// ds64: riff_size(8) data_size(8) sample_count(8) table_length(4)
+			std::memcpy(ptr + 12, rf64 ? "ds64" : "JUNK", 4);
+			write_le<uint32_t>(ptr + 16, 28);
+			if (rf64)
+			{
+				write_le<uint64_t>(ptr + 20, riff_size);
+				write_le<uint64_t>(ptr + 28, data_bytes);
+				write_le<uint64_t>(ptr + 36, data_bytes / block_align);
+			}
+
+			const uint16_t format_tag = is_float ? 0x0003 : 0x0001;
+			const auto bits_per_sample = uint16_t(bytes_per_sample * 8);
+			std::byte* const fmt = ptr + fmt_offset + 8;
+
+			std::memcpy(ptr + fmt_offset, "fmt ", 4);
+			write_le<uint32_t>(ptr + fmt_offset + 4, uint32_t(get_fmt_size()));
+			write_le<uint16_t>(fmt, extensible ? 0xFFFE : format_tag);
+			write_le<uint16_t>(fmt + 2, uint16_t(channels));
+			write_le<uint32_t>(fmt + 4, uint32_t(sample_rate));
+			write_le<uint32_t>(fmt + 8, uint32_t(sample_rate) * block_align);
+			write_le<uint16_t>(fmt + 12, block_align);
+			write_le<uint16_t>(fmt + 14, bits_per_sample);
+
+			if (extensible)
+			{
+				// cbSize(2) valid_bits(2) channel_mask(4) SubFormat(16)
+				// SubFormat为KSDATAFORMAT_SUBTYPE_PCM/IEEE_FLOAT，前两个字节为格式标签
+				constexpr uint8_t subformat_tail[14]
+					= {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+
+				write_le<uint16_t>(fmt + 16, 22);
+				write_le<uint16_t>(fmt + 18, bits_per_sample);
+				write_le<uint32_t>(fmt + 20, channel_mask);
+				write_le<uint16_t>(fmt + 24, format_tag);
+				std::memcpy(fmt + 26, subformat_tail, sizeof(subformat_tail));
+			}
+
+			std::byte* const data = fmt + get_fmt_size();
+			std::memcpy(data, "data", 4);
+			write_le<uint32_t>(data + 4, rf64 ? 0xFFFFFFFF : uint32_t(data_bytes));
+
+			return header;
+		}
+
+	  public:
+
+		bool is_initialized() const override { return initialized; }
+
+		void initialize(const AVFrame& frame, Double_buffered_writer& writer) override
+		{
+			format = (AVSampleFormat)frame.format;
+			channels = frame.ch_layout.nb_channels;
+			sample_rate = frame.sample_rate;
+
+			switch (av_get_packed_sample_fmt(format))
+			{
+			case AV_SAMPLE_FMT_U8:
+			case AV_SAMPLE_FMT_S16:
+			case AV_SAMPLE_FMT_S32:
+			case AV_SAMPLE_FMT_FLT:
+			case AV_SAMPLE_FMT_DBL:
+				break;
+			default:
+				throw infra::Processor::Runtime_error(
+					"Unsupported sample format",
+					"The audio sample format is not supported for encoding.",
+					std::format("Sample format: {}", frame.format)
+				);
+			}
+
+			bytes_per_sample = av_get_bytes_per_sample(format);
+
+			// 只有不超过32个声道的标准布局可以写入声道掩码，其余情况留空由播放器决定
+			if (frame.ch_layout.order == AV_CHANNEL_ORDER_NATIVE && frame.ch_layout.u.mask <= 0xFFFFFFFF)
+				channel_mask = uint32_t(frame.ch_layout.u.mask);
+			extensible = channels > 2 || bytes_per_sample > 2;
+
+			initialized = true;
+
+			// 先写入占位的文件头，结束时回填
+			writer.write(build_header());
+		}
+
+		void encode_silence(int64_t sample_count, Double_buffered_writer& writer) override
+		{
+			constexpr int chunk_samples = config::processor::audio_output::silence_chunk_samples;
+			const size_t frame_bytes = bytes_per_sample * channels;
+
+			// 8位PCM为无符号数，静音为0x80
+			if (silence_buffer.empty())
+				silence_buffer.assign(
+					chunk_samples * frame_bytes,
+					av_get_packed_sample_fmt(format) == AV_SAMPLE_FMT_U8 ? std::byte(0x80) : std::byte(0)
+				);
+
+			while (sample_count > 0)
+			{
+				const auto count = std::min<int64_t>(sample_count, chunk_samples);
+				writer.write(std::span(silence_buffer.data(), size_t(count) * frame_bytes));
+				data_bytes += size_t(count) * frame_bytes;
+				sample_count -= count;
+			}
+		}
+
+		void encode_frame(const AVFrame& frame, Double_buffered_writer& writer) override
+		{
+			if ((AVSampleFormat)frame.format != format || frame.ch_layout.nb_channels != channels)
+				throw infra::Processor::Runtime_error(
+					"Audio format changed",
+					"Audio stream format is inconsistent. Internal error may have occurred.",
+					std::format(
+						"Expected format {} with {} channels, got format {} with {} channels",
+						(int)format,
+						channels,
+						frame.format,
+						frame.ch_layout.nb_channels
+					)
+				);
+
+			const size_t frame_bytes = bytes_per_sample * channels * frame.nb_samples;
+
+			if (!av_sample_fmt_is_planar(format))
+			{
+				writer.write(std::span(reinterpret_cast<const std::byte*>(frame.data[0]), frame_bytes));
+			}
+			else
+			{
+				// 平面格式转为交错
+				interleave_buffer.resize(frame_bytes);
+				std::byte* dst = interleave_buffer.data();
+
+				for (int i = 0; i < frame.nb_samples; i++)
+					for (int channel = 0; channel < channels; channel++)
+					{
+						std::memcpy(dst, frame.extended_data[channel] + i * bytes_per_sample, bytes_per_sample);
+						dst += bytes_per_sample;
+					}
+
+				writer.write(interleave_buffer);
+			}
+
+			data_bytes += frame_bytes;
+		}
+
+		void flush(Double_buffered_writer& writer) override
+		{
+			// 块按2字节对齐
+			if (data_bytes & 1) writer.write(std::to_array({std::byte(0)}));
+		}
+
+		std::optional<Header_patch> get_header_patch() const override
+		{
+			if (!initialized) return std::nullopt;
+			return Header_patch{.offset = 0, .data = build_header()};
+		}
+	};
+
+	// =============================================================================
+	/* libavcodec */
+
+	// 基于libavcodec/libavformat的编码器
+	// - 输入经重采样转换为编码器支持的格式，通过AVAudioFifo切分为编码器要求的帧长度
+	// - 封装器通过自定义的AVIOContext写入Double_buffered_writer，输出不可回溯（seek），
+	//   需要回填的文件头（如FLAC的STREAMINFO）在结束后由get_header_patch()给出
+	class Avcodec_encoder final : public Audio_encoder
+	{
+		static constexpr int io_buffer_size = 64 * 1024;
+		static constexpr int fallback_frame_size = 4096;  // 编码器不限制帧长度时使用的帧长度
+
+		AVCodecID codec_id;
+		const char* muxer_name;
+		size_t kbps;
+
+		AVCodecContext* codec_context = nullptr;
+		AVFormatContext* format_context = nullptr;
+		AVIOContext* io_context = nullptr;
+		AVStream* stream = nullptr;
+		AVAudioFifo* fifo = nullptr;
+		AVFrame* encode_buffer = nullptr;   // 送入编码器的帧
+		AVFrame* convert_buffer = nullptr;  // 重采样输出
+		AVPacket* packet = nullptr;
+
+		std::unique_ptr<Audio_resampler> resampler;
+		Double_buffered_writer* writer = nullptr;
+
+		int input_sample_rate = 0;
+		int frame_size = 0;
+		int64_t next_pts = 0;
+		std::vector<std::byte> streaminfo;  // FLAC编码结束时更新的STREAMINFO
+
+#if FF_API_AVIO_WRITE_NONCONST
+		static int write_packet(void* opaque, uint8_t* buffer, int size)
+#else
+		static int write_packet(void* opaque, const uint8_t* buffer, int size)
+#endif
+		{
+			auto* const self = static_cast<Avcodec_encoder*>(opaque);
+			self->writer->write(std::span(reinterpret_cast<const std::byte*>(buffer), size_t(size)));
+			return size;
+		}
+
+		static void check(int result, const char* action)
+		{
+			if (result >= 0) return;
+
+			char error_string[AV_ERROR_MAX_STRING_SIZE];
+			av_strerror(result, error_string, sizeof(error_string));
+
+			throw infra::Processor::Runtime_error(
+				std::format("Failed to {}", action),
+				std::format("Cannot {}. Internal error may have occurred.", action),
+				std::format("FFmpeg Error: {}", error_string)
+			);
+		}
+
+		// 选择编码器支持的采样格式，优先使用精度更高的格式
+		AVSampleFormat select_sample_format(const AVCodec* codec) const
+		{
+			const void* configs = nullptr;
+			int config_count = 0;
+			check(
+				avcodec_get_supported_config(
+					codec_context,
+					codec,
+					AV_CODEC_CONFIG_SAMPLE_FORMAT,
+					0,
+					&configs,
+					&config_count
+				),
+				"query supported sample formats"
+			);
+
+			if (configs == nullptr) return AV_SAMPLE_FMT_FLTP;
+			const std::span supported(static_cast<const AVSampleFormat*>(configs), config_count);
+
+			for (const auto preferred : {AV_SAMPLE_FMT_FLTP,
+										 AV_SAMPLE_FMT_FLT,
+										 AV_SAMPLE_FMT_S32,
+										 AV_SAMPLE_FMT_S32P,
+										 AV_SAMPLE_FMT_S16,
+										 AV_SAMPLE_FMT_S16P})
+				if (std::ranges::contains(supported, preferred)) return preferred;
+
+			return supported.front();
+		}
+
+		// 选择编码器支持的采样率，优先使用输入的采样率
+		int select_sample_rate(const AVCodec* codec, int input_rate) const
+		{
+			const void* configs = nullptr;
+			int config_count = 0;
+			check(
+				avcodec_get_supported_config(
+					codec_context,
+					codec,
+					AV_CODEC_CONFIG_SAMPLE_RATE,
+					0,
+					&configs,
+					&config_count
+				),
+				"query supported sample rates"
+			);
+
+			if (configs == nullptr) return input_rate;
+			const std::span supported(static_cast<const int*>(configs), config_count);
+
+			if (std::ranges::contains(supported, input_rate)) return input_rate;
+			if (std::ranges::contains(supported, config::audio::default_sample_rate))
+				return config::audio::default_sample_rate;
+			return supported.front();
+		}
+
+		// 确保重采样输出缓冲区至少能容纳sample_count个采样
+		void reserve_convert_buffer(int sample_count)
+		{
+			if (convert_buffer->nb_samples >= sample_count && convert_buffer->data[0] != nullptr) return;
+
+			av_frame_unref(convert_buffer);
+			convert_buffer->format = codec_context->sample_fmt;
+			convert_buffer->sample_rate = codec_context->sample_rate;
+			convert_buffer->nb_samples = sample_count;
+			check(av_channel_layout_copy(&convert_buffer->ch_layout, &codec_context->ch_layout), "copy channel layout");
+			check(av_frame_get_buffer(convert_buffer, 0), "allocate audio buffer");
+		}
+
+		// 将编码器输出的数据包写入封装器
+		void receive_packets()
+		{
+			while (true)
+			{
+				const int result = avcodec_receive_packet(codec_context, packet);
+				if (result == AVERROR(EAGAIN) || result == AVERROR_EOF) return;
+				check(result, "receive encoded packet");
+
+				// FLAC编码器在最后一个数据包中给出更新后的STREAMINFO（总采样数与MD5）
+				size_t side_data_size = 0;
+				const uint8_t* const side_data
+					= av_packet_get_side_data(packet, AV_PKT_DATA_NEW_EXTRADATA, &side_data_size);
+				if (side_data != nullptr)
+					streaminfo.assign(
+						reinterpret_cast<const std::byte*>(side_data),
+						reinterpret_cast<const std::byte*>(side_data) + side_data_size
+					);
+
+				av_packet_rescale_ts(packet, codec_context->time_base, stream->time_base);
+				packet->stream_index = stream->index;
+
+				check(av_write_frame(format_context, packet), "write encoded packet");
+				av_packet_unref(packet);
+			}
+		}
+
+		// 从FIFO中取出完整的帧送入编码器，final为true时同时送出不足一帧的剩余采样
+		void send_fifo_frames(bool final)
+		{
+			while (av_audio_fifo_size(fifo) >= frame_size || (final && av_audio_fifo_size(fifo) > 0))
+			{
+				const int count = std::min(av_audio_fifo_size(fifo), frame_size);
+
+				encode_buffer->nb_samples = frame_size;
+				check(av_frame_make_writable(encode_buffer), "allocate audio buffer");
+
+				check(av_audio_fifo_read(fifo, reinterpret_cast<void**>(encode_buffer->data), count), "read audio FIFO");
+
+				// 编码器不接受较短的最后一帧时，补齐静音
+				if (count < frame_size
+					&& !(codec_context->codec->capabilities
+						 & (AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_VARIABLE_FRAME_SIZE)))
+					av_samples_set_silence(
+						encode_buffer->data,
+						count,
+						frame_size - count,
+						codec_context->ch_layout.nb_channels,
+						codec_context->sample_fmt
+					);
+				else
+					encode_buffer->nb_samples = count;
+
+				encode_buffer->pts = next_pts;
+				next_pts += encode_buffer->nb_samples;
+
+				check(avcodec_send_frame(codec_context, encode_buffer), "encode audio frame");
+				receive_packets();
+			}
+		}
+
+		// 将重采样输出缓冲区中的count个采样写入FIFO
+		void push_converted(int count)
+		{
+			if (count <= 0) return;
+			check(
+				av_audio_fifo_write(fifo, reinterpret_cast<void**>(convert_buffer->data), count),
+				"write audio FIFO"
+			);
+			send_fifo_frames(false);
+		}
+
+	  public:
+
+		Avcodec_encoder(AVCodecID codec_id, const char* muxer_name, size_t kbps) :
+			codec_id(codec_id),
+			muxer_name(muxer_name),
+			kbps(kbps)
+		{
+		}
+
+		~Avcodec_encoder() override
+		{
+			if (fifo != nullptr) av_audio_fifo_free(fifo);
+			if (encode_buffer != nullptr) av_frame_free(&encode_buffer);
+			if (convert_buffer != nullptr) av_frame_free(&convert_buffer);
+			if (packet != nullptr) av_packet_free(&packet);
+			if (codec_context != nullptr) avcodec_free_context(&codec_context);
+
+			if (io_context != nullptr)
+			{
+				av_freep(&io_context->buffer);
+				avio_context_free(&io_context);
+			}
+
+			if (format_context != nullptr) avformat_free_context(format_context);
+		}
+
+		bool is_initialized() const override { return format_context != nullptr; }
+
+		void initialize(const AVFrame& frame, Double_buffered_writer& writer) override
+		{
+			this->writer = &writer;
+			input_sample_rate = frame.sample_rate;
+
+			const AVCodec* const codec = avcodec_find_encoder(codec_id);
+			if (codec == nullptr)
+				throw infra::Processor::Runtime_error(
+					"Encoder not available",
+					"The encoder for the selected format is not available in this build of FFmpeg.",
+					std::format("Codec: {}", avcodec_get_name(codec_id))
+				);
+
+			/* 编码器 */
+
+			codec_context = avcodec_alloc_context3(codec);
+			if (codec_context == nullptr) throw std::bad_alloc();
+
+			AVChannelLayout layout;
+			av_channel_layout_default(&layout, frame.ch_layout.nb_channels);
+			check(av_channel_layout_copy(&codec_context->ch_layout, &layout), "copy channel layout");
+
+			codec_context->sample_fmt = select_sample_format(codec);
+			codec_context->sample_rate = select_sample_rate(codec, frame.sample_rate);
+			codec_context->time_base = {1, codec_context->sample_rate};
+			codec_context->bit_rate = int64_t(kbps) * 1000;
+			codec_context->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+
+			// 无损格式从浮点输入编码时保留24位精度
+			if (codec_context->sample_fmt == AV_SAMPLE_FMT_S32 || codec_context->sample_fmt == AV_SAMPLE_FMT_S32P)
+				codec_context->bits_per_raw_sample = 24;
+
+			// 由libavcodec选择线程数，编码器支持帧级/片级多线程时启用
+			codec_context->thread_count = 0;
+			codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
+			/* 封装器 */
+
+			check(
+				avformat_alloc_output_context2(&format_context, nullptr, muxer_name, nullptr),
+				"create output container"
+			);
+
+			if (format_context->oformat->flags & AVFMT_GLOBALHEADER)
+				codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+			check(avcodec_open2(codec_context, codec, nullptr), "open audio encoder");
+
+			stream = avformat_new_stream(format_context, nullptr);
+			if (stream == nullptr) throw std::bad_alloc();
+			check(avcodec_parameters_from_context(stream->codecpar, codec_context), "copy codec parameters");
+			stream->time_base = codec_context->time_base;
+
+			auto* const io_buffer = static_cast<unsigned char*>(av_malloc(io_buffer_size));
+			if (io_buffer == nullptr) throw std::bad_alloc();
+
+			io_context = avio_alloc_context(io_buffer, io_buffer_size, 1, this, nullptr, write_packet, nullptr);
+			if (io_context == nullptr)
+			{
+				av_free(io_buffer);
+				throw std::bad_alloc();
+			}
+
+			format_context->pb = io_context;
+			format_context->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+			check(avformat_write_header(format_context, nullptr), "write container header");
+
+			/* 缓冲区 */
+
+			frame_size = codec_context->frame_size > 0 ? codec_context->frame_size : fallback_frame_size;
+
+			fifo = av_audio_fifo_alloc(codec_context->sample_fmt, codec_context->ch_layout.nb_channels, frame_size);
+			encode_buffer = av_frame_alloc();
+			convert_buffer = av_frame_alloc();
+			packet = av_packet_alloc();
+			if (fifo == nullptr || encode_buffer == nullptr || convert_buffer == nullptr || packet == nullptr)
+				throw std::bad_alloc();
+
+			encode_buffer->format = codec_context->sample_fmt;
+			encode_buffer->sample_rate = codec_context->sample_rate;
+			encode_buffer->nb_samples = frame_size;
+			check(av_channel_layout_copy(&encode_buffer->ch_layout, &codec_context->ch_layout), "copy channel layout");
+			check(av_frame_get_buffer(encode_buffer, 0), "allocate audio buffer");
+
+			/* 重采样器 */
+
+			const Audio_resampler::Format input_format{
+				.format = (AVSampleFormat)frame.format,
+				.sample_rate = frame.sample_rate,
+				.channel_layout = layout
+			};
+
+			const Audio_resampler::Format output_format{
+				.format = codec_context->sample_fmt,
+				.sample_rate = codec_context->sample_rate,
+				.channel_layout = layout
+			};
+
+			auto resampler_create
+				= Audio_resampler::create(input_format, output_format, Audio_resampler::Quality::Export);
+			if (!resampler_create.has_value())
+				throw infra::Processor::Runtime_error(
+					"Failed to create audio resampler",
+					"Cannot create audio resampler for the input audio format. Internal error may have occurred.",
+					std::format(
+						"Input format: {}, sample rate: {}, channels: {}",
+						frame.format,
+						frame.sample_rate,
+						frame.ch_layout.nb_channels
+					)
+				);
+
+			resampler = std::move(resampler_create.value());
+		}
+
+		void encode_silence(int64_t sample_count, Double_buffered_writer& writer [[maybe_unused]]) override
+		{
+			constexpr int chunk_samples = config::processor::audio_output::silence_chunk_samples;
+
+			int64_t remaining = av_rescale(sample_count, codec_context->sample_rate, input_sample_rate);
+			if (remaining <= 0) return;
+
+			reserve_convert_buffer(chunk_samples);
+			av_samples_set_silence(
+				convert_buffer->data,
+				0,
+				chunk_samples,
+				codec_context->ch_layout.nb_channels,
+				codec_context->sample_fmt
+			);
+
+			while (remaining > 0)
+			{
+				const auto count = static_cast<int>(std::min<int64_t>(remaining, chunk_samples));
+				push_converted(count);
+				remaining -= count;
+			}
+		}
+
+		void encode_frame(const AVFrame& frame, Double_buffered_writer& writer [[maybe_unused]]) override
+		{
+			const int capacity = resampler->calc_samples(frame.nb_samples);
+			reserve_convert_buffer(capacity);
+
+			const int input_planes = av_sample_fmt_is_planar((AVSampleFormat)frame.format) ? frame.ch_layout.nb_channels : 1;
+			const int output_planes
+				= av_sample_fmt_is_planar(codec_context->sample_fmt) ? codec_context->ch_layout.nb_channels : 1;
+
+			const int count = resampler->resample<uint8_t, uint8_t>(
+				std::span<const uint8_t* const>(frame.extended_data, input_planes),
+				frame.nb_samples,
+				std::span<uint8_t* const>(convert_buffer->extended_data, output_planes),
+				capacity
+			);
+			check(count, "resample audio");
+
+			push_converted(count);
+		}
+
+		void flush(Double_buffered_writer& writer [[maybe_unused]]) override
+		{
+			if (!is_initialized()) return;
+
+			// 冲刷重采样器
+			const int capacity = resampler->calc_samples(0);
+			if (capacity > 0)
+			{
+				reserve_convert_buffer(capacity);
+
+				const int output_planes
+					= av_sample_fmt_is_planar(codec_context->sample_fmt) ? codec_context->ch_layout.nb_channels : 1;
+
+				const int count = resampler->resample<uint8_t, uint8_t>(
+					std::span<const uint8_t* const>(),
+					0,
+					std::span<uint8_t* const>(convert_buffer->extended_data, output_planes),
+					capacity
+				);
+				check(count, "resample audio");
+				push_converted(count);
+			}
+
+			// 冲刷编码器
+			send_fifo_frames(true);
+			check(avcodec_send_frame(codec_context, nullptr), "flush audio encoder");
+			receive_packets();
+
+			check(av_write_trailer(format_context), "write container trailer");
+			avio_flush(io_context);
+		}
+
+		// FLAC的STREAMINFO位于"fLaC"与元数据块头之后
+		std::optional<Header_patch> get_header_patch() const override
+		{
+			constexpr size_t flac_streaminfo_offset = 8;
+			constexpr size_t flac_streaminfo_size = 34;
+
+			if (codec_id != AV_CODEC_ID_FLAC || streaminfo.size() != flac_streaminfo_size) return std::nullopt;
+			return Header_patch{.offset = flac_streaminfo_offset, .data = streaminfo};
+		}
+	};
+
+	// =============================================================================
+
+	std::unique_ptr<Audio_encoder> create_audio_encoder(Export_format format, size_t kbps, bool parallel_encode)
+	{
+		switch (format)
+		{
+		case Export_format::Mp3:
+			if (parallel_encode) return std::make_unique<Segmented_lame_encoder>(kbps);
+			return std::make_unique<Lame_encoder>(kbps);
+		case Export_format::Wav:
+			return std::make_unique<Wav_encoder>();
+		case Export_format::Flac:
+			return std::make_unique<Avcodec_encoder>(AV_CODEC_ID_FLAC, "flac", kbps);
+		case Export_format::Opus:
+			return std::make_unique<Avcodec_encoder>(AV_CODEC_ID_OPUS, "ogg", kbps);
+		}
+
+		THROW_LOGIC_ERROR("Unknown export format {}", (int)format);
+	}
+}
@@ -1,20 +1,27 @@
 #include "processor/audio-io.hpp"
 #include "config.hpp"
 #include "frontend/nerdfont.hpp"
+#include "processor/frame-rechunker.hpp"
 #include "utility/dialog-utility.hpp"
+#include "utility/file-writer.hpp"
 #include "utility/free-utility.hpp"
 #include "utility/imgui-utility.hpp"
 #include "utility/sw-resample.hpp"
+#include "utility/wav-reader.hpp"
 
 #include <SDL_events.h>
 #include <algorithm>
+#include <bit>
+#include <boost/fiber/buffered_channel.hpp>
+#include <boost/fiber/future.hpp>
 #include <boost/fiber/operations.hpp>
 #include <cassert>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <print>
-
-#include <lame/lame.h>
+#include <thread>
 
 extern "C"
 {
@@ -24,9 +31,9 @@ extern "C"
 
 namespace processor
 {
-	infra::Processor::Info Audio_input::get_processor_info()
+	const infra::Processor::Info& Audio_input::get_processor_info()
 	{
-		return infra::Processor::Info{
+		static const infra::Processor::Info info{
 			.identifier = "audio_input",
 			.display_name = "Audio Input",
 			.singleton = true,
@@ -35,12 +42,157 @@ namespace processor
 						   "## Functionality\n"
 						   "- Reads audio files and outputs audio streams\n"
 						   "- Supports multiple file inputs with configurable paths\n"
-						   "- Outputs audio in 48kHz, 32-bit float format\n\n"
+						   "- Uncompressed WAV (including RF64) is read directly without decoding\n"
+						   "- Output frames have a fixed length set by the processing block size\n"
+						   "- Outputs audio at the sample rate of the file, mixers convert it to the project "
+						   "sample rate\n\n"
 						   "## Usage\n"
 						   "- Add file paths to the input list\n"
 						   "- Connect output pins to other audio processors or outputs\n"
 						   "- Supports real-time audio playback from files",
 		};
+
+		return info;
+	}
+
+	// 无压缩WAV的快速路径
+	// - data块已被内存映射，直接转换为交错float帧，不经过解复用与解码
+	static void read_wav_file(
+		Wav_reader& reader,
+		int block_size,
+		const std::set<std::shared_ptr<Audio_stream>>& output_item,
+		const std::atomic<bool>& main_stop_token,
+		const std::atomic<bool>& error_stop_token
+	)
+	{
+		const auto& format = reader.get_format();
+
+		AVChannelLayout layout;
+		if (format.channel_mask != 0 && std::popcount(format.channel_mask) == format.channels)
+			av_channel_layout_from_mask(&layout, format.channel_mask);
+		else
+			av_channel_layout_default(&layout, format.channels);
+		const Free_utility free_layout(std::bind(av_channel_layout_uninit, &layout));
+
+		auto push_frame = [&main_stop_token, &error_stop_token, &output_item](
+							  const std::shared_ptr<Audio_frame>& frame
+						  )
+		{
+			for (auto& channel : output_item)
+			{
+				if (main_stop_token || error_stop_token) return;
+
+				while (channel->try_push(frame) != boost::fibers::channel_op_status::success)
+				{
+					if (main_stop_token || error_stop_token) return;
+					boost::this_fiber::yield();
+				}
+			}
+
+			boost::this_fiber::yield();
+		};
+
+		int64_t sample_index = 0;
+
+		while (!main_stop_token && !error_stop_token)
+		{
+			const size_t frame_samples = std::min<size_t>(block_size, reader.remaining_frames());
+			if (frame_samples == 0) break;
+
+			const std::shared_ptr<Audio_frame> new_frame = std::make_shared<Audio_frame>();
+			AVFrame* frame = new_frame->data();
+
+			frame->format = AV_SAMPLE_FMT_FLT;
+			frame->sample_rate = format.sample_rate;
+			frame->nb_samples = static_cast<int>(frame_samples);
+			frame->pts = sample_index;
+			frame->time_base = {.num = 1, .den = format.sample_rate};
+			if (av_channel_layout_copy(&frame->ch_layout, &layout) < 0) throw std::bad_alloc();
+			if (av_frame_get_buffer(frame, 0) < 0) throw std::bad_alloc();
+
+			reader.read_interleaved(reinterpret_cast<float*>(frame->data[0]), frame_samples);
+			sample_index += static_cast<int64_t>(frame_samples);
+
+			push_frame(new_frame);
+		}
+
+		for (auto& channel : output_item) channel->set_eof();
+	}
+
+	// 读取文件头得到采样率，无法识别时返回std::nullopt
+	static std::optional<int> probe_sample_rate(const std::string& file_path)
+	{
+		if (auto wav_reader = Wav_reader::open(file_path); wav_reader.has_value())
+			return wav_reader->get_format().sample_rate;
+
+		AVFormatContext* format_context = nullptr;
+		if (avformat_open_input(&format_context, file_path.c_str(), nullptr, nullptr) < 0)
+			return std::nullopt;
+		const Free_utility free_format_context(std::bind(avformat_close_input, &format_context));
+
+		if (avformat_find_stream_info(format_context, nullptr) < 0) return std::nullopt;
+
+		const int audio_index = av_find_best_stream(format_context, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+		if (audio_index < 0) return std::nullopt;
+
+		const int sample_rate = format_context->streams[audio_index]->codecpar->sample_rate;
+		if (sample_rate <= 0) return std::nullopt;
+
+		return sample_rate;
+	}
+
+	// 带缓存的probe_sample_rate()
+	// - 以路径为键，源文件的大小或修改时间变化后重新探测，否则只需要读取文件属性
+	// - 无法识别的文件同样被缓存，不会在每次开始预览时重复打开
+	static std::optional<int> probe_sample_rate_cached(const std::string& file_path)
+	{
+		struct Cache_entry
+		{
+			Peak_pyramid::Source_info source;
+			std::optional<int> sample_rate;
+		};
+
+		static std::mutex cache_mutex;
+		static std::map<std::string, Cache_entry> cache;
+
+		const auto source = Peak_pyramid::get_source_info(file_path);
+		if (!source.has_value()) return std::nullopt;
+
+		{
+			const std::lock_guard lock(cache_mutex);
+			const auto find = cache.find(file_path);
+			if (find != cache.end() && find->second.source == *source) return find->second.sample_rate;
+		}
+
+		const auto sample_rate = probe_sample_rate(file_path);
+
+		const std::lock_guard lock(cache_mutex);
+		cache.insert_or_assign(file_path, Cache_entry{.source = *source, .sample_rate = sample_rate});
+		return sample_rate;
+	}
+
+	std::vector<int> Audio_input::probe_sample_rates() const
+	{
+		std::vector<int> sample_rates;
+
+		for (size_t i = 0; i < file_paths.size(); i++)
+		{
+			const auto& file_path = file_paths[i];
+			if (file_path.empty()) continue;
+
+			// 波形已经在后台生成时，金字塔中记录了采样率，不需要再访问文件
+			if (i < waveforms.size() && waveforms[i] != nullptr && waveforms[i]->get_file_path() == file_path
+				&& waveforms[i]->get_status() == Waveform::Status::Ready)
+			{
+				sample_rates.push_back(waveforms[i]->get_pyramid().get_sample_rate());
+				continue;
+			}
+
+			if (const auto sample_rate = probe_sample_rate_cached(file_path); sample_rate.has_value())
+				sample_rates.push_back(*sample_rate);
+		}
+
+		return sample_rates;
 	}
 
 	std::vector<infra::Processor::Pin_attribute> Audio_input::get_pin_attributes() const
@@ -79,11 +231,23 @@ namespace processor
 
 		/* 解码上下文 */
 
-		auto file_fiber = [](const std::set<std::shared_ptr<Audio_stream>> output_item,
-							 const std::string& file_path,
-							 const std::atomic<bool>& main_stop_token,
-							 std::atomic<bool>& error_stop_token)
+		// 所有输出帧的长度都是block_size，最后一帧除外
+		const int block_size = runtime_config::block_size;
+
+		auto file_fiber = [block_size](
+							  const std::set<std::shared_ptr<Audio_stream>> output_item,
+							  const std::string& file_path,
+							  const std::atomic<bool>& main_stop_token,
+							  std::atomic<bool>& error_stop_token
+						  )
 		{
+			// 无压缩WAV走快速路径，其余格式交给libavformat/libavcodec
+			if (auto wav_reader = Wav_reader::open(file_path); wav_reader.has_value())
+			{
+				read_wav_file(*wav_reader, block_size, output_item, main_stop_token, error_stop_token);
+				return;
+			}
+
 			AVFormatContext* format_context = nullptr;
 			int audio_index;
 			{
@@ -170,10 +334,17 @@ namespace processor
 				boost::this_fiber::yield();
 			};
 
-			while (!main_stop_token && !error_stop_token)
+			// 解码得到的帧长度不定（MP3为1152，FLAC常为4096），重新分块为固定长度
+			Frame_rechunker rechunker(block_size);
+			Audio_frame decoded_frame;
+
+			auto push_ready_blocks = [&rechunker, &push_frame]
 			{
-				const std::shared_ptr<Audio_frame> new_frame = std::make_shared<Audio_frame>();
+				while (rechunker.ready()) push_frame(rechunker.pop());
+			};
 
+			while (!main_stop_token && !error_stop_token)
+			{
 				do {
 					const int read_frame_result = av_read_frame(format_context, packet);
 					if (read_frame_result < 0)
@@ -204,7 +375,7 @@ namespace processor
 
 				av_packet_unref(packet);
 
-				const int receive_frame_result = avcodec_receive_frame(codec_context, new_frame->data());
+				const int receive_frame_result = avcodec_receive_frame(codec_context, decoded_frame.data());
 				if (receive_frame_result < 0)
 				{
 					if (receive_frame_result == AVERROR(EAGAIN))
@@ -219,7 +390,15 @@ namespace processor
 						);
 				}
 
-				push_frame(new_frame);
+				rechunker.push(*decoded_frame);
+				push_ready_blocks();
+			}
+
+			// 输出不足一块的剩余采样
+			if (!main_stop_token && !error_stop_token)
+			{
+				rechunker.finish();
+				push_ready_blocks();
 			}
 
 			for (auto& channel : output_item) channel->set_eof();
@@ -337,11 +516,107 @@ namespace processor
 		remove_index.reset();
 	}
 
+	std::unique_ptr<infra::Processor> Audio_input::clone() const
+	{
+		auto processor = std::make_unique<Audio_input>();
+		processor->file_count = file_count;
+		processor->file_paths = file_paths;
+		return processor;
+	}
+
 	void Audio_input::draw_title()
 	{
 		imgui_utility::shadowed_text("Audio Input");
 	}
 
+	// 在节点中绘制波形预览
+	// - 每列像素从金字塔中取出对应一段的峰值，开销只与宽度有关，与音频长度无关
+	static void draw_waveform(Waveform& waveform)
+	{
+		const ImVec2 size(
+			config::processor::audio_input::waveform_width * runtime_config::ui_scale,
+			config::processor::audio_input::waveform_height * runtime_config::ui_scale
+		);
+		const ImVec2 min = ImGui::GetCursorScreenPos();
+		const ImVec2 max(min.x + size.x, min.y + size.y);
+
+		ImGui::Dummy(size);
+		if (!ImGui::IsItemVisible()) return;
+
+		auto* const draw_list = ImGui::GetWindowDrawList();
+		draw_list->AddRectFilled(min, max, ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+		const auto draw_centered_text = [&](const std::string& text)
+		{
+			const ImVec2 text_size = ImGui::CalcTextSize(text.c_str());
+			draw_list->AddText(
+				ImVec2(min.x + (size.x - text_size.x) / 2, min.y + (size.y - text_size.y) / 2),
+				ImGui::GetColorU32(ImGuiCol_TextDisabled),
+				text.c_str()
+			);
+		};
+
+		switch (waveform.get_status())
+		{
+		case Waveform::Status::Loading:
+			draw_centered_text(std::format("Analyzing {}%", int(waveform.get_progress() * 100)));
+			return;
+		case Waveform::Status::Failed:
+			draw_centered_text("Waveform unavailable");
+			return;
+		case Waveform::Status::Ready:
+			break;
+		}
+
+		const int width = std::max(static_cast<int>(size.x), 1);
+		const auto peaks = waveform.get_peaks(width);
+
+		const float center_y = (min.y + max.y) / 2;
+		const float half_height = size.y / 2;
+		const ImU32 peak_color = ImGui::GetColorU32(ImGuiCol_PlotLines);
+		const ImU32 rms_color = ImGui::GetColorU32(ImGuiCol_PlotLinesHovered);
+
+		// 外层为最小值到最大值，内层为RMS
+		for (int x = 0; x < width; x++)
+		{
+			const auto& peak = peaks[x];
+			const float column_x = min.x + float(x) + 0.5f;
+
+			const float top = center_y - peak.max / 32767.0f * half_height;
+			const float bottom = center_y - peak.min / 32767.0f * half_height;
+			draw_list->AddLine(ImVec2(column_x, top), ImVec2(column_x, bottom + 1), peak_color);
+
+			const float rms = peak.rms / 65535.0f * half_height;
+			draw_list->AddLine(
+				ImVec2(column_x, center_y - rms),
+				ImVec2(column_x, center_y + rms + 1),
+				rms_color
+			);
+		}
+	}
+
+	void Audio_input::sync_waveforms()
+	{
+		waveforms.resize(file_paths.size());
+
+		// 旧的后台任务在波形析构时停止
+		for (size_t i = 0; i < file_paths.size(); i++)
+		{
+			if (file_paths[i].empty())
+				waveforms[i].reset();
+			else if (waveforms[i] == nullptr || waveforms[i]->get_file_path() != file_paths[i])
+				waveforms[i] = std::make_unique<Waveform>(file_paths[i]);
+		}
+	}
+
+	void Audio_input::draw_preview()
+	{
+		sync_waveforms();
+
+		for (const auto& waveform : waveforms)
+			if (waveform != nullptr) draw_waveform(*waveform);
+	}
+
 	bool Audio_input::draw_content(bool readonly)
 	{
 		bool modified = false;
@@ -349,6 +624,8 @@ namespace processor
 
 		if (remove_index.has_value())
 		{
+			if (remove_index.value() < waveforms.size())
+				waveforms.erase(waveforms.begin() + remove_index.value());
 			file_paths.erase(file_paths.begin() + remove_index.value());
 			remove_index.reset();
 			file_count--;
@@ -425,9 +702,9 @@ namespace processor
 		return modified;
 	}
 
-	infra::Processor::Info Audio_output::get_processor_info()
+	const infra::Processor::Info& Audio_output::get_processor_info()
 	{
-		return infra::Processor::Info{
+		static const infra::Processor::Info info{
 			.identifier = "audio_output",
 			.display_name = "Audio Output",
 			.singleton = true,
@@ -436,11 +713,15 @@ namespace processor
 						   "## Functionality\n"
 						   "- Outputs audio streams to the system's audio device\n"
 						   "- Supports real-time audio playback\n"
-						   "- Outputs audio in 48kHz, 32-bit float format\n\n"
+						   "- Exports to MP3, WAV, FLAC or Opus files\n"
+						   "- Previews at the project sample rate\n"
+						   "- Exports at the sample rate of the input when the format supports it\n\n"
 						   "## Usage\n"
 						   "- Connect an audio stream input to the 'Input' pin\n"
 						   "- The processor will play the audio through the system's default output device",
 		};
+
+		return info;
 	}
 
 	std::vector<infra::Processor::Pin_attribute> Audio_output::get_pin_attributes() const
@@ -477,7 +758,7 @@ namespace processor
 
 	void Audio_output::do_preview(
 		Audio_stream& input_stream,
-		SDL_AudioDeviceID audio_device,
+		Audio_device& audio_device,
 		const std::atomic<bool>& stop_token
 	)
 	{
@@ -489,15 +770,8 @@ namespace processor
 
 		std::optional<Stream_info> stream_info;
 
-		SDL_PauseAudioDevice(audio_device, 0);
-		SDL_ClearQueuedAudio(audio_device);
-		const Free_utility stop_audio(
-			[audio_device]
-			{
-				SDL_ClearQueuedAudio(audio_device);
-				SDL_PauseAudioDevice(audio_device, 1);
-			}
-		);
+		audio_device.start();
+		const Free_utility stop_audio([&audio_device] { audio_device.stop(); });
 
 		std::vector<config::audio::Buffer_type> output_buffer;
 
@@ -543,11 +817,12 @@ namespace processor
 
 				const Audio_resampler::Format output_format{
 					.format = config::audio::av_format,
-					.sample_rate = config::audio::sample_rate,
+					.sample_rate = audio_device.get_sample_rate(),
 					.channel_layout = config::audio::av_channel_layout
 				};
 
-				auto resampler_create = Audio_resampler::create(input_format, output_format);
+				auto resampler_create
+					= Audio_resampler::create(input_format, output_format, Audio_resampler::Quality::Preview);
 				if (!resampler_create.has_value())
 					throw infra::Processor::Runtime_error(
 						"Failed to create audio resampler",
@@ -594,8 +869,8 @@ namespace processor
 					std::format("Got {} channels", frame_channels)
 				);
 
-			const int output_buffer_size
-				= (float)frame_sample_element_count / frame_sample_rate * config::audio::sample_rate * 1.5;
+			const int output_buffer_size = (float)frame_sample_element_count / frame_sample_rate
+										 * audio_device.get_sample_rate() * 1.5;
 			output_buffer.resize(output_buffer_size * 2);
 
 			const auto output_ptr_array = std::to_array({output_buffer.data()});
@@ -617,24 +892,26 @@ namespace processor
 			if constexpr (std::is_same_v<config::audio::Buffer_type, float>)
 				for (auto& val : output_buffer) val = std::clamp<float>(val, -1.0, +1.0);
 
-			while (SDL_GetQueuedAudioSize(audio_device) > config::audio::max_buffer_size)
+			// 写入环形缓冲区，缓冲量超过目标时等待，以控制延迟
+			std::span<const config::audio::Buffer_type> pending(
+				output_buffer.data(),
+				size_t(convert_count) * config::audio::channels
+			);
+
+			while (!pending.empty())
 			{
 				if (stop_token) return;
-				boost::this_fiber::yield();
-			}
 
-			if (SDL_QueueAudio(
-					audio_device,
-					output_buffer.data(),
-					convert_count * config::audio::channels * sizeof(config::audio::Buffer_type)
-				)
-				!= 0)
-				throw Runtime_error(
-					"Failed to queue audio data",
-					"Cannot send audio data to the output device. Internal or IO error may have occurred.",
-					std::format("SDL Error: {}", SDL_GetError())
-				);
+				if (audio_device.get_buffered_frames() < audio_device.get_target_frames())
+					pending = pending.subspan(audio_device.write(pending));
+
+				if (!pending.empty()) boost::this_fiber::yield();
+			}
 		}
+
+		// 输入结束，等待环形缓冲区中剩余的采样播放完毕
+		audio_device.drain();
+		while (!stop_token && audio_device.get_buffered_frames() > 0) boost::this_fiber::yield();
 	}
 
 	void Audio_output::do_export(
@@ -645,150 +922,135 @@ namespace processor
 	{
 		/* 设置上下文 */
 
-		std::ofstream output_file(context.export_path, std::ios::binary);
-		if (!output_file.is_open())
+		auto writer_open = Double_buffered_writer::open(
+			context.export_path,
+			config::processor::audio_output::export_write_buffer_size
+		);
+		if (!writer_open.has_value())
 			throw Runtime_error(
 				"Failed to open output file",
 				"Cannot open the output file for writing. Check if the path is valid and writable.",
 				std::format("Output path: {}", context.export_path)
 			);
+		Double_buffered_writer& writer = *writer_open.value();
+
+		// 交给编码线程的单元
+		struct Export_item
+		{
+			std::shared_ptr<const Audio_frame> frame;
+			int64_t silence_samples;  // 在该帧之前需要插入的静音采样数
+			double end_time;          // 该帧结束的时间，用于汇报进度
+		};
 
-		lame_t lame = lame_init();
-		if (lame == nullptr) throw std::bad_alloc();
-		const Free_utility free_lame(std::bind(lame_close, lame));
+		// 编码线程通过纤程通道接收单元：队列满时推入方挂起当前纤程，队列空时编码线程阻塞等待，
+		// 任意一方关闭通道都会唤醒另一方
+		boost::fibers::buffered_channel<Export_item> queue(
+			config::processor::audio_output::export_queue_size
+		);
 
-		std::vector<std::byte> file_buffer;
+		std::atomic<bool> aborted = false;  // 导出被取消或出错
+		std::optional<Runtime_error> encoder_error;
+		boost::fibers::promise<void> encoder_done;
+		auto encoder_done_future = encoder_done.get_future();
 
-		bool lame_param_set = false;
-		auto& time = *context.time;
-		int sample_rate = 0;
+		/* 编码线程 */
 
-		auto push_silence = [lame, &file_buffer, &sample_rate, &output_file](double time)
+		// 依次编码通道中的单元，直到通道被关闭且取空
+		// - 导出被取消时返回false，不再编码通道中剩余的单元
+		auto encode_items = [&queue, &aborted, &stop_token, &writer, &context](Audio_encoder& encoder)
 		{
-			const int silence_samples = static_cast<int>(time * sample_rate);
-			if (silence_samples <= 0) return;
+			auto& time = *context.time;
+			Export_item item;
 
-			const int buffer_size = 1.25 * silence_samples + 7200;  // LAME 的缓冲区大小
-			file_buffer.resize(buffer_size);
+			while (queue.pop(item) == boost::fibers::channel_op_status::success)
+			{
+				if (aborted || stop_token) return false;
 
-			std::vector<short> silence_buffer(silence_samples * 2, 0);  // 双声道静音缓冲区
+				const AVFrame& frame = *item.frame->data();
 
-			const int written = lame_encode_buffer_interleaved(
-				lame,
-				silence_buffer.data(),
-				silence_samples,
-				reinterpret_cast<unsigned char*>(file_buffer.data()),
-				buffer_size
-			);
+				if (!encoder.is_initialized()) encoder.initialize(frame, writer);
 
-			if (written < 0)
-				throw Runtime_error(
-					"Failed to encode silence",
-					"Cannot encode silence audio data. Internal error may have occurred.",
-					std::format("LAME Error: {}", written)
-				);
+				encoder.encode_silence(item.silence_samples, writer);
+				encoder.encode_frame(frame, writer);
 
-			if (written == 0) return;
+				time = item.end_time;
+			}
 
-			output_file.write(reinterpret_cast<const char*>(file_buffer.data()), written);
+			if (aborted || stop_token) return false;
+
+			encoder.flush(writer);
+			return true;
 		};
 
-		auto parse_frame = [lame, &file_buffer, &output_file](const AVFrame& frame)
+		auto encode_loop = [&encode_items, &writer, &context]
 		{
-			const int buffer_size = 4 * frame.nb_samples + 7200;  // LAME 的缓冲区大小
-			file_buffer.resize(buffer_size);
-
-			int written;
-
-			switch ((AVSampleFormat)frame.format)
+			const auto write_error = [&context]
 			{
-			case AV_SAMPLE_FMT_S16:
-			{
-				written = lame_encode_buffer_interleaved(
-					lame,
-					reinterpret_cast<short*>(frame.data[0]),
-					frame.nb_samples,
-					reinterpret_cast<unsigned char*>(file_buffer.data()),
-					buffer_size
+				return Runtime_error(
+					"Failed to write output file",
+					"Cannot write encoded audio to the output file. Check if the disk is full or writable.",
+					std::format("Output path: {}", context.export_path)
 				);
-				break;
-			}
-			case AV_SAMPLE_FMT_S16P:
-			{
-				written = lame_encode_buffer(
-					lame,
-					reinterpret_cast<short*>(frame.data[0]),
-					reinterpret_cast<short*>(frame.data[1]),
-					frame.nb_samples,
-					reinterpret_cast<unsigned char*>(file_buffer.data()),
-					buffer_size
-				);
-			}
-			case AV_SAMPLE_FMT_S32:
-			{
-				written = lame_encode_buffer_interleaved_int(
-					lame,
-					reinterpret_cast<int*>(frame.data[0]),
-					frame.nb_samples,
-					reinterpret_cast<unsigned char*>(file_buffer.data()),
-					buffer_size
-				);
-				break;
-			}
-			case AV_SAMPLE_FMT_S32P:
+			};
+
+			const auto encoder = create_audio_encoder(context.format, context.kbps, context.parallel_encode);
+			if (!encode_items(*encoder)) return;
+
+			if (!writer.finish()) throw write_error();
+
+			// 部分格式的文件头需要在所有数据写入后回填
+			if (const auto patch = encoder->get_header_patch(); patch.has_value())
 			{
-				written = lame_encode_buffer_int(
-					lame,
-					reinterpret_cast<int*>(frame.data[0]),
-					reinterpret_cast<int*>(frame.data[1]),
-					frame.nb_samples,
-					reinterpret_cast<unsigned char*>(file_buffer.data()),
-					buffer_size
-				);
+				std::fstream file(context.export_path, std::ios::binary | std::ios::in | std::ios::out);
+				file.seekp(patch->offset);
+				file.write(reinterpret_cast<const char*>(patch->data.data()), patch->data.size());
+				if (!file.good()) throw write_error();
 			}
-			case AV_SAMPLE_FMT_FLT:
+		};
+
+		std::jthread encoder_thread(
+			[&encode_loop, &encoder_error, &encoder_done, &aborted, &queue]
 			{
-				written = lame_encode_buffer_interleaved_ieee_float(
-					lame,
-					reinterpret_cast<const float*>(frame.data[0]),
-					frame.nb_samples,
-					reinterpret_cast<unsigned char*>(file_buffer.data()),
-					buffer_size
-				);
-				break;
+				try
+				{
+					encode_loop();
+				}
+				catch (const Runtime_error& e)
+				{
+					encoder_error = e;
+					aborted = true;
+				}
+				catch (const std::exception& e)
+				{
+					encoder_error = Runtime_error(
+						"Unexpected error in audio encoder",
+						"An unexpected error occurred while encoding the exported audio.",
+						std::format("Error: {}", e.what())
+					);
+					aborted = true;
+				}
+
+				// 编码线程提前退出时，唤醒阻塞在推入上的纤程
+				queue.close();
+				encoder_done.set_value();
 			}
-			case AV_SAMPLE_FMT_FLTP:
+		);
+
+		// 异常退出或被停止时，关闭通道使编码线程立即结束
+		const Free_utility stop_encoder(
+			[&aborted, &queue, &encoder_thread]
 			{
-				written = lame_encode_buffer_ieee_float(
-					lame,
-					reinterpret_cast<const float*>(frame.data[0]),
-					reinterpret_cast<const float*>(frame.data[1]),
-					frame.nb_samples,
-					reinterpret_cast<unsigned char*>(file_buffer.data()),
-					buffer_size
-				);
-				break;
-			}
-			default:
-				throw Runtime_error(
-					"Unsupported sample format",
-					"The audio sample format is not supported for encoding.",
-					std::format("Sample format: {}", frame.format)
-				);
+				aborted = true;
+				queue.close();
+				if (encoder_thread.joinable()) encoder_thread.join();
 			}
+		);
 
-			if (written < 0)
-				throw Runtime_error(
-					"Failed to encode audio frame",
-					"Cannot encode the audio frame. Internal error may have occurred.",
-					std::format("LAME Error: {}", written)
-				);
+		/* 读取输入流并交给编码线程 */
 
-			if (written == 0) return;
-			output_file.write(reinterpret_cast<const char*>(file_buffer.data()), written);
-		};
+		double queued_time = 0;
 
-		while (!stop_token)
+		while (!stop_token && !aborted)
 		{
 			const auto pop_result = input_stream.try_pop();
 
@@ -806,41 +1068,37 @@ namespace processor
 				const std::shared_ptr<const Audio_frame>& audio_frame = pop_result.value();
 				const AVFrame& frame = *audio_frame->data();
 
-				if (!lame_param_set)  // 在第一帧初始化重采样器
-				{
-					lame_param_set = true;
-
-					lame_set_in_samplerate(lame, frame.sample_rate);
-					lame_set_num_channels(lame, frame.ch_layout.nb_channels);
-					lame_set_quality(lame, 2);
-					lame_set_mode(
-						lame,
-						frame.ch_layout.nb_channels == 2 ? MPEG_mode::STEREO : MPEG_mode::MONO
-					);
-					lame_set_out_samplerate(lame, config::audio::sample_rate);
-					lame_set_VBR(lame, vbr_off);
-					lame_set_brate(lame, context.kbps);
-
-					if (lame_init_params(lame) == -1)
-						throw Runtime_error(
-							"Failed to initialize LAME parameters",
-							"Cannot set LAME parameters for encoding. Internal error may have occurred."
-						);
-
-					sample_rate = frame.sample_rate;
-				}
-
 				const double frame_begin = frame.pts * av_q2d(frame.time_base);
 				const double frame_end = frame_begin + frame.nb_samples / (double)frame.sample_rate;
-				const double silence_time = frame_begin - time;
+				const auto silence_samples
+					= std::max<int64_t>(0, static_cast<int64_t>((frame_begin - queued_time) * frame.sample_rate));
 
-				push_silence(silence_time);
-				parse_frame(frame);
-				time = frame_end;
+				Export_item item{.frame = audio_frame, .silence_samples = silence_samples, .end_time = frame_end};
+
+				// 通道只会被编码线程提前关闭，此时停止读取，错误在下方抛出
+				if (queue.push(std::move(item)) != boost::fibers::channel_op_status::success) break;
+
+				queued_time = frame_end;
 			}
 
 			boost::this_fiber::yield();
 		}
+
+		if (stop_token) return;
+
+		/* 等待编码线程完成 */
+
+		queue.close();
+
+		// 停止标志没有通知机制，等待时按固定间隔检查
+		const auto wait_interval
+			= std::chrono::milliseconds(config::processor::audio_output::encoder_wait_ms);
+		while (encoder_done_future.wait_for(wait_interval) == boost::fibers::future_status::timeout)
+			if (stop_token) return;
+
+		encoder_thread.join();
+
+		if (encoder_error.has_value()) throw Runtime_error(*encoder_error);
 	}
 
 	void Audio_output::process_payload(
@@ -862,7 +1120,12 @@ namespace processor
 			);
 
 		if (!frontend_context.do_export)
-			do_preview(input_item_optional.value().get(), frontend_context.audio_device, stop_token);
+		{
+			if (frontend_context.audio_device == nullptr)
+				THROW_LOGIC_ERROR("Audio output processor has no audio device in preview mode");
+
+			do_preview(input_item_optional.value().get(), *frontend_context.audio_device, stop_token);
+		}
 		else
 			do_export(input_item_optional.value().get(), frontend_context, stop_token);
 	}
@@ -0,0 +1,124 @@
+#include "processor/audio-kernel.hpp"
+#include "infra/processor.hpp"
+
+extern "C"
+{
+#include <libavutil/samplefmt.h>
+}
+
+#include <algorithm>
+#include <format>
+#include <limits>
+
+namespace processor
+{
+	void mix_stereo_planar(
+		float* out_left,
+		float* out_right,
+		std::span<uint8_t** const> inputs,
+		std::span<const float> volumes,
+		int sample_count
+	)
+	{
+		std::fill_n(out_left, sample_count, 0.0f);
+		std::fill_n(out_right, sample_count, 0.0f);
+
+		// 各路输入长度相同，逐路累加，内层循环可以向量化
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			const auto* in_left = reinterpret_cast<const float*>(inputs[i][0]);
+			const auto* in_right = reinterpret_cast<const float*>(inputs[i][1]);
+			const float volume = volumes[i];
+
+			for (int j = 0; j < sample_count; j++)
+			{
+				out_left[j] += in_left[j] * volume;
+				out_right[j] += in_right[j] * volume;
+			}
+		}
+	}
+
+	std::vector<float> extract_samples_interleaved(const AVFrame* frame)
+	{
+		std::vector<float> samples;
+
+		const int channel_count = frame->ch_layout.nb_channels;
+		const int sample_count = frame->nb_samples;
+		const auto sample_format = (AVSampleFormat)frame->format;
+
+		samples.resize(sample_count * channel_count);
+
+		switch (sample_format)
+		{
+		case AV_SAMPLE_FMT_FLT:
+			std::copy(
+				reinterpret_cast<const float*>(frame->data[0]),
+				reinterpret_cast<const float*>(frame->data[0]) + sample_count * channel_count,
+				samples.data()
+			);
+			break;
+		case AV_SAMPLE_FMT_FLTP:
+			for (int ch = 0; ch < channel_count; ++ch)
+			{
+				float* sample_ptr = samples.data() + ch;
+
+				for (int i = 0; i < sample_count; ++i)
+				{
+					*sample_ptr = reinterpret_cast<const float*>(frame->data[ch])[i];
+					sample_ptr += channel_count;
+				}
+			}
+			break;
+		case AV_SAMPLE_FMT_S16:
+			std::transform(
+				(const int16_t*)frame->data[0],
+				(const int16_t*)frame->data[0] + sample_count * channel_count,
+				samples.begin(),
+				[](int16_t sample) { return static_cast<float>(sample) / 32768.0f; }
+			);
+			break;
+		case AV_SAMPLE_FMT_S16P:
+			for (int ch = 0; ch < channel_count; ++ch)
+			{
+				float* sample_ptr = samples.data() + ch;
+
+				for (int i = 0; i < sample_count; ++i)
+				{
+					*sample_ptr = (float)reinterpret_cast<const int16_t*>(frame->data[ch])[i]
+								/ std::numeric_limits<int16_t>::max();
+					sample_ptr += channel_count;
+				}
+			}
+			break;
+		case AV_SAMPLE_FMT_S32:
+			std::transform(
+				(const int32_t*)frame->data[0],
+				(const int32_t*)frame->data[0] + sample_count * channel_count,
+				samples.begin(),
+				[](int32_t sample) { return static_cast<float>(sample) / 2147483648.0f; }
+			);
+			break;
+		case AV_SAMPLE_FMT_S32P:
+			for (int ch = 0; ch < channel_count; ++ch)
+			{
+				float* sample_ptr = samples.data() + ch;
+
+				for (int i = 0; i < sample_count; ++i)
+				{
+					*sample_ptr = (double)reinterpret_cast<const int32_t*>(frame->data[ch])[i]
+								/ std::numeric_limits<int32_t>::max();
+					sample_ptr += channel_count;
+				}
+			}
+			break;
+		default:
+			throw infra::Processor::Runtime_error(
+				"Unsupported sample format",
+				"The processors do not support the given sample format.",
+				std::format("Sample format: {}", av_get_sample_fmt_name((AVSampleFormat)frame->format))
+			);
+		}
+
+		return samples;
+	}
+}
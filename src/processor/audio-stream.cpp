@@ -1,6 +1,9 @@
 #include "processor/audio-stream.hpp"
+#include "utility/logic-error-utility.hpp"
 
 #include <boost/fiber/operations.hpp>
+#include <format>
+#include <source_location>
 
 #define ASSERT_FRAME_VALID assert(frame != nullptr && "Audio_frame is not initialized")
 
@@ -57,10 +60,67 @@ namespace processor
 		return *frame;
 	}
 
+	Audio_frame_pool::Audio_frame_pool(
+		AVSampleFormat format,
+		int sample_rate,
+		const AVChannelLayout& channel_layout,
+		int capacity
+	) :
+		format(format),
+		sample_rate(sample_rate),
+		capacity(capacity),
+		plane_count(av_sample_fmt_is_planar(format) ? channel_layout.nb_channels : 1),
+		pool(nullptr, [](AVBufferPool* pool) { av_buffer_pool_uninit(&pool); })
+	{
+		if (capacity <= 0) THROW_LOGIC_ERROR("Invalid capacity {} for Audio_frame_pool", capacity);
+		if (plane_count > AV_NUM_DATA_POINTERS)
+			THROW_LOGIC_ERROR("Audio_frame_pool does not support {} planes", plane_count);
+
+		if (av_channel_layout_copy(&this->channel_layout, &channel_layout) < 0) throw std::bad_alloc();
+
+		if (av_samples_get_buffer_size(&linesize, channel_layout.nb_channels, capacity, format, 0) < 0)
+			THROW_LOGIC_ERROR("Invalid sample format {} for Audio_frame_pool", (int)format);
+
+		pool.reset(av_buffer_pool_init(linesize, nullptr));
+		if (pool == nullptr) throw std::bad_alloc();
+	}
+
+	Audio_frame_pool::~Audio_frame_pool()
+	{
+		av_channel_layout_uninit(&channel_layout);
+	}
+
+	std::shared_ptr<Audio_frame> Audio_frame_pool::acquire()
+	{
+		const auto new_frame = std::make_shared<Audio_frame>();
+		AVFrame* frame = new_frame->data();
+
+		frame->format = format;
+		frame->sample_rate = sample_rate;
+		frame->nb_samples = capacity;
+		frame->linesize[0] = linesize;
+		if (av_channel_layout_copy(&frame->ch_layout, &channel_layout) < 0) throw std::bad_alloc();
+
+		// 每个平面使用池中的一块缓冲区，帧释放时自动归还
+		for (int plane = 0; plane < plane_count; plane++)
+		{
+			frame->buf[plane] = av_buffer_pool_get(pool.get());
+			if (frame->buf[plane] == nullptr) throw std::bad_alloc();
+			frame->data[plane] = frame->buf[plane]->data;
+		}
+		frame->extended_data = frame->data;
+
+		return new_frame;
+	}
+
 	auto Audio_stream::try_push(std::shared_ptr<const Audio_frame> frame) -> boost::fibers::channel_op_status
 	{
 		const auto status = channel.try_push(std::move(frame));
-		if (status == boost::fibers::channel_op_status::success) ++buffered_frames;
+		if (status == boost::fibers::channel_op_status::success)
+		{
+			++buffered_frames;
+			pushed_frames.fetch_add(1, std::memory_order_relaxed);
+		}
 
 		return status;
 	}
@@ -76,6 +136,10 @@ namespace processor
 			return frame;
 		}
 
+		// 只统计上游尚未结束时的取空，结束后的取空不代表等待
+		if (status == boost::fibers::channel_op_status::empty && !eof())
+			empty_pops.fetch_add(1, std::memory_order_relaxed);
+
 		return std::unexpected(status);
 	}
 }
\ No newline at end of file
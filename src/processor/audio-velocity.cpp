@@ -3,18 +3,115 @@
 #define NOMINMAX
 #endif
 
+#include "config.hpp"
 #include "processor/audio-velocity.hpp"
+#include "processor/frame-rechunker.hpp"
+#include "utility/free-utility.hpp"
 #include "utility/imgui-utility.hpp"
+#include "utility/sw-resample.hpp"
 
 #include <algorithm>
 #include <boost/fiber/operations.hpp>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <span>
 #include <soundtouch/SoundTouch.h>
 
 namespace processor
 {
-	infra::Processor::Info Velocity_modifier::get_processor_info()
+	static constexpr Soundtouch_quality soundtouch_quality_list[] = {
+		Soundtouch_quality::Auto,
+		Soundtouch_quality::Fast,
+		Soundtouch_quality::High
+	};
+
+	std::string_view get_soundtouch_quality_name(Soundtouch_quality quality)
+	{
+		switch (quality)
+		{
+		case Soundtouch_quality::Auto:
+			return "Auto";
+		case Soundtouch_quality::Fast:
+			return "Fast";
+		case Soundtouch_quality::High:
+			return "High";
+		}
+
+		return "Unknown";
+	}
+
+	static std::string_view get_soundtouch_quality_identifier(Soundtouch_quality quality)
+	{
+		switch (quality)
+		{
+		case Soundtouch_quality::Auto:
+			return "auto";
+		case Soundtouch_quality::Fast:
+			return "fast";
+		case Soundtouch_quality::High:
+			return "high";
+		}
+
+		return "unknown";
+	}
+
+	static Json::Value serialize_soundtouch_quality(Soundtouch_quality quality)
+	{
+		return std::string(get_soundtouch_quality_identifier(quality));
+	}
+
+	static void deserialize_soundtouch_quality(const Json::Value& value, Soundtouch_quality& quality)
+	{
+		if (!value.isMember("quality") || !value["quality"].isString()) return;
+
+		const auto identifier = value["quality"].asString();
+		const auto find
+			= std::ranges::find(soundtouch_quality_list, identifier, get_soundtouch_quality_identifier);
+		if (find != std::end(soundtouch_quality_list)) quality = *find;
+	}
+
+	static void draw_soundtouch_quality_combo(Soundtouch_quality& quality)
+	{
+		if (ImGui::BeginCombo("Quality", get_soundtouch_quality_name(quality).data()))
+		{
+			for (const auto item : soundtouch_quality_list)
+			{
+				const bool is_selected = (item == quality);
+				if (ImGui::Selectable(get_soundtouch_quality_name(item).data(), is_selected)) quality = item;
+				if (is_selected) ImGui::SetItemDefaultFocus();
+			}
+
+			ImGui::EndCombo();
+		}
+
+		if (ImGui::BeginItemTooltip())
+			ImGui::Text("Auto: fast when previewing, high when exporting"), ImGui::EndTooltip();
+	}
+
+	// 将Auto解析为当前运行实际使用的质量
+	static Soundtouch_quality resolve_soundtouch_quality(Soundtouch_quality quality)
+	{
+		if (quality != Soundtouch_quality::Auto) return quality;
+		return runtime_config::exporting ? Soundtouch_quality::High : Soundtouch_quality::Fast;
+	}
+
+	// 按质量设置SoundTouch的参数
+	// - 序列与搜索窗口为0时由SoundTouch根据速度自动选择
+	static void apply_soundtouch_quality(soundtouch::SoundTouch& soundtouch, Soundtouch_quality quality)
 	{
-		return infra::Processor::Info{
+		const bool fast = resolve_soundtouch_quality(quality) == Soundtouch_quality::Fast;
+
+		soundtouch.setSetting(SETTING_USE_QUICKSEEK, fast ? 1 : 0);
+		soundtouch.setSetting(SETTING_USE_AA_FILTER, fast ? 0 : 1);
+		soundtouch.setSetting(SETTING_SEQUENCE_MS, fast ? 40 : 0);
+		soundtouch.setSetting(SETTING_SEEKWINDOW_MS, fast ? 12 : 0);
+		soundtouch.setSetting(SETTING_OVERLAP_MS, fast ? 6 : 8);
+	}
+
+	const infra::Processor::Info& Velocity_modifier::get_processor_info()
+	{
+		static const infra::Processor::Info info{
 			.identifier = "velocity_modifier",
 			.display_name = "Velocity Modifier",
 			.singleton = false,
@@ -23,12 +120,16 @@ namespace processor
 				"## Functionality\n"
 				"- Adjusts the velocity of audio streams\n"
 				"- Supports pitch preservation with velocity adjustment\n"
-				"- Outputs audio in 48kHz, 32-bit float format\n\n"
+				"- Without pitch preservation, resamples the audio (varispeed), which is much cheaper\n"
+				"- Quality: fast when previewing, high when exporting by default\n"
+				"- Outputs audio at the input sample rate, 32-bit float format\n\n"
 				"## Usage\n"
 				"- Connect audio input streams to the 'Input' pin\n"
 				"- Adjust the velocity multiplier using the slider\n"
 				"- Optionally preserve pitch while modifying velocity",
 		};
+
+		return info;
 	}
 
 	std::vector<infra::Processor::Pin_attribute> Velocity_modifier::get_pin_attributes() const
@@ -59,9 +160,9 @@ namespace processor
 		imgui_utility::shadowed_text("Velocity Modifier");
 	}
 
-	infra::Processor::Info Pitch_modifier::get_processor_info()
+	const infra::Processor::Info& Pitch_modifier::get_processor_info()
 	{
-		return infra::Processor::Info{
+		static const infra::Processor::Info info{
 			.identifier = "pitch_modifier",
 			.display_name = "Pitch Modifier",
 			.singleton = false,
@@ -69,11 +170,14 @@ namespace processor
 			.description = "Audio Pitch Modifier\n\n"
 				"## Functionality\n"
 				"- Adjusts the pitch of audio streams by a specified note value\n"
-				"- Outputs audio in 48kHz, 32-bit float format\n\n"
+				"- Quality: fast when previewing, high when exporting by default\n"
+				"- Outputs audio at the input sample rate, 32-bit float format\n\n"
 				"## Usage\n"
 				"- Connect audio input streams to the 'Input' pin\n"
 				"- Adjust the pitch value using the input field",
 		};
+
+		return info;
 	}
 
 	std::vector<infra::Processor::Pin_attribute> Pitch_modifier::get_pin_attributes() const
@@ -124,6 +228,11 @@ namespace processor
 				);
 
 				ImGui::Checkbox("Keep Pitch", &keep_pitch);
+
+				// 不保持音高时只经过重采样，与SoundTouch质量无关
+				ImGui::BeginDisabled(!keep_pitch);
+				draw_soundtouch_quality_combo(quality);
+				ImGui::EndDisabled();
 			}
 			ImGui::EndDisabled();
 			ImGui::PopItemWidth();
@@ -140,6 +249,7 @@ namespace processor
 			ImGui::BeginDisabled(readonly);
 			{
 				ImGui::InputFloat("Pitch (Note)", &pitch, 0.5, 1.0, "%+.1f");
+				draw_soundtouch_quality_combo(quality);
 			}
 			ImGui::EndDisabled();
 			ImGui::PopItemWidth();
@@ -147,119 +257,38 @@ namespace processor
 		return false;
 	}
 
-	static std::vector<float> extract_samples_interleaved(const AVFrame* frame)
+	// 将一帧推送到所有输出流，输出流已满时让出纤程
+	static void push_to_outputs(
+		const std::set<std::shared_ptr<Audio_stream>>& output_stream,
+		const std::shared_ptr<Audio_frame>& frame,
+		const std::atomic<bool>& stop_token,
+		const std::string& processor_name
+	)
 	{
-		std::vector<float> samples;
-
-		const int channel_count = frame->ch_layout.nb_channels;
-		const int sample_count = frame->nb_samples;
-		const auto sample_format = (AVSampleFormat)frame->format;
-
-		samples.resize(sample_count * channel_count);
-
-		switch (sample_format)
+		for (auto& stream : output_stream)
 		{
-		case AV_SAMPLE_FMT_FLT:
-			std::copy(
-				reinterpret_cast<const float*>(frame->data[0]),
-				reinterpret_cast<const float*>(frame->data[0]) + sample_count * channel_count,
-				samples.data()
-			);
-			break;
-		case AV_SAMPLE_FMT_FLTP:
-			for (int ch = 0; ch < channel_count; ++ch)
+			while (!stop_token)
 			{
-				float* sample_ptr = samples.data() + ch;
+				const auto status = stream->try_push(frame);
 
-				for (int i = 0; i < sample_count; ++i)
+				switch (status)
 				{
-					*sample_ptr = reinterpret_cast<const float*>(frame->data[ch])[i];
-					sample_ptr += channel_count;
-				}
-			}
-			break;
-		case AV_SAMPLE_FMT_S16:
-			std::transform(
-				(const int16_t*)frame->data[0],
-				(const int16_t*)frame->data[0] + sample_count * channel_count,
-				samples.begin(),
-				[](int16_t sample) { return static_cast<float>(sample) / 32768.0f; }
-			);
-			break;
-		case AV_SAMPLE_FMT_S16P:
-			for (int ch = 0; ch < channel_count; ++ch)
-			{
-				float* sample_ptr = samples.data() + ch;
-
-				for (int i = 0; i < sample_count; ++i)
-				{
-					*sample_ptr = (float)reinterpret_cast<const int16_t*>(frame->data[ch])[i]
-								/ std::numeric_limits<int16_t>::max();
-					sample_ptr += channel_count;
+				case boost::fibers::channel_op_status::success:
+					break;
+				case boost::fibers::channel_op_status::full:
+					boost::this_fiber::yield();
+					continue;
+				default:
+					throw infra::Processor::Runtime_error(
+						"Failed to push audio frame to output stream",
+						std::format("{} encountered an error when pushing audio frame.", processor_name),
+						std::format("Channel push error: {}", (int)status)
+					);
 				}
-			}
-			break;
-		case AV_SAMPLE_FMT_S32:
-			std::transform(
-				(const int32_t*)frame->data[0],
-				(const int32_t*)frame->data[0] + sample_count * channel_count,
-				samples.begin(),
-				[](int32_t sample) { return static_cast<float>(sample) / 2147483648.0f; }
-			);
-			break;
-		case AV_SAMPLE_FMT_S32P:
-			for (int ch = 0; ch < channel_count; ++ch)
-			{
-				float* sample_ptr = samples.data() + ch;
 
-				for (int i = 0; i < sample_count; ++i)
-				{
-					*sample_ptr = (double)reinterpret_cast<const int32_t*>(frame->data[ch])[i]
-								/ std::numeric_limits<int32_t>::max();
-					sample_ptr += channel_count;
-				}
+				break;
 			}
-			break;
-		default:
-			throw infra::Processor::Runtime_error(
-				"Unsupported sample format",
-				"The processors do not support the given sample format.",
-				std::format("Sample format: {}", av_get_sample_fmt_name((AVSampleFormat)frame->format))
-			);
 		}
-
-		return samples;
-	}
-
-	static std::shared_ptr<Audio_frame> construct_audio_frame_float(
-		const std::vector<float>& samples,
-		int sample_rate,
-		int channel_count,
-		float time_us
-	)
-	{
-		std::shared_ptr<Audio_frame> new_frame = std::make_shared<Audio_frame>();
-		AVFrame* frame = new_frame->data();
-
-		frame->sample_rate = sample_rate;
-		frame->ch_layout.nb_channels = channel_count;
-		frame->nb_samples = static_cast<int>(samples.size() / channel_count);
-		frame->format = AV_SAMPLE_FMT_FLT;
-		frame->time_base = {.num = 1, .den = 1000000};
-		frame->pts = static_cast<int64_t>(time_us);
-
-		av_frame_make_writable(frame);
-		av_frame_get_buffer(frame, 0);
-		if (frame->data[0] == nullptr)
-			throw infra::Processor::Runtime_error(
-				"Failed to allocate audio frame buffer",
-				"Cannot allocate buffer for audio frame.",
-				"Audio frame data pointer is null"
-			);
-
-		std::ranges::copy(samples, reinterpret_cast<float*>(frame->data[0]));
-
-		return new_frame;
 	}
 
 	static void soundtouch_process_payload(
@@ -268,6 +297,7 @@ namespace processor
 		const std::atomic<bool>& stop_token,
 		float velocity,
 		float pitch,
+		Soundtouch_quality quality,
 		const std::string& processor_name
 	)
 	{
@@ -287,15 +317,26 @@ namespace processor
 
 		bool input_stream_eof = false;
 
-		const double time_ratio = 1.0f / velocity;
+		// 每次取出恰好一块，下游看到的帧长度固定
+		const int block_size = runtime_config::block_size;
 		int channel_count, sample_rate;
-		double time_seconds = 0.0;  // 记录当前帧的时间
+		AVSampleFormat input_format = AV_SAMPLE_FMT_NONE;
+		int64_t next_pts = 0;  // 下一帧的时间戳（采样）
+
+		// 输入不是交错float时，转换到复用的缓冲区；是交错float时直接交给SoundTouch
+		std::unique_ptr<Audio_resampler> interleaver;
+		std::vector<float> interleave_buffer;
+
+		// 输出帧来自缓冲池，SoundTouch直接写入帧的缓冲区
+		std::optional<Audio_frame_pool> frame_pool;
 
 		auto acquire_func = [&](int count)
 		{
-			std::vector<float> output_samples(count * channel_count);
+			const std::shared_ptr<Audio_frame> new_frame = frame_pool->acquire();
+			AVFrame* frame = new_frame->data();
 
-			const int samples_read = soundtouch->receiveSamples(output_samples.data(), count);
+			const auto samples = reinterpret_cast<float*>(frame->data[0]);
+			const int samples_read = soundtouch->receiveSamples(samples, count);
 
 			if (samples_read < 0)
 				throw infra::Processor::Runtime_error(
@@ -304,41 +345,13 @@ namespace processor
 					std::format("Received {} samples, expected at least {}", samples_read, count)
 				);
 
-			output_samples.resize(samples_read * channel_count);
-
-			std::shared_ptr<Audio_frame> new_frame = construct_audio_frame_float(
-				output_samples,
-				sample_rate,
-				channel_count,
-				time_seconds * 1000000
-			);
-
-			time_seconds += double(samples_read) / sample_rate;
-
-			for (auto& stream : output_stream)
-			{
-				while (!stop_token)
-				{
-					const auto status = stream->try_push(new_frame);
+			frame->nb_samples = samples_read;
+			frame->pts = next_pts;
+			frame->time_base = {.num = 1, .den = sample_rate};
 
-					switch (status)
-					{
-					case boost::fibers::channel_op_status::success:
-						break;
-					case boost::fibers::channel_op_status::full:
-						boost::this_fiber::yield();
-						continue;
-					default:
-						throw infra::Processor::Runtime_error(
-							"Failed to push audio frame to output stream",
-							std::format("{} encountered an error when pushing audio frame.", processor_name),
-							std::format("Channel push error: {}", (int)status)
-						);
-					}
+			next_pts += samples_read;
 
-					break;
-				}
-			}
+			push_to_outputs(output_stream, new_frame, stop_token, processor_name);
 		};
 
 		while (!stop_token)
@@ -360,8 +373,6 @@ namespace processor
 				}
 				else
 				{
-					constexpr int max_queued_samples = 65536;
-
 					const AVFrame* frame = pop_result.value()->data();
 
 					if (soundtouch == nullptr)
@@ -383,10 +394,47 @@ namespace processor
 
 						soundtouch->setRate(velocity);
 						soundtouch->setPitch(pitch);
+						apply_soundtouch_quality(*soundtouch, quality);
 
 						channel_count = frame->ch_layout.nb_channels;
-						time_seconds = frame->pts * av_q2d(frame->time_base);
 						sample_rate = frame->sample_rate;
+						input_format = static_cast<AVSampleFormat>(frame->format);
+						const AVRational sample_time_base{.num = 1, .den = sample_rate};
+						if (frame->time_base.num > 0)
+							next_pts = av_rescale_q(frame->pts, frame->time_base, sample_time_base);
+
+						// 部分处理器只填写了声道数，按声道数取默认布局
+						AVChannelLayout layout{};
+						if (frame->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC)
+							av_channel_layout_default(&layout, channel_count);
+						else if (av_channel_layout_copy(&layout, &frame->ch_layout) < 0)
+							throw std::bad_alloc();
+						const Free_utility free_layout(std::bind(av_channel_layout_uninit, &layout));
+
+						const Audio_resampler::Format input_audio_format{
+							.format = input_format,
+							.sample_rate = sample_rate,
+							.channel_layout = layout
+						};
+
+						const Audio_resampler::Format interleaved_format{
+							.format = AV_SAMPLE_FMT_FLT,
+							.sample_rate = sample_rate,
+							.channel_layout = layout
+						};
+
+						auto create_result = Audio_resampler::create(input_audio_format, interleaved_format);
+						if (!create_result.has_value())
+							throw infra::Processor::Runtime_error(
+								"Audio format is not supported",
+								std::format("{} cannot convert the input audio format.", processor_name),
+								std::format("Sample format: {}", av_get_sample_fmt_name(input_format))
+							);
+
+						if (!create_result.value()->is_passthrough())
+							interleaver = std::move(create_result.value());
+
+						frame_pool.emplace(AV_SAMPLE_FMT_FLT, sample_rate, layout, block_size);
 					}
 
 					if (soundtouch == nullptr)
@@ -396,14 +444,42 @@ namespace processor
 							"SoundTouch pointer is null"
 						);
 
-					while (!stop_token && soundtouch->numSamples() > max_queued_samples)
-						boost::this_fiber::yield();
+					if (frame->format != input_format || frame->sample_rate != sample_rate
+						|| frame->ch_layout.nb_channels != channel_count)
+						throw infra::Processor::Runtime_error(
+							"Audio format changed in stream",
+							std::format("{} requires the input format to stay the same.", processor_name),
+							std::format(
+								"Expected {} Hz, {} channels, format {}; got {} Hz, {} channels, format {}",
+								sample_rate,
+								channel_count,
+								(int)input_format,
+								frame->sample_rate,
+								frame->ch_layout.nb_channels,
+								frame->format
+							)
+						);
 
-					const auto samples = extract_samples_interleaved(frame);
-					soundtouch->putSamples(
-						samples.data(),
-						static_cast<int>(samples.size() / frame->ch_layout.nb_channels)
-					);
+					if (interleaver == nullptr)
+					{
+						const auto samples = reinterpret_cast<const float*>(frame->data[0]);
+						soundtouch->putSamples(samples, frame->nb_samples);
+					}
+					else
+					{
+						interleave_buffer.resize(size_t(frame->nb_samples) * channel_count);
+						float* const output_ptr = interleave_buffer.data();
+
+						const int planes = av_sample_fmt_is_planar(input_format) ? channel_count : 1;
+						const int converted = interleaver->resample<uint8_t, float>(
+							std::span<const uint8_t* const>(frame->extended_data, planes),
+							frame->nb_samples,
+							std::span<float* const>(&output_ptr, 1),
+							frame->nb_samples
+						);
+
+						soundtouch->putSamples(interleave_buffer.data(), converted);
+					}
 				}
 			}
 
@@ -413,24 +489,18 @@ namespace processor
 				// 处理完成
 				if (soundtouch->numSamples() == 0 && input_stream_eof) break;
 
-				const uint32_t min_samples = time_ratio * 1152;
-				const uint32_t max_samples = time_ratio * 1152 * 3;
-
-				if (soundtouch->numSamples() > min_samples)
+				// 每写入一帧后取出所有完整的块，速度低于1时输出多于输入，只取一块会使内部队列不断增长
+				if (soundtouch->numSamples() >= uint32_t(block_size))
 				{
-					const int target_sample_count = std::min(soundtouch->numSamples(), max_samples);
-
-					acquire_func(target_sample_count);
+					while (!stop_token && soundtouch->numSamples() >= uint32_t(block_size))
+						acquire_func(block_size);
 				}
 				else if (input_stream_eof)
 				{
+					// 输出剩余采样，最后一块可以不足
 					soundtouch->flush();
-					const int remaining_samples = soundtouch->numSamples();
-
-					if (remaining_samples > 0)
-					{
-						acquire_func(remaining_samples);
-					}
+					while (!stop_token && soundtouch->numSamples() > 0)
+						acquire_func(std::min<int>(soundtouch->numSamples(), block_size));
 
 					break;
 				}
@@ -442,6 +512,126 @@ namespace processor
 		for (auto& stream : output_stream) stream->set_eof();
 	}
 
+	// 不保持音高的变速：把输入当作采样率为 原采样率×速度 的音频，重采样回原采样率
+	// - 与SoundTouch的rate参数效果相同（速度与音高一起改变），但只需一次重采样，开销低得多
+	// - 时间戳按虚拟采样率换算，输出的时间轴随速度缩放
+	static void varispeed_process_payload(
+		const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
+		const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
+		const std::atomic<bool>& stop_token,
+		float velocity,
+		const std::string& processor_name
+	)
+	{
+		const auto input_item = get_input_item<Audio_stream>(input, "input");
+		const auto output_stream = get_output_item<Audio_stream>(output, "output");
+
+		if (!input_item.has_value())
+			throw infra::Processor::Runtime_error(
+				std::format("{} has no input", processor_name),
+				std::format("{} requires an audio stream input to function properly.", processor_name),
+				"Input item 'input' not found"
+			);
+
+		Audio_stream& input_stream = input_item.value().get();
+
+		std::optional<Frame_rechunker> rechunker;
+		int sample_rate = 0;
+		int virtual_sample_rate = 0;
+
+		// 重新标记采样率的帧，只引用输入帧的缓冲区，不复制数据
+		Audio_frame relabelled;
+
+		while (!stop_token)
+		{
+			const auto pop_result = input_stream.try_pop();
+
+			if (!pop_result.has_value())
+			{
+				if (pop_result.error() != boost::fibers::channel_op_status::empty)
+					throw infra::Processor::Runtime_error(
+						"Unexpected error when fetching audio frame",
+						std::format("{} encountered an unexpected error.", processor_name),
+						std::format("Channel fetch error: {}", (int)pop_result.error())
+					);
+
+				if (input_stream.eof()) break;
+
+				boost::this_fiber::yield();
+				continue;
+			}
+
+			const AVFrame* frame = pop_result.value()->data();
+			if (frame->nb_samples <= 0) continue;
+
+			if (!rechunker.has_value())
+			{
+				sample_rate = frame->sample_rate;
+				virtual_sample_rate = int(std::lround(double(sample_rate) * velocity));
+
+				if (sample_rate <= 0 || virtual_sample_rate <= 0)
+					throw infra::Processor::Runtime_error(
+						"Unsupported sample rate",
+						std::format("{} cannot process audio at this sample rate.", processor_name),
+						std::format("Sample rate: {}, velocity: {}", sample_rate, velocity)
+					);
+
+				// 部分处理器只填写了声道数，按声道数取默认布局
+				AVChannelLayout layout{};
+				if (frame->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC)
+					av_channel_layout_default(&layout, frame->ch_layout.nb_channels);
+				else if (av_channel_layout_copy(&layout, &frame->ch_layout) < 0)
+					throw std::bad_alloc();
+				const Free_utility free_layout(std::bind(av_channel_layout_uninit, &layout));
+
+				const Audio_resampler::Format output_format{
+					.format = AV_SAMPLE_FMT_FLT,
+					.sample_rate = sample_rate,
+					.channel_layout = layout
+				};
+
+				rechunker.emplace(runtime_config::block_size, output_format, get_resample_quality());
+			}
+
+			// 重新标记采样率后Frame_rechunker无法察觉原采样率的变化，在此检查
+			if (frame->sample_rate != sample_rate)
+				throw infra::Processor::Runtime_error(
+					"Audio format changed in stream",
+					std::format("{} requires the input format to stay the same.", processor_name),
+					std::format("Expected {} Hz, got {} Hz", sample_rate, frame->sample_rate)
+				);
+
+			AVFrame* const relabelled_frame = relabelled.data();
+			av_frame_unref(relabelled_frame);
+			if (av_frame_ref(relabelled_frame, frame) < 0) throw std::bad_alloc();
+
+			// 时间戳先换算为原采样率下的采样数，再按虚拟采样率解释
+			relabelled_frame->sample_rate = virtual_sample_rate;
+			if (frame->pts != AV_NOPTS_VALUE && frame->time_base.num > 0)
+			{
+				relabelled_frame->pts
+					= av_rescale_q(frame->pts, frame->time_base, {.num = 1, .den = sample_rate});
+				relabelled_frame->time_base = {.num = 1, .den = virtual_sample_rate};
+			}
+
+			rechunker->push(*relabelled_frame);
+			av_frame_unref(relabelled_frame);
+
+			while (!stop_token && rechunker->ready())
+				push_to_outputs(output_stream, rechunker->pop(), stop_token, processor_name);
+		}
+
+		// 取出重采样器中残留的采样，最后一块可以不足
+		if (!stop_token && rechunker.has_value())
+		{
+			rechunker->finish();
+			while (!stop_token && rechunker->ready())
+				push_to_outputs(output_stream, rechunker->pop(), stop_token, processor_name);
+		}
+
+		for (auto& stream : output_stream) stream->set_eof();
+	}
+
 	void Velocity_modifier::process_payload(
 		const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
 		const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
@@ -449,12 +639,20 @@ namespace processor
 		std::any& user_data [[maybe_unused]]
 	)
 	{
+		// 不需要保持音高时，重采样即可实现变速，无需经过SoundTouch
+		if (!keep_pitch)
+		{
+			varispeed_process_payload(input, output, stop_token, velocity, get_processor_info().display_name);
+			return;
+		}
+
 		soundtouch_process_payload(
 			input,
 			output,
 			stop_token,
 			velocity,
-			keep_pitch ? 1 / velocity : 1,
+			1 / velocity,
+			quality,
 			get_processor_info().display_name
 		);
 	}
@@ -472,6 +670,7 @@ namespace processor
 			stop_token,
 			1,
 			std::pow(2.0f, pitch / 12.0f),
+			quality,
 			get_processor_info().display_name
 		);
 	}
@@ -481,6 +680,7 @@ namespace processor
 		Json::Value value;
 		value["velocity"] = velocity;
 		value["keep_pitch"] = keep_pitch;
+		value["quality"] = serialize_soundtouch_quality(quality);
 		return value;
 	}
 
@@ -490,17 +690,37 @@ namespace processor
 			velocity = value["velocity"].asFloat();
 		if (value.isMember("keep_pitch") && value["keep_pitch"].isBool())
 			keep_pitch = value["keep_pitch"].asBool();
+		deserialize_soundtouch_quality(value, quality);
+	}
+
+	std::unique_ptr<infra::Processor> Velocity_modifier::clone() const
+	{
+		auto processor = std::make_unique<Velocity_modifier>();
+		processor->velocity = velocity;
+		processor->keep_pitch = keep_pitch;
+		processor->quality = quality;
+		return processor;
 	}
 
 	Json::Value Pitch_modifier::serialize() const
 	{
 		Json::Value value;
 		value["pitch"] = pitch;
+		value["quality"] = serialize_soundtouch_quality(quality);
 		return value;
 	}
 
 	void Pitch_modifier::deserialize(const Json::Value& value)
 	{
 		if (value.isMember("pitch") && value["pitch"].isDouble()) pitch = value["pitch"].asFloat();
+		deserialize_soundtouch_quality(value, quality);
+	}
+
+	std::unique_ptr<infra::Processor> Pitch_modifier::clone() const
+	{
+		auto processor = std::make_unique<Pitch_modifier>();
+		processor->pitch = pitch;
+		processor->quality = quality;
+		return processor;
 	}
 }
\ No newline at end of file
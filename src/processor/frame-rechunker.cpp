@@ -0,0 +1,252 @@
+#include "processor/frame-rechunker.hpp"
+#include "config.hpp"
+#include "utility/free-utility.hpp"
+
+#include <algorithm>
+#include <format>
+#include <functional>
+#include <span>
+
+namespace processor
+{
+	Audio_resampler::Quality get_resample_quality()
+	{
+		if (runtime_config::exporting) return Audio_resampler::Quality::Export;
+		return Audio_resampler::Quality::Preview;
+	}
+
+	Frame_rechunker::Frame_rechunker(
+		int block_size,
+		std::optional<Audio_resampler::Format> target_format,
+		Audio_resampler::Quality quality
+	) :
+		block_size(block_size),
+		target_format(target_format),
+		quality(quality),
+		fifo(nullptr, av_audio_fifo_free)
+	{
+		if (block_size <= 0) THROW_LOGIC_ERROR("Invalid block size {} for Frame_rechunker", block_size);
+	}
+
+	Frame_rechunker::~Frame_rechunker()
+	{
+		av_channel_layout_uninit(&channel_layout);
+	}
+
+	void Frame_rechunker::initialize(const AVFrame& frame)
+	{
+		input_sample_format = static_cast<AVSampleFormat>(frame.format);
+		input_sample_rate = frame.sample_rate;
+		input_channels = frame.ch_layout.nb_channels;
+
+		// 部分处理器只填写了声道数，按声道数取默认布局
+		AVChannelLayout input_layout{};
+		if (frame.ch_layout.order == AV_CHANNEL_ORDER_UNSPEC)
+			av_channel_layout_default(&input_layout, input_channels);
+		else if (av_channel_layout_copy(&input_layout, &frame.ch_layout) < 0)
+			throw std::bad_alloc();
+		const Free_utility free_input_layout(std::bind(av_channel_layout_uninit, &input_layout));
+
+		if (target_format.has_value())
+		{
+			const Audio_resampler::Format input_format{
+				.format = input_sample_format,
+				.sample_rate = input_sample_rate,
+				.channel_layout = input_layout
+			};
+
+			auto create_result = Audio_resampler::create(input_format, *target_format, quality);
+			if (!create_result.has_value())
+				throw infra::Processor::Runtime_error(
+					"Failed to create audio resampler",
+					"Cannot convert the audio stream to the processing format. Internal error may have "
+					"occurred.",
+					std::format(
+						"Input: {} Hz, {} channels, format {}",
+						input_sample_rate,
+						input_channels,
+						frame.format
+					)
+				);
+
+			// 格式相同时直接写入FIFO，省去一次复制
+			if (!create_result.value()->is_passthrough()) resampler = std::move(create_result.value());
+
+			format = target_format->format;
+			sample_rate = target_format->sample_rate;
+			if (av_channel_layout_copy(&channel_layout, &target_format->channel_layout) < 0)
+				throw std::bad_alloc();
+		}
+		else
+		{
+			format = input_sample_format;
+			sample_rate = input_sample_rate;
+			if (av_channel_layout_copy(&channel_layout, &input_layout) < 0) throw std::bad_alloc();
+		}
+
+		fifo.reset(av_audio_fifo_alloc(format, channel_layout.nb_channels, block_size * 2));
+		if (fifo == nullptr) throw std::bad_alloc();
+
+		// 沿用第一帧的时间戳，之后按采样数连续递增
+		if (frame.pts != AV_NOPTS_VALUE && frame.time_base.num > 0)
+			next_pts = av_rescale_q(frame.pts, frame.time_base, {.num = 1, .den = sample_rate});
+	}
+
+	int Frame_rechunker::write_resampled(const uint8_t* const* data, int sample_count)
+	{
+		const int capacity = resampler->calc_samples(sample_count);
+		if (capacity <= 0) return 0;
+
+		// 暂存区以nb_samples记录容量
+		AVFrame* buffer = resample_buffer.data();
+		if (buffer->nb_samples < capacity)
+		{
+			av_frame_unref(buffer);
+
+			buffer->format = format;
+			buffer->nb_samples = capacity;
+			if (av_channel_layout_copy(&buffer->ch_layout, &channel_layout) < 0) throw std::bad_alloc();
+			if (av_frame_get_buffer(buffer, 0) < 0) throw std::bad_alloc();
+		}
+
+		const size_t input_planes
+			= data == nullptr ? 0 : (av_sample_fmt_is_planar(input_sample_format) ? input_channels : 1);
+		const size_t output_planes = av_sample_fmt_is_planar(format) ? channel_layout.nb_channels : 1;
+
+		const int converted = resampler->resample<uint8_t, uint8_t>(
+			std::span<const uint8_t* const>(data, input_planes),
+			sample_count,
+			std::span<uint8_t* const>(buffer->extended_data, output_planes),
+			capacity
+		);
+
+		if (converted < 0)
+			throw infra::Processor::Runtime_error(
+				"Software resampler failed",
+				"Cannot convert audio sample rate or format. Internal error may have occurred.",
+				std::format("swr_convert() returned error {}", converted)
+			);
+
+		if (converted > 0
+			&& av_audio_fifo_write(fifo.get(), reinterpret_cast<void**>(buffer->extended_data), converted)
+				   < converted)
+			throw std::bad_alloc();
+
+		return converted;
+	}
+
+	void Frame_rechunker::push(const AVFrame& frame)
+	{
+		if (finished) THROW_LOGIC_ERROR("Frame_rechunker::push() called after finish()");
+		if (frame.nb_samples <= 0) return;
+
+		if (fifo == nullptr) initialize(frame);
+
+		if (frame.format != input_sample_format || frame.sample_rate != input_sample_rate
+			|| frame.ch_layout.nb_channels != input_channels)
+			throw infra::Processor::Runtime_error(
+				"Audio format changed in stream",
+				"The sample format, sample rate or channel count of the audio stream changed midway, "
+				"which is not supported.",
+				std::format(
+					"Expected {} Hz, {} channels, format {}; got {} Hz, {} channels, format {}",
+					input_sample_rate,
+					input_channels,
+					(int)input_sample_format,
+					frame.sample_rate,
+					frame.ch_layout.nb_channels,
+					frame.format
+				)
+			);
+
+		if (resampler != nullptr)
+		{
+			write_resampled(frame.extended_data, frame.nb_samples);
+			return;
+		}
+
+		const auto data = reinterpret_cast<void**>(frame.extended_data);
+		if (av_audio_fifo_write(fifo.get(), data, frame.nb_samples) < frame.nb_samples)
+			throw std::bad_alloc();
+	}
+
+	void Frame_rechunker::finish()
+	{
+		if (finished) return;
+
+		// 取出重采样器中残留的采样
+		if (resampler != nullptr)
+			while (write_resampled(nullptr, 0) > 0);
+
+		finished = true;
+	}
+
+	bool Frame_rechunker::fill_from(Audio_stream& stream)
+	{
+		while (!finished && !ready())
+		{
+			const auto pop_result = stream.try_pop();
+
+			if (!pop_result.has_value())
+			{
+				if (pop_result.error() == boost::fibers::channel_op_status::closed)
+					THROW_LOGIC_ERROR("Unexpected channel closed in Frame_rechunker::fill_from");
+
+				if (!stream.eof()) return false;
+
+				finish();
+				break;
+			}
+
+			push(*pop_result.value()->data());
+		}
+
+		return true;
+	}
+
+	int Frame_rechunker::available() const
+	{
+		return fifo == nullptr ? 0 : av_audio_fifo_size(fifo.get());
+	}
+
+	bool Frame_rechunker::ready() const
+	{
+		const int samples = available();
+		return samples >= block_size || (finished && samples > 0);
+	}
+
+	std::shared_ptr<Audio_frame> Frame_rechunker::pop(int pad_to)
+	{
+		if (!ready()) return nullptr;
+
+		const int count = std::min(available(), block_size);
+		const int frame_samples = std::max(count, pad_to);
+
+		const auto block = std::make_shared<Audio_frame>();
+		AVFrame* frame = block->data();
+
+		frame->format = format;
+		frame->sample_rate = sample_rate;
+		frame->nb_samples = frame_samples;
+		frame->pts = next_pts;
+		frame->time_base = {.num = 1, .den = sample_rate};
+		if (av_channel_layout_copy(&frame->ch_layout, &channel_layout) < 0) throw std::bad_alloc();
+		if (av_frame_get_buffer(frame, 0) < 0) throw std::bad_alloc();
+
+		if (av_audio_fifo_read(fifo.get(), reinterpret_cast<void**>(frame->extended_data), count) < count)
+			THROW_LOGIC_ERROR("Frame_rechunker FIFO returned fewer samples than available");
+
+		if (frame_samples > count)
+			av_samples_set_silence(
+				frame->extended_data,
+				count,
+				frame_samples - count,
+				channel_layout.nb_channels,
+				format
+			);
+
+		next_pts += count;
+
+		return block;
+	}
+}
@@ -0,0 +1,297 @@
+#include "processor/null-sink.hpp"
+#include "utility/free-utility.hpp"
+#include "utility/imgui-utility.hpp"
+
+#include <boost/fiber/operations.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <type_traits>
+
+extern "C"
+{
+#include <libavutil/samplefmt.h>
+}
+
+namespace processor
+{
+	static uint64_t get_time_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				   std::chrono::steady_clock::now().time_since_epoch()
+		)
+			.count();
+	}
+
+	// FNV-1a，按8字节为单位处理以提高速度，剩余部分逐字节处理
+	static uint64_t update_checksum(uint64_t hash, const uint8_t* data, size_t size)
+	{
+		constexpr uint64_t prime = 0x100000001b3;
+
+		size_t offset = 0;
+		for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+		{
+			uint64_t word;
+			std::memcpy(&word, data + offset, sizeof(word));
+			hash = (hash ^ word) * prime;
+		}
+
+		for (; offset < size; offset++) hash = (hash ^ data[offset]) * prime;
+
+		return hash;
+	}
+
+	// 统计峰值与平方和，scale把采样换算到[-1, 1]
+	template <typename T>
+	static void accumulate_levels(const T* data, size_t count, double scale, float& peak, double& sum_squares)
+	{
+		float local_peak = peak;
+		double local_sum = 0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			// 无符号8位以128为零点
+			const double value
+				= std::is_same_v<T, uint8_t> ? (double(data[i]) - 128) * scale : double(data[i]) * scale;
+			local_peak = std::max(local_peak, float(std::abs(value)));
+			local_sum += value * value;
+		}
+
+		peak = local_peak;
+		sum_squares += local_sum;
+	}
+
+	const infra::Processor::Info& Null_sink::get_processor_info()
+	{
+		static const infra::Processor::Info info{
+			.identifier = "null_sink",
+			.display_name = "Null Sink",
+			.singleton = false,
+			.generate = std::make_unique<Null_sink>,
+			.description = "Null Sink\n\n"
+						   "## Functionality\n"
+						   "- Consumes an audio stream as fast as possible and discards it\n"
+						   "- Records samples, frames, elapsed time, peak and RMS level\n"
+						   "- Computes a checksum of the raw PCM data to verify bit-exactness\n"
+						   "- Multiple sinks can be placed in the same graph\n\n"
+						   "## Usage\n"
+						   "- Connect an audio stream to the 'Input' pin\n"
+						   "- Run the graph, statistics are shown in the node",
+		};
+
+		return info;
+	}
+
+	std::vector<infra::Processor::Pin_attribute> Null_sink::get_pin_attributes() const
+	{
+		return {
+			{.identifier = "input",
+			 .display_name = "Input",
+			 .type = typeid(Audio_stream),
+			 .is_input = true,
+			 .generate_func = []
+			 {
+				 return std::make_shared<Audio_stream>();
+			 }}
+		};
+	}
+
+	void Null_sink::process_payload(
+		const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
+		const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output
+		[[maybe_unused]],
+		const std::atomic<bool>& stop_token,
+		std::any& user_data [[maybe_unused]]
+	)
+	{
+		const auto input_item_optional = get_input_item<Audio_stream>(input, "input");
+
+		if (!input_item_optional.has_value())
+			throw Runtime_error(
+				"Null sink has no input",
+				"Null sink requires an audio stream input to function properly.",
+				"Input item 'input' not found"
+			);
+
+		auto& input_item = input_item_optional.value().get();
+
+		sample_count = 0;
+		frame_count = 0;
+		peak = 0;
+		sum_squares = 0;
+		checksum = 0xcbf29ce484222325;  // FNV-1a初始值
+		sample_rate = 0;
+		channels = 0;
+		end_time = 0;
+		start_time = get_time_ns();
+
+		// 出错退出时也要记录结束时刻
+		const Free_utility mark_end([this] { end_time = get_time_ns(); });
+
+		float local_peak = 0;
+		double local_sum_squares = 0;
+		uint64_t local_checksum = checksum;
+
+		while (!stop_token)
+		{
+			const auto pop_result = input_item.try_pop();
+
+			if (!pop_result.has_value())
+			{
+				if (pop_result.error() == boost::fibers::channel_op_status::empty)
+				{
+					if (input_item.eof()) break;
+					boost::this_fiber::yield();
+					continue;
+				}
+				else if (pop_result.error() == boost::fibers::channel_op_status::closed)
+					THROW_LOGIC_ERROR("Unexpected channel closed in Null_sink::process_payload");
+			}
+
+			const AVFrame& frame = *pop_result.value()->data();
+			const auto format = static_cast<AVSampleFormat>(frame.format);
+			const int frame_channels = frame.ch_layout.nb_channels;
+
+			if (av_get_bytes_per_sample(format) == 0)
+				throw Runtime_error(
+					"Unsupported sample format",
+					"The null sink does not support the given sample format.",
+					std::format("Sample format: {}", frame.format)
+				);
+
+			// 平面格式每个声道一个数据指针，交错格式所有声道在同一个指针中
+			const bool planar = av_sample_fmt_is_planar(format);
+			const int plane_count = planar ? frame_channels : 1;
+			const size_t plane_samples = size_t(frame.nb_samples) * (planar ? 1 : frame_channels);
+
+			for (int plane = 0; plane < plane_count; plane++)
+			{
+				const uint8_t* data = frame.extended_data[plane];
+
+				local_checksum
+					= update_checksum(local_checksum, data, plane_samples * av_get_bytes_per_sample(format));
+
+				switch (av_get_packed_sample_fmt(format))
+				{
+				case AV_SAMPLE_FMT_U8:
+					accumulate_levels(
+						reinterpret_cast<const uint8_t*>(data),
+						plane_samples,
+						1.0 / 128,
+						local_peak,
+						local_sum_squares
+					);
+					break;
+				case AV_SAMPLE_FMT_S16:
+					accumulate_levels(
+						reinterpret_cast<const int16_t*>(data),
+						plane_samples,
+						1.0 / 32768,
+						local_peak,
+						local_sum_squares
+					);
+					break;
+				case AV_SAMPLE_FMT_S32:
+					accumulate_levels(
+						reinterpret_cast<const int32_t*>(data),
+						plane_samples,
+						1.0 / 2147483648.0,
+						local_peak,
+						local_sum_squares
+					);
+					break;
+				case AV_SAMPLE_FMT_FLT:
+					accumulate_levels(
+						reinterpret_cast<const float*>(data),
+						plane_samples,
+						1.0,
+						local_peak,
+						local_sum_squares
+					);
+					break;
+				case AV_SAMPLE_FMT_DBL:
+					accumulate_levels(
+						reinterpret_cast<const double*>(data),
+						plane_samples,
+						1.0,
+						local_peak,
+						local_sum_squares
+					);
+					break;
+				default:
+					break;
+				}
+			}
+
+			// 单一写入者，直接存储即可
+			peak.store(local_peak, std::memory_order_relaxed);
+			sum_squares.store(local_sum_squares, std::memory_order_relaxed);
+			checksum.store(local_checksum, std::memory_order_relaxed);
+			sample_rate.store(frame.sample_rate, std::memory_order_relaxed);
+			channels.store(frame_channels, std::memory_order_relaxed);
+			frame_count.fetch_add(1, std::memory_order_relaxed);
+			sample_count.fetch_add(frame.nb_samples, std::memory_order_release);
+		}
+	}
+
+	Null_sink::Stats Null_sink::get_stats() const
+	{
+		const uint64_t start = start_time.load();
+		const uint64_t end = end_time.load();
+		const uint64_t samples = sample_count.load(std::memory_order_acquire);
+		const int channel_count = channels.load(std::memory_order_relaxed);
+
+		const double wall_time
+			= start == 0 ? 0.0 : double((end == 0 ? get_time_ns() : end) - start) / 1'000'000'000.0;
+		const double total_samples = double(samples) * channel_count;
+		const double rms
+			= total_samples > 0 ? std::sqrt(sum_squares.load(std::memory_order_relaxed) / total_samples) : 0.0;
+
+		return Stats{
+			.samples = samples,
+			.frames = frame_count.load(std::memory_order_relaxed),
+			.wall_time = wall_time,
+			.peak = peak.load(std::memory_order_relaxed),
+			.rms = rms,
+			.checksum = checksum.load(std::memory_order_relaxed),
+			.sample_rate = sample_rate.load(std::memory_order_relaxed),
+			.channels = channel_count,
+			.running = start != 0 && end == 0
+		};
+	}
+
+	void Null_sink::draw_title()
+	{
+		imgui_utility::shadowed_text("Null Sink");
+	}
+
+	bool Null_sink::draw_content(bool readonly [[maybe_unused]])
+	{
+		ImGui::Separator();
+		if (ImGui::CollapsingHeader("Statistics", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			const auto stats = get_stats();
+
+			// 线性幅度转换为dBFS
+			const auto to_db = [](double value)
+			{ return value > 0 ? 20 * std::log10(value) : -std::numeric_limits<double>::infinity(); };
+
+			const double audio_time = stats.sample_rate > 0 ? double(stats.samples) / stats.sample_rate : 0.0;
+
+			ImGui::BeginGroup();
+			ImGui::Text("State: %s", stats.running ? "Running" : (stats.wall_time > 0 ? "Finished" : "Idle"));
+			ImGui::Text("Samples: %llu (%.2f s)", (unsigned long long)stats.samples, audio_time);
+			ImGui::Text("Frames: %llu", (unsigned long long)stats.frames);
+			ImGui::Text("Wall Time: %.3f s", stats.wall_time);
+			ImGui::Text("Realtime Factor: %.1fx", stats.wall_time > 0 ? audio_time / stats.wall_time : 0.0);
+			ImGui::Text("Peak: %.2f dBFS", to_db(stats.peak));
+			ImGui::Text("RMS: %.2f dBFS", to_db(stats.rms));
+			ImGui::Text("Checksum: %016llx", (unsigned long long)stats.checksum);
+			ImGui::EndGroup();
+		}
+
+		return false;
+	}
+}
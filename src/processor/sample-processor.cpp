@@ -0,0 +1,208 @@
+#include "processor/sample-processor.hpp"
+#include "config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <boost/fiber/operations.hpp>
+#include <format>
+#include <iterator>
+
+namespace processor
+{
+	std::vector<infra::Processor::Pin_attribute> Sample_processor::get_pin_attributes() const
+	{
+		return {
+			{.identifier = "output",
+			 .display_name = "Output",
+			 .type = typeid(Audio_stream),
+			 .is_input = false,
+			 .generate_func =
+				 []
+			 {
+				 return std::make_shared<Audio_stream>();
+			 }},
+			{.identifier = "input",
+			 .display_name = "Input",
+			 .type = typeid(Audio_stream),
+			 .is_input = true,
+			 .generate_func = []
+			 {
+				 return std::make_shared<Audio_stream>();
+			 }}
+		};
+	}
+
+	void Sample_processor::process_payload(
+		const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input,
+		const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
+		const std::atomic<bool>& stop_token,
+		std::any& user_data [[maybe_unused]]
+	)
+	{
+		const auto& processor_name = get_processor_info_non_static().display_name;
+
+		const auto input_item_optional = get_input_item<Audio_stream>(input, "input");
+		const auto output_item = get_output_item<Audio_stream>(output, "output");
+
+		if (!input_item_optional.has_value())
+			throw Runtime_error(
+				std::format("{} has no input", processor_name),
+				std::format("{} requires an audio stream input to function properly.", processor_name),
+				"Input item 'input' not found"
+			);
+
+		auto& input_item = input_item_optional.value().get();
+
+		const std::vector<Sample_kernel> kernels = get_sample_kernels();
+
+		auto push_frame = [&stop_token, &output_item](const std::shared_ptr<Audio_frame>& frame)
+		{
+			for (auto& channel : output_item)
+			{
+				if (stop_token) return;
+
+				while (channel->try_push(frame) != boost::fibers::channel_op_status::success)
+				{
+					if (stop_token) return;
+					boost::this_fiber::yield();
+				}
+			}
+		};
+
+		while (!stop_token)
+		{
+			const auto pop_result = input_item.try_pop();
+
+			if (!pop_result.has_value())
+			{
+				if (pop_result.error() == boost::fibers::channel_op_status::empty)
+				{
+					if (input_item.eof()) break;
+					boost::this_fiber::yield();
+					continue;
+				}
+				else if (pop_result.error() == boost::fibers::channel_op_status::closed)
+					THROW_LOGIC_ERROR("Unexpected channel closed in Sample_processor::process_payload");
+			}
+
+			const auto& src_frame = *pop_result.value()->data();
+			const auto format = static_cast<AVSampleFormat>(src_frame.format);
+			const int frame_channels = src_frame.ch_layout.nb_channels;
+
+			if (frame_channels != 1 && frame_channels != 2)
+				throw Runtime_error(
+					"Invalid channel count",
+					"Only mono and stereo audio are supported.",
+					std::format("Got {} channels", frame_channels)
+				);
+
+			switch (av_get_packed_sample_fmt(format))
+			{
+			case AV_SAMPLE_FMT_FLT:
+			case AV_SAMPLE_FMT_S16:
+			case AV_SAMPLE_FMT_S32:
+				break;
+			default:
+				throw Runtime_error(
+					"Audio format is not support",
+					std::format("{} requires an audio format properly.", processor_name),
+					"Include FLT, S16, S32"
+				);
+			}
+
+			const std::shared_ptr<Audio_frame> dst_frame = std::make_shared<Audio_frame>();
+			AVFrame* out_frame = dst_frame->data();
+
+			out_frame->sample_rate = src_frame.sample_rate;
+			out_frame->format = src_frame.format;
+			out_frame->nb_samples = src_frame.nb_samples;
+			out_frame->ch_layout = src_frame.ch_layout;
+			out_frame->pts = src_frame.pts;
+			out_frame->time_base = src_frame.time_base;
+
+			if (av_frame_get_buffer(out_frame, 32) < 0) throw std::bad_alloc();
+
+			av_samples_copy(
+				out_frame->data,
+				src_frame.data,
+				0,
+				0,
+				src_frame.nb_samples,
+				frame_channels,
+				format
+			);
+
+			// 分块依次执行所有内核，每一块在执行完所有内核前都留在缓存中
+			const bool planar = av_sample_fmt_is_planar(format);
+			const int plane_count = planar ? frame_channels : 1;
+			const int element_count = src_frame.nb_samples * (planar ? 1 : frame_channels);
+			const int bytes_per_sample = av_get_bytes_per_sample(format);
+
+			constexpr int chunk_size = config::processor::sample_processor::chunk_size;
+
+			for (int offset = 0; offset < element_count; offset += chunk_size)
+			{
+				const int count = std::min(chunk_size, element_count - offset);
+
+				std::array<uint8_t*, AV_NUM_DATA_POINTERS> chunk_data{};
+				for (int plane = 0; plane < plane_count; plane++)
+					chunk_data[plane] = out_frame->data[plane] + size_t(offset) * bytes_per_sample;
+
+				for (const auto& kernel : kernels) kernel(format, chunk_data.data(), plane_count, count);
+			}
+
+			push_frame(dst_frame);
+		}
+
+		for (auto& channel : output_item) channel->set_eof();
+	}
+
+	std::shared_ptr<infra::Processor> Sample_processor::fuse(const infra::Processor& next) const
+	{
+		const auto next_processor = dynamic_cast<const Sample_processor*>(&next);
+		if (next_processor == nullptr) return nullptr;
+
+		std::vector<Sample_kernel> kernels = get_sample_kernels();
+		std::ranges::copy(next_processor->get_sample_kernels(), std::back_inserter(kernels));
+
+		// 已经融合过的处理器保留原有的名称列表
+		const auto get_names = [](const Sample_processor& processor)
+		{
+			const auto fused = dynamic_cast<const Fused_sample_processor*>(&processor);
+			if (fused != nullptr) return fused->get_names();
+			return std::vector{processor.get_processor_info_non_static().display_name};
+		};
+
+		std::vector<std::string> names = get_names(*this);
+		std::ranges::copy(get_names(*next_processor), std::back_inserter(names));
+
+		return std::make_shared<Fused_sample_processor>(std::move(kernels), std::move(names));
+	}
+
+	const infra::Processor::Info& Fused_sample_processor::get_processor_info()
+	{
+		static const infra::Processor::Info info{
+			.identifier = "fused_sample_processor",
+			.display_name = "Fused Processor",
+			.singleton = false,
+			.generate = nullptr,
+			.description = "Chain of sample-wise processors fused by the runner",
+		};
+
+		return info;
+	}
+
+	Fused_sample_processor::Fused_sample_processor(
+		std::vector<Sample_kernel> kernels,
+		std::vector<std::string> names
+	) :
+		kernels(std::move(kernels)),
+		names(std::move(names)),
+		info(get_processor_info())
+	{
+		// 显示为"Adjust Volume + Adjust Volume"，错误信息中可以看出原来的处理器
+		info.display_name.clear();
+		for (const auto& name : this->names)
+			info.display_name += info.display_name.empty() ? name : std::format(" + {}", name);
+	}
+}
@@ -0,0 +1,363 @@
+#include "processor/signal-generator.hpp"
+#include "config.hpp"
+#include "utility/imgui-utility.hpp"
+
+#include <algorithm>
+#include <boost/fiber/operations.hpp>
+#include <cmath>
+#include <numbers>
+#include <random>
+
+extern "C"
+{
+#include <libavutil/channel_layout.h>
+}
+
+namespace processor
+{
+	static constexpr Signal_generator::Waveform waveform_list[] = {
+		Signal_generator::Waveform::Sine,
+		Signal_generator::Waveform::White_noise,
+		Signal_generator::Waveform::Pink_noise,
+		Signal_generator::Waveform::Impulse,
+		Signal_generator::Waveform::Silence
+	};
+
+	std::string_view get_waveform_name(Signal_generator::Waveform waveform)
+	{
+		switch (waveform)
+		{
+		case Signal_generator::Waveform::Sine:
+			return "Sine";
+		case Signal_generator::Waveform::White_noise:
+			return "White Noise";
+		case Signal_generator::Waveform::Pink_noise:
+			return "Pink Noise";
+		case Signal_generator::Waveform::Impulse:
+			return "Impulse";
+		case Signal_generator::Waveform::Silence:
+			return "Silence";
+		}
+
+		return "Unknown";
+	}
+
+	// 序列化时使用的标识名
+	static std::string_view get_waveform_identifier(Signal_generator::Waveform waveform)
+	{
+		switch (waveform)
+		{
+		case Signal_generator::Waveform::Sine:
+			return "sine";
+		case Signal_generator::Waveform::White_noise:
+			return "white_noise";
+		case Signal_generator::Waveform::Pink_noise:
+			return "pink_noise";
+		case Signal_generator::Waveform::Impulse:
+			return "impulse";
+		case Signal_generator::Waveform::Silence:
+			return "silence";
+		}
+
+		return "unknown";
+	}
+
+	const infra::Processor::Info& Signal_generator::get_processor_info()
+	{
+		static const infra::Processor::Info info{
+			.identifier = "signal_generator",
+			.display_name = "Signal Generator",
+			.singleton = false,
+			.generate = std::make_unique<Signal_generator>,
+			.description = "Synthetic Signal Generator\n\n"
+						   "## Functionality\n"
+						   "- Generates sine waves, white/pink noise, impulses or silence\n"
+						   "- Configurable duration, sample rate and channel count\n"
+						   "- Output is deterministic, noise repeats every second\n"
+						   "- Outputs audio in 32-bit float format\n\n"
+						   "## Usage\n"
+						   "- Select the waveform and adjust its parameters\n"
+						   "- Connect the 'Output' pin to other audio processors or outputs\n"
+						   "- Useful for testing and benchmarking without audio files",
+		};
+
+		return info;
+	}
+
+	std::vector<infra::Processor::Pin_attribute> Signal_generator::get_pin_attributes() const
+	{
+		return {
+			{.identifier = "output",
+			 .display_name = "Output",
+			 .type = typeid(Audio_stream),
+			 .is_input = false,
+			 .generate_func =
+				 []
+			 {
+				 return std::make_shared<Audio_stream>();
+			 }}
+		};
+	}
+
+	std::vector<float> Signal_generator::generate_table() const
+	{
+		const size_t table_frames = size_t(sample_rate) * config::processor::signal_generator::table_seconds;
+		std::vector<float> table(table_frames * channels, 0.0f);
+
+		switch (waveform)
+		{
+		case Waveform::Sine:
+		{
+			// 频率取整到采样表长度的整数个周期，使采样表首尾相接
+			const double cycles
+				= std::round(double(frequency) * config::processor::signal_generator::table_seconds);
+
+			for (size_t i = 0; i < table_frames; i++)
+			{
+				const double phase = 2 * std::numbers::pi * cycles * double(i) / double(table_frames);
+				const float value = amplitude * float(std::sin(phase));
+				std::fill_n(table.begin() + i * channels, channels, value);
+			}
+			break;
+		}
+		case Waveform::White_noise:
+		case Waveform::Pink_noise:
+		{
+			// 固定种子，保证每次运行的输出相同
+			std::mt19937 engine(0x6E6F6465);
+			std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+			for (int ch = 0; ch < channels; ch++)
+			{
+				// Paul Kellet的粉红噪声滤波器（简化版）
+				float b0 = 0, b1 = 0, b2 = 0;
+
+				for (size_t i = 0; i < table_frames; i++)
+				{
+					const float white = distribution(engine);
+					float value = white;
+
+					if (waveform == Waveform::Pink_noise)
+					{
+						b0 = 0.99765f * b0 + white * 0.0990460f;
+						b1 = 0.96300f * b1 + white * 0.2965164f;
+						b2 = 0.57000f * b2 + white * 1.0526913f;
+						value = b0 + b1 + b2 + white * 0.1848f;
+					}
+
+					table[i * channels + ch] = value;
+				}
+			}
+
+			// 归一化到指定的峰值幅度
+			const float peak = std::abs(std::ranges::max(table, {}, [](float value) { return std::abs(value); }));
+			if (peak > 0)
+				for (auto& value : table) value *= amplitude / peak;
+			break;
+		}
+		case Waveform::Impulse:
+			std::fill_n(table.begin(), channels, amplitude);
+			break;
+		case Waveform::Silence:
+			break;
+		}
+
+		return table;
+	}
+
+	void Signal_generator::process_payload(
+		const std::map<std::string, std::shared_ptr<infra::Processor::Product>>& input [[maybe_unused]],
+		const std::map<std::string, std::set<std::shared_ptr<infra::Processor::Product>>>& output,
+		const std::atomic<bool>& stop_token,
+		std::any& user_data [[maybe_unused]]
+	)
+	{
+		const auto output_item = get_output_item<Audio_stream>(output, "output");
+
+		if (channels != 1 && channels != 2)
+			throw Runtime_error(
+				"Invalid channel count",
+				"Only mono and stereo audio are supported.",
+				std::format("Got {} channels", channels)
+			);
+
+		const std::vector<float> table = generate_table();
+		const size_t table_frames = table.size() / channels;
+		const int64_t total_frames = int64_t(double(duration) * sample_rate);
+
+		AVChannelLayout layout;
+		av_channel_layout_default(&layout, channels);
+
+		auto push_frame = [&stop_token, &output_item](const std::shared_ptr<Audio_frame>& frame)
+		{
+			for (auto& channel : output_item)
+			{
+				if (stop_token) return;
+
+				while (channel->try_push(frame) != boost::fibers::channel_op_status::success)
+				{
+					if (stop_token) return;
+					boost::this_fiber::yield();
+				}
+			}
+		};
+
+		const int block_size = runtime_config::block_size;
+		int64_t sample_index = 0;
+		size_t table_position = 0;
+
+		while (!stop_token && sample_index < total_frames)
+		{
+			const int frame_samples
+				= static_cast<int>(std::min<int64_t>(block_size, total_frames - sample_index));
+
+			const std::shared_ptr<Audio_frame> new_frame = std::make_shared<Audio_frame>();
+			AVFrame* frame = new_frame->data();
+
+			frame->format = AV_SAMPLE_FMT_FLT;
+			frame->sample_rate = sample_rate;
+			frame->nb_samples = frame_samples;
+			frame->pts = sample_index;
+			frame->time_base = {.num = 1, .den = sample_rate};
+			frame->ch_layout = layout;
+			if (av_frame_get_buffer(frame, 0) < 0) throw std::bad_alloc();
+
+			// 从采样表中复制，到达表尾时回绕
+			float* dst = reinterpret_cast<float*>(frame->data[0]);
+			for (size_t remaining = frame_samples; remaining > 0;)
+			{
+				const size_t count = std::min(remaining, table_frames - table_position);
+				dst = std::copy_n(table.begin() + table_position * channels, count * channels, dst);
+
+				remaining -= count;
+				table_position = (table_position + count) % table_frames;
+			}
+
+			sample_index += frame_samples;
+
+			push_frame(new_frame);
+		}
+
+		for (auto& channel : output_item) channel->set_eof();
+	}
+
+	Json::Value Signal_generator::serialize() const
+	{
+		Json::Value value;
+		value["waveform"] = std::string(get_waveform_identifier(waveform));
+		value["frequency"] = frequency;
+		value["amplitude"] = amplitude;
+		value["duration"] = duration;
+		value["sample_rate"] = sample_rate;
+		value["channels"] = channels;
+		return value;
+	}
+
+	void Signal_generator::deserialize(const Json::Value& value)
+	{
+		if (value.isMember("waveform") && value["waveform"].isString())
+		{
+			const auto identifier = value["waveform"].asString();
+			const auto find = std::ranges::find(waveform_list, identifier, get_waveform_identifier);
+			if (find != std::end(waveform_list)) waveform = *find;
+		}
+
+		if (value.isMember("frequency") && value["frequency"].isNumeric())
+			frequency = value["frequency"].asFloat();
+		if (value.isMember("amplitude") && value["amplitude"].isNumeric())
+			amplitude = std::clamp(value["amplitude"].asFloat(), 0.0f, 1.0f);
+		if (value.isMember("duration") && value["duration"].isNumeric())
+			duration = std::clamp(
+				value["duration"].asFloat(),
+				0.0f,
+				config::processor::signal_generator::max_duration
+			);
+		if (value.isMember("sample_rate") && value["sample_rate"].isInt())
+			sample_rate = std::clamp(value["sample_rate"].asInt(), 8000, 192000);
+		if (value.isMember("channels") && value["channels"].isInt())
+			channels = std::clamp(value["channels"].asInt(), 1, 2);
+	}
+
+	std::unique_ptr<infra::Processor> Signal_generator::clone() const
+	{
+		auto processor = std::make_unique<Signal_generator>();
+		processor->waveform = waveform;
+		processor->frequency = frequency;
+		processor->amplitude = amplitude;
+		processor->duration = duration;
+		processor->sample_rate = sample_rate;
+		processor->channels = channels;
+		return processor;
+	}
+
+	void Signal_generator::draw_title()
+	{
+		imgui_utility::shadowed_text("Signal Generator");
+	}
+
+	bool Signal_generator::draw_content(bool readonly)
+	{
+		ImGui::Separator();
+		if (ImGui::CollapsingHeader("Properties", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			ImGui::PushItemWidth(200);
+			ImGui::BeginDisabled(readonly);
+			{
+				if (ImGui::BeginCombo("Waveform", get_waveform_name(waveform).data()))
+				{
+					for (const auto item : waveform_list)
+					{
+						const bool is_selected = (item == waveform);
+						if (ImGui::Selectable(get_waveform_name(item).data(), is_selected)) waveform = item;
+						if (is_selected) ImGui::SetItemDefaultFocus();
+					}
+
+					ImGui::EndCombo();
+				}
+
+				if (waveform == Waveform::Sine)
+					ImGui::DragFloat(
+						"Frequency",
+						&frequency,
+						1,
+						1,
+						float(sample_rate) / 2,
+						"%.0f Hz",
+						ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic
+					);
+
+				if (waveform != Waveform::Silence)
+					ImGui::SliderFloat("Amplitude", &amplitude, 0.0f, 1.0f, "%.2f");
+
+				ImGui::DragFloat(
+					"Duration",
+					&duration,
+					0.1,
+					0.0,
+					config::processor::signal_generator::max_duration,
+					"%.1f s",
+					ImGuiSliderFlags_AlwaysClamp
+				);
+
+				if (ImGui::BeginCombo("Sample Rate", std::format("{} Hz", sample_rate).c_str()))
+				{
+					for (const auto preset : config::processor::signal_generator::sample_rate_presets)
+					{
+						const bool is_selected = (preset == sample_rate);
+						if (ImGui::Selectable(std::format("{} Hz", preset).c_str(), is_selected))
+							sample_rate = preset;
+						if (is_selected) ImGui::SetItemDefaultFocus();
+					}
+
+					ImGui::EndCombo();
+				}
+
+				ImGui::SliderInt("Channels", &channels, 1, 2);
+			}
+			ImGui::EndDisabled();
+			ImGui::PopItemWidth();
+		}
+
+		return false;
+	}
+}
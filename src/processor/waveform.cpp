@@ -0,0 +1,256 @@
+#include "processor/waveform.hpp"
+#include "processor/frame-rechunker.hpp"
+#include "utility/free-utility.hpp"
+#include "utility/logic-error-utility.hpp"
+#include "utility/system.hpp"
+#include "utility/wav-reader.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <source_location>
+#include <stdexcept>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+}
+
+namespace processor
+{
+	// 解码时每次写入生成器的帧数
+	static constexpr size_t decode_chunk_frames = 4096;
+
+	// 无压缩WAV直接从映射的data块读取
+	// - 返回采样率，被停止时返回std::nullopt
+	static std::optional<int> decode_wav(
+		Wav_reader& reader,
+		Peak_pyramid::Builder& builder,
+		std::atomic<float>& progress,
+		const std::stop_token& stop_token
+	)
+	{
+		const auto& format = reader.get_format();
+		const size_t total_frames = reader.total_frames();
+
+		std::vector<float> buffer(decode_chunk_frames * format.channels);
+
+		while (!stop_token.stop_requested())
+		{
+			const size_t frames = reader.read_interleaved(buffer.data(), decode_chunk_frames);
+			if (frames == 0) return format.sample_rate;
+
+			builder.push(std::span(buffer).first(frames * format.channels), format.channels);
+			const float ratio = float(builder.get_total_frames()) / float(total_frames);
+			progress.store(ratio, std::memory_order_relaxed);
+		}
+
+		return std::nullopt;
+	}
+
+	// 其他格式经过libavformat/libavcodec解码，转换为交错float后写入生成器
+	// - 返回采样率，文件无法解码或被停止时返回std::nullopt
+	// - 个别损坏的包被跳过，只影响波形中的一小段
+	static std::optional<int> decode_file(
+		const std::string& file_path,
+		Peak_pyramid::Builder& builder,
+		std::atomic<float>& progress,
+		const std::stop_token& stop_token
+	)
+	{
+		AVFormatContext* format_context = nullptr;
+		if (avformat_open_input(&format_context, file_path.c_str(), nullptr, nullptr) < 0)
+			return std::nullopt;
+		const Free_utility free_format_context(std::bind(avformat_close_input, &format_context));
+
+		if (avformat_find_stream_info(format_context, nullptr) < 0) return std::nullopt;
+
+		const int audio_index = av_find_best_stream(format_context, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+		if (audio_index < 0) return std::nullopt;
+
+		AVStream* const audio_stream = format_context->streams[audio_index];
+		const AVCodec* codec = avcodec_find_decoder(audio_stream->codecpar->codec_id);
+		if (!codec) return std::nullopt;
+
+		AVCodecContext* codec_context = avcodec_alloc_context3(codec);
+		if (!codec_context) throw std::bad_alloc();
+		const Free_utility free_codec_context(std::bind(avcodec_free_context, &codec_context));
+
+		if (avcodec_parameters_to_context(codec_context, audio_stream->codecpar) < 0) return std::nullopt;
+		if (avcodec_open2(codec_context, codec, nullptr) < 0) return std::nullopt;
+		if (codec_context->sample_rate <= 0 || codec_context->ch_layout.nb_channels <= 0) return std::nullopt;
+
+		AVPacket* packet = av_packet_alloc();
+		if (packet == nullptr) throw std::bad_alloc();
+		const Free_utility free_packet(std::bind(av_packet_free, &packet));
+
+		// 估计总帧数用于显示进度，容器没有记录时长时进度保持为0
+		double duration = 0;
+		if (audio_stream->duration != AV_NOPTS_VALUE)
+			duration = double(audio_stream->duration) * av_q2d(audio_stream->time_base);
+		else if (format_context->duration != AV_NOPTS_VALUE)
+			duration = double(format_context->duration) / AV_TIME_BASE;
+		const double expected_frames = duration * codec_context->sample_rate;
+
+		// 解码输出的采样格式各不相同，统一转换为交错float，保持原有的采样率与声道数
+		AVChannelLayout layout;
+		av_channel_layout_default(&layout, codec_context->ch_layout.nb_channels);
+
+		Frame_rechunker rechunker(
+			static_cast<int>(decode_chunk_frames),
+			Audio_resampler::Format{
+				.format = AV_SAMPLE_FMT_FLT,
+				.sample_rate = codec_context->sample_rate,
+				.channel_layout = layout
+			}
+		);
+		Audio_frame decoded_frame;
+
+		const auto push_ready_blocks = [&]
+		{
+			while (rechunker.ready())
+			{
+				const auto block = rechunker.pop();
+				const AVFrame& frame = **block;
+				const int channels = frame.ch_layout.nb_channels;
+
+				const auto* samples = reinterpret_cast<const float*>(frame.data[0]);
+				builder.push(std::span(samples, size_t(frame.nb_samples) * channels), channels);
+			}
+
+			if (expected_frames > 0)
+			{
+				const double ratio = double(builder.get_total_frames()) / expected_frames;
+				progress.store(float(std::min(ratio, 1.0)), std::memory_order_relaxed);
+			}
+		};
+
+		// 取出解码器中所有可用的帧，解码出错时返回false
+		const auto receive_frames = [&]
+		{
+			while (true)
+			{
+				const int result = avcodec_receive_frame(codec_context, decoded_frame.data());
+				if (result == AVERROR(EAGAIN) || result == AVERROR_EOF) return true;
+				if (result < 0) return false;
+
+				rechunker.push(*decoded_frame);
+				push_ready_blocks();
+			}
+		};
+
+		while (av_read_frame(format_context, packet) >= 0)
+		{
+			const Free_utility unref_packet(std::bind(av_packet_unref, packet));
+			if (stop_token.stop_requested()) return std::nullopt;
+			if (packet->stream_index != audio_index) continue;  // 跳过非音频流
+
+			const int send_result = avcodec_send_packet(codec_context, packet);
+			if (send_result < 0 && send_result != AVERROR_INVALIDDATA) return std::nullopt;
+
+			if (!receive_frames()) return std::nullopt;
+		}
+
+		// 冲刷解码器中剩余的帧
+		avcodec_send_packet(codec_context, nullptr);
+		if (!receive_frames()) return std::nullopt;
+
+		rechunker.finish();
+		push_ready_blocks();
+
+		return codec_context->sample_rate;
+	}
+
+	Waveform::Waveform(std::string file_path) :
+		file_path(std::move(file_path))
+	{
+		thread = std::jthread([this](std::stop_token stop_token) { load(stop_token); });
+	}
+
+	const Peak_pyramid& Waveform::get_pyramid() const
+	{
+		if (status.load() != Status::Ready) THROW_LOGIC_ERROR("Waveform pyramid accessed before it is ready");
+		return *pyramid;
+	}
+
+	std::span<const Peak_pyramid::Peak> Waveform::get_peaks(int width)
+	{
+		const auto& pyramid = get_pyramid();
+
+		if (cached_peaks.size() != size_t(width))
+		{
+			cached_peaks.resize(width);
+			pyramid.query(0, double(pyramid.get_total_frames()) / width, cached_peaks);
+		}
+
+		return cached_peaks;
+	}
+
+	std::string Waveform::get_cache_path(const std::string& file_path)
+	{
+		// 以规范化的绝对路径作为键，同一文件从不同的相对路径打开时共用缓存
+		std::error_code error;
+		const auto absolute_path = std::filesystem::absolute(file_path, error);
+		const std::string key = error ? file_path : absolute_path.lexically_normal().string();
+
+		// FNV-1a 64位
+		uint64_t hash = 0xcbf29ce484222325;
+		for (const unsigned char c : key)
+		{
+			hash ^= c;
+			hash *= 0x100000001b3;
+		}
+
+		const auto cache_path = std::filesystem::path(get_cache_directory()) / "waveform"
+							  / std::format("{:016x}.peaks", hash);
+		return cache_path.string();
+	}
+
+	void Waveform::load(std::stop_token stop_token)
+	try
+	{
+		const auto source = Peak_pyramid::get_source_info(file_path);
+		if (!source.has_value())
+		{
+			status = Status::Failed;
+			return;
+		}
+
+		// 缓存有效时只需要映射缓存文件
+		const auto cache_path = get_cache_path(file_path);
+		if (auto cached = Peak_pyramid::open(cache_path, *source); cached.has_value())
+		{
+			pyramid = std::move(cached);
+			status = Status::Ready;
+			return;
+		}
+
+		Peak_pyramid::Builder builder;
+		std::optional<int> sample_rate;
+
+		if (auto wav_reader = Wav_reader::open(file_path); wav_reader.has_value())
+			sample_rate = decode_wav(*wav_reader, builder, progress, stop_token);
+		else
+			sample_rate = decode_file(file_path, builder, progress, stop_token);
+
+		if (!sample_rate.has_value())
+		{
+			status = Status::Failed;
+			return;
+		}
+
+		// 同一文件的另一个波形可能同时写入了缓存（Windows下无法覆盖已被映射的文件），
+		// 写入失败时仍然尝试打开已有的缓存
+		builder.write(cache_path, *source, *sample_rate);
+
+		pyramid = Peak_pyramid::open(cache_path, *source);
+		status = pyramid.has_value() ? Status::Ready : Status::Failed;
+	}
+	catch (const std::exception&)
+	{
+		status = Status::Failed;
+	}
+}
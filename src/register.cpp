@@ -8,6 +8,8 @@
 #include "processor/audio-io.hpp"
 #include "processor/audio-velocity.hpp"
 #include "processor/audio-vol.hpp"
+#include "processor/null-sink.hpp"
+#include "processor/signal-generator.hpp"
 
 namespace infra
 {
@@ -21,5 +23,7 @@ namespace infra
 		Processor::register_processor<processor::Audio_amix>();
 		Processor::register_processor<processor::Audio_bimix>();
 		Processor::register_processor<processor::Audio_bimix_v2>();
+		Processor::register_processor<processor::Signal_generator>();
+		Processor::register_processor<processor::Null_sink>();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "utility/audio-device.hpp"
+
+#include <SDL_timer.h>
+#include <algorithm>
+
+Audio_device::Audio_device(int requested_buffer_size, int sample_rate) :
+	requested_buffer_size(requested_buffer_size),
+	buffer_size(requested_buffer_size),
+	sample_rate(sample_rate),
+	ring_buffer(size_t(config::audio::ring_buffer_frames) * config::audio::channels)
+{
+}
+
+Audio_device::~Audio_device()
+{
+	if (device_id >= 2) SDL_CloseAudioDevice(device_id);
+}
+
+std::optional<std::unique_ptr<Audio_device>> Audio_device::open(int buffer_size, int sample_rate)
+{
+	std::unique_ptr<Audio_device> device(new Audio_device(buffer_size, sample_rate));
+
+	SDL_AudioSpec desired_spec = {
+		.freq = sample_rate,
+		.format = config::audio::buffer_format,
+		.channels = config::audio::channels,
+		.silence = 0,
+		.samples = Uint16(buffer_size),
+		.padding = 0,
+		.size = 0,
+		.callback = audio_callback,
+		.userdata = device.get(),
+	};
+
+	// 只允许调整缓冲区大小，采样率与格式不符时由SDL转换
+	SDL_AudioSpec obtained_spec;
+	device->device_id
+		= SDL_OpenAudioDevice(nullptr, false, &desired_spec, &obtained_spec, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+	if (device->device_id < 2) return std::nullopt;
+
+	device->buffer_size = obtained_spec.samples;
+
+	return device;
+}
+
+void SDLCALL Audio_device::audio_callback(void* userdata, Uint8* stream, int len)
+{
+	auto& device = *static_cast<Audio_device*>(userdata);
+
+	const std::span output(
+		reinterpret_cast<config::audio::Buffer_type*>(stream),
+		size_t(len) / sizeof(config::audio::Buffer_type)
+	);
+
+	const size_t read_count = device.ring_buffer.read(output);
+	if (read_count < output.size())
+	{
+		std::fill(output.begin() + read_count, output.end(), config::audio::Buffer_type(0));
+		if (device.streaming.load(std::memory_order_relaxed))
+			device.underrun_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	device.last_callback_time.store(SDL_GetPerformanceCounter(), std::memory_order_relaxed);
+}
+
+void Audio_device::pause_and_clear()
+{
+	SDL_PauseAudioDevice(device_id, 1);
+	playing = false;
+
+	// 持有设备锁时回调不会运行，可以安全地清空缓冲区
+	SDL_LockAudioDevice(device_id);
+	ring_buffer.reset();
+	SDL_UnlockAudioDevice(device_id);
+}
+
+void Audio_device::start()
+{
+	pause_and_clear();
+	underrun_count = 0;
+	streaming = true;
+}
+
+void Audio_device::drain()
+{
+	streaming = false;
+
+	if (!playing)
+	{
+		SDL_PauseAudioDevice(device_id, 0);
+		playing = true;
+	}
+}
+
+void Audio_device::stop()
+{
+	streaming = false;
+	pause_and_clear();
+}
+
+size_t Audio_device::write(std::span<const config::audio::Buffer_type> samples)
+{
+	const size_t written = ring_buffer.write(samples, config::audio::channels);
+
+	// 预填充达到目标后再开始播放，避免刚开始时的欠载
+	if (!playing && get_buffered_frames() >= get_target_frames())
+	{
+		SDL_PauseAudioDevice(device_id, 0);
+		playing = true;
+	}
+
+	return written;
+}
+
+size_t Audio_device::get_buffered_frames() const
+{
+	return ring_buffer.size() / config::audio::channels;
+}
+
+size_t Audio_device::get_target_frames() const
+{
+	return size_t(buffer_size) * config::audio::buffer_periods;
+}
+
+Audio_device::Stats Audio_device::get_stats() const
+{
+	const size_t buffered_frames = get_buffered_frames();
+
+	// 新写入的采样需要等待环形缓冲区中的采样与设备缓冲区播放完毕，
+	// 设备缓冲区在上一次回调时填满，之后随时间消耗
+	double latency = 0;
+	if (playing)
+	{
+		const double since_callback = double(SDL_GetPerformanceCounter() - last_callback_time.load())
+									/ SDL_GetPerformanceFrequency();
+		const double device_remaining = std::max(0.0, double(buffer_size) / sample_rate - since_callback);
+		latency = double(buffered_frames) / sample_rate + device_remaining;
+	}
+
+	return Stats{
+		.underruns = underrun_count.load(),
+		.latency = latency,
+		.buffered_frames = buffered_frames,
+		.buffer_size = buffer_size
+	};
+}
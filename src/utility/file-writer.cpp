@@ -0,0 +1,116 @@
+#include "utility/file-writer.hpp"
+
+#include <algorithm>
+
+Double_buffered_writer::Double_buffered_writer(std::ofstream file, size_t buffer_size) :
+	file(std::move(file)),
+	buffer_size(buffer_size)
+{
+	front_buffer.reserve(buffer_size);
+	back_buffer.reserve(buffer_size);
+
+	write_thread = std::jthread(
+		[this]
+		{
+			std::unique_lock lock(mutex);
+
+			while (true)
+			{
+				condition.wait(lock, [this] { return back_pending || closing; });
+
+				if (back_pending)
+				{
+					// 写盘期间不持有锁，调用者可以继续填充前台缓冲区
+					lock.unlock();
+					this->file.write(
+						reinterpret_cast<const char*>(back_buffer.data()),
+						static_cast<std::streamsize>(back_buffer.size())
+					);
+					const bool good = this->file.good();
+					back_buffer.clear();
+					lock.lock();
+
+					if (!good) io_failed = true;
+					back_pending = false;
+					condition.notify_all();
+					continue;
+				}
+
+				if (closing) break;
+			}
+		}
+	);
+}
+
+Double_buffered_writer::~Double_buffered_writer()
+{
+	{
+		std::lock_guard lock(mutex);
+		closing = true;
+	}
+	condition.notify_all();
+
+	if (write_thread.joinable()) write_thread.join();
+}
+
+std::optional<std::unique_ptr<Double_buffered_writer>> Double_buffered_writer::open(
+	const std::string& path,
+	size_t buffer_size
+)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) return std::nullopt;
+
+	return std::unique_ptr<Double_buffered_writer>(new Double_buffered_writer(std::move(file), buffer_size));
+}
+
+void Double_buffered_writer::submit_front_buffer()
+{
+	if (front_buffer.empty()) return;
+
+	std::unique_lock lock(mutex);
+	condition.wait(lock, [this] { return !back_pending; });
+
+	std::swap(front_buffer, back_buffer);
+	back_pending = true;
+	lock.unlock();
+
+	condition.notify_all();
+}
+
+void Double_buffered_writer::write(std::span<const std::byte> data)
+{
+	while (!data.empty())
+	{
+		const size_t available = buffer_size - front_buffer.size();
+		const size_t count = std::min(available, data.size());
+
+		front_buffer.insert(front_buffer.end(), data.begin(), data.begin() + count);
+		data = data.subspan(count);
+
+		if (front_buffer.size() >= buffer_size) submit_front_buffer();
+	}
+}
+
+bool Double_buffered_writer::finish()
+{
+	submit_front_buffer();
+
+	{
+		std::unique_lock lock(mutex);
+		condition.wait(lock, [this] { return !back_pending; });
+		closing = true;
+	}
+	condition.notify_all();
+
+	if (write_thread.joinable()) write_thread.join();
+
+	file.flush();
+	return !io_failed && file.good();
+}
+
+bool Double_buffered_writer::failed()
+{
+	std::lock_guard lock(mutex);
+	return io_failed;
+}
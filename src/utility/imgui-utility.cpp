@@ -15,6 +15,13 @@ namespace imgui_utility
 		ImFont* font = ImGui::GetFont();
 		float font_size = ImGui::GetFontSize();
 
+		// Advance cursor to avoid overlap
+		ImVec2 text_size = ImGui::CalcTextSize(text);
+		ImGui::Dummy(ImVec2(text_size.x, text_size.y));
+
+		// 不在可见区域内（如画布外的节点标题）时只占位，不生成绘制命令
+		if (!ImGui::IsItemVisible()) return;
+
 		draw_list->AddText(
 			font,
 			font_size,
@@ -37,10 +44,6 @@ namespace imgui_utility
 			text
 		);
 		draw_list->AddText(font, font_size, pos, ImGui::GetColorU32(ImGuiCol_Text), text);
-
-		// Advance cursor to avoid overlap
-		ImVec2 text_size = ImGui::CalcTextSize(text);
-		ImGui::Dummy(ImVec2(text_size.x, text_size.y));
 	}
 	void display_processor_description(const std::string& description, bool default_open)
 	{
@@ -0,0 +1,200 @@
+#include "utility/json-stream.hpp"
+
+#include <format>
+
+namespace
+{
+	// 读取成员或元素之后的分隔符，返回容器是否已经结束
+	bool read_separator(int c, char close, size_t offset)
+	{
+		if (c == close) return true;
+		if (c != ',')
+			throw Json_stream_reader::Parse_error(
+				std::format("Expected ',' or '{}' at offset {}, got '{}'", close, offset, char(c))
+			);
+
+		return false;
+	}
+}
+
+Json_stream_reader::Json_stream_reader(std::istream& stream) :
+	buffer(*stream.rdbuf()),
+	value_reader(Json::CharReaderBuilder().newCharReader())
+{
+}
+
+int Json_stream_reader::peek()
+{
+	return buffer.sgetc();
+}
+
+int Json_stream_reader::get()
+{
+	const int c = buffer.sbumpc();
+	if (c == std::streambuf::traits_type::eof())
+		throw Parse_error(std::format("Unexpected end of JSON at offset {}", offset));
+
+	offset++;
+	return c;
+}
+
+void Json_stream_reader::skip_whitespace()
+{
+	while (true)
+	{
+		const int c = peek();
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r') return;
+
+		buffer.sbumpc();
+		offset++;
+	}
+}
+
+void Json_stream_reader::expect(char c)
+{
+	skip_whitespace();
+
+	const int actual = get();
+	if (actual != c)
+		throw Parse_error(
+			std::format("Expected '{}' at offset {}, got '{}'", c, offset - 1, char(actual))
+		);
+}
+
+void Json_stream_reader::capture_value(std::string& output)
+{
+	skip_whitespace();
+
+	int depth = 0;
+	bool in_string = false;
+
+	// 按括号深度与字符串状态截取，数字、true等标量读到分隔符为止
+	while (true)
+	{
+		const int c = peek();
+
+		if (!in_string && depth == 0 && !output.empty()
+			&& (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\n' || c == '\r'
+				|| c == std::streambuf::traits_type::eof()))
+			return;
+
+		output.push_back(char(get()));
+
+		if (in_string)
+		{
+			if (c == '\\')
+				output.push_back(char(get()));
+			else if (c == '"')
+			{
+				in_string = false;
+				if (depth == 0) return;
+			}
+
+			continue;
+		}
+
+		switch (c)
+		{
+		case '"':
+			in_string = true;
+			break;
+		case '{':
+		case '[':
+			depth++;
+			break;
+		case '}':
+		case ']':
+			if (--depth < 0)
+				throw Parse_error(std::format("Unexpected '{}' at offset {}", char(c), offset - 1));
+			if (depth == 0) return;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+std::string Json_stream_reader::read_string()
+{
+	skip_whitespace();
+	if (peek() != '"') throw Parse_error(std::format("Expected string at offset {}", offset));
+
+	std::string raw;
+	capture_value(raw);
+
+	// 转义序列交给jsoncpp处理
+	Json::Value value;
+	std::string errors;
+	if (!value_reader->parse(raw.data(), raw.data() + raw.size(), &value, &errors) || !value.isString())
+		throw Parse_error(std::format("Invalid string before offset {}: {}", offset, errors));
+
+	return value.asString();
+}
+
+Json::Value Json_stream_reader::read_value()
+{
+	std::string raw;
+	capture_value(raw);
+
+	Json::Value value;
+	std::string errors;
+	if (!value_reader->parse(raw.data(), raw.data() + raw.size(), &value, &errors))
+		throw Parse_error(std::format("Invalid value before offset {}: {}", offset, errors));
+
+	return value;
+}
+
+void Json_stream_reader::skip_value()
+{
+	std::string raw;
+	capture_value(raw);
+}
+
+void Json_stream_reader::read_object(const std::function<void(const std::string& key)>& on_member)
+{
+	expect('{');
+
+	skip_whitespace();
+	if (peek() == '}')
+	{
+		get();
+		return;
+	}
+
+	while (true)
+	{
+		const auto key = read_string();
+		expect(':');
+		on_member(key);
+
+		skip_whitespace();
+		if (read_separator(get(), '}', offset - 1)) return;
+	}
+}
+
+void Json_stream_reader::read_array(const std::function<void()>& on_element)
+{
+	expect('[');
+
+	skip_whitespace();
+	if (peek() == ']')
+	{
+		get();
+		return;
+	}
+
+	while (true)
+	{
+		on_element();
+
+		skip_whitespace();
+		if (read_separator(get(), ']', offset - 1)) return;
+	}
+}
+
+void Json_stream_reader::expect_end()
+{
+	skip_whitespace();
+	if (peek() != std::streambuf::traits_type::eof())
+		throw Parse_error(std::format("Unexpected trailing data at offset {}", offset));
+}
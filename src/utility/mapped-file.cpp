@@ -0,0 +1,104 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "utility/mapped-file.hpp"
+
+#include <filesystem>
+#include <utility>
+
+// 平台相关的句柄
+struct Mapped_file::Handle
+{
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int fd = -1;
+#endif
+	void* view = nullptr;
+	size_t view_size = 0;
+
+	~Handle()
+	{
+#ifdef _WIN32
+		if (view != nullptr) UnmapViewOfFile(view);
+		if (mapping != nullptr) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+		if (view != nullptr) munmap(view, view_size);
+		if (fd >= 0) close(fd);
+#endif
+	}
+};
+
+Mapped_file::Mapped_file(Mapped_file&&) noexcept = default;
+Mapped_file& Mapped_file::operator=(Mapped_file&&) noexcept = default;
+Mapped_file::~Mapped_file() = default;
+
+std::optional<Mapped_file> Mapped_file::open(const std::string& path)
+{
+	auto handle = std::make_unique<Handle>();
+
+#ifdef _WIN32
+
+	const std::filesystem::path fs_path(reinterpret_cast<const char8_t*>(path.c_str()));
+
+	handle->file = CreateFileW(
+		fs_path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr
+	);
+	if (handle->file == INVALID_HANDLE_VALUE) return std::nullopt;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(handle->file, &file_size) || file_size.QuadPart <= 0) return std::nullopt;
+	handle->view_size = static_cast<size_t>(file_size.QuadPart);
+
+	handle->mapping = CreateFileMappingW(handle->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (handle->mapping == nullptr) return std::nullopt;
+
+	handle->view = MapViewOfFile(handle->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (handle->view == nullptr) return std::nullopt;
+
+#else
+
+	handle->fd = ::open(path.c_str(), O_RDONLY);
+	if (handle->fd < 0) return std::nullopt;
+
+	struct stat file_stat;
+	if (fstat(handle->fd, &file_stat) != 0 || file_stat.st_size <= 0) return std::nullopt;
+	handle->view_size = static_cast<size_t>(file_stat.st_size);
+
+	void* view = mmap(nullptr, handle->view_size, PROT_READ, MAP_PRIVATE, handle->fd, 0);
+	if (view == MAP_FAILED) return std::nullopt;
+	handle->view = view;
+
+#endif
+
+	Mapped_file result;
+	result.data_ptr = static_cast<const std::byte*>(handle->view);
+	result.data_size = handle->view_size;
+	result.handle = std::move(handle);
+
+	return result;
+}
+
+void Mapped_file::advise_sequential() const
+{
+#ifndef _WIN32
+	if (handle == nullptr || handle->view == nullptr) return;
+
+	madvise(handle->view, handle->view_size, MADV_SEQUENTIAL);
+	madvise(handle->view, handle->view_size, MADV_WILLNEED);
+#endif
+}
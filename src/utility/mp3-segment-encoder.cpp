@@ -0,0 +1,413 @@
+#include "utility/mp3-segment-encoder.hpp"
+#include "config.hpp"
+#include "utility/free-utility.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <stdexcept>
+
+#include <lame/lame.h>
+
+namespace
+{
+	constexpr auto mpeg1_bitrates = std::to_array<int>({0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320});
+	constexpr auto mpeg2_bitrates = std::to_array<int>({0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160});
+	constexpr auto mpeg1_sample_rates = std::to_array<int>({44100, 48000, 32000});
+
+	constexpr size_t xing_size = 120;      // "Info" + 标志 + 帧数 + 字节数 + TOC + 质量
+	constexpr size_t lame_tag_size = 36;   // LAME扩展标签
+	constexpr size_t encode_chunk = 8192;  // 每次提交给LAME的采样数
+
+	// CRC-16（多项式0x8005，反射），与LAME标签中使用的校验一致
+	constexpr auto crc16_table = []
+	{
+		std::array<uint16_t, 256> table{};
+		for (uint16_t i = 0; i < 256; i++)
+		{
+			uint16_t value = i;
+			for (int bit = 0; bit < 8; bit++) value = (value & 1) ? (value >> 1) ^ 0xA001 : value >> 1;
+			table[i] = value;
+		}
+		return table;
+	}();
+
+	uint16_t crc16_update(uint16_t crc, std::span<const std::byte> data)
+	{
+		for (const auto byte : data) crc = (crc >> 8) ^ crc16_table[(crc ^ uint8_t(byte)) & 0xFF];
+		return crc;
+	}
+
+	void write_be32(std::byte* dst, uint32_t value)
+	{
+		dst[0] = std::byte(value >> 24);
+		dst[1] = std::byte(value >> 16);
+		dst[2] = std::byte(value >> 8);
+		dst[3] = std::byte(value);
+	}
+
+	size_t calc_frame_size(int version, int bitrate, int sample_rate, bool padding)
+	{
+		const int coefficient = version == 1 ? 144 : 72;
+		return size_t(coefficient * bitrate * 1000 / sample_rate) + (padding ? 1 : 0);
+	}
+
+	// 创建并初始化一个LAME编码器
+	lame_t create_lame(const Segmented_mp3_encoder::Params& params)
+	{
+		lame_t lame = lame_init();
+		if (lame == nullptr) throw std::bad_alloc();
+
+		lame_set_in_samplerate(lame, params.sample_rate);
+		lame_set_out_samplerate(lame, params.sample_rate);
+		lame_set_num_channels(lame, params.channels);
+		lame_set_mode(lame, params.channels == 2 ? MPEG_mode::STEREO : MPEG_mode::MONO);
+		lame_set_quality(lame, 2);
+		lame_set_VBR(lame, vbr_off);
+		lame_set_brate(lame, params.kbps);
+		lame_set_disable_reservoir(lame, 1);  // 每一帧独立，才能按帧拼接
+		lame_set_bWriteVbrTag(lame, 0);       // Info帧由拼接结果统一生成
+
+		if (lame_init_params(lame) == -1)
+		{
+			lame_close(lame);
+			throw std::runtime_error(std::format(
+				"Failed to initialize LAME parameters (sample rate {}, {} channels, {} kbps)",
+				params.sample_rate,
+				params.channels,
+				params.kbps
+			));
+		}
+
+		return lame;
+	}
+}
+
+std::optional<Mp3_frame_header> Mp3_frame_header::parse(std::span<const std::byte> data)
+{
+	if (data.size() < 4) return std::nullopt;
+
+	const auto b1 = uint8_t(data[1]), b2 = uint8_t(data[2]), b3 = uint8_t(data[3]);
+
+	if (uint8_t(data[0]) != 0xFF || (b1 & 0xE0) != 0xE0) return std::nullopt;  // 同步字
+	if (((b1 >> 1) & 3) != 1) return std::nullopt;                               // 仅Layer III
+
+	int version;
+	switch ((b1 >> 3) & 3)
+	{
+	case 3:
+		version = 1;
+		break;
+	case 2:
+		version = 2;
+		break;
+	case 0:
+		version = 3;
+		break;
+	default:
+		return std::nullopt;
+	}
+
+	const int bitrate_index = b2 >> 4;
+	const int sample_rate_index = (b2 >> 2) & 3;
+	if (bitrate_index == 0 || bitrate_index == 15 || sample_rate_index == 3) return std::nullopt;
+
+	Mp3_frame_header header;
+	header.version = version;
+	header.bitrate_index = bitrate_index;
+	header.sample_rate_index = sample_rate_index;
+	header.sample_rate = mpeg1_sample_rates[sample_rate_index] >> (version - 1);
+	header.bitrate = version == 1 ? mpeg1_bitrates[bitrate_index] : mpeg2_bitrates[bitrate_index];
+	header.padding = (b2 >> 1) & 1;
+	header.mono = (b3 >> 6) == 3;
+	header.frame_size = calc_frame_size(version, header.bitrate, header.sample_rate, header.padding);
+	header.frame_samples = version == 1 ? 1152 : 576;
+
+	return header;
+}
+
+size_t Mp3_frame_header::side_info_size() const
+{
+	if (version == 1) return mono ? 17 : 32;
+	return mono ? 9 : 17;
+}
+
+Segmented_mp3_encoder::Segmented_mp3_encoder(Params params) :
+	params(params)
+{
+	// 使用一个临时编码器获取帧长度与编码器延迟
+	lame_t probe = create_lame(params);
+	const Free_utility free_probe(std::bind(lame_close, probe));
+
+	frame_samples = lame_get_framesize(probe);
+	encoder_delay = lame_get_encoder_delay(probe);
+	lowpass_freq = lame_get_lowpassfreq(probe);
+}
+
+Segmented_mp3_encoder::Segment_output Segmented_mp3_encoder::encode_segment(
+	const Params& params,
+	std::vector<float> pcm,
+	size_t skip_frames,
+	std::optional<size_t> keep_frames
+)
+{
+	lame_t lame = create_lame(params);
+	const Free_utility free_lame(std::bind(lame_close, lame));
+
+	/* 编码 */
+
+	std::vector<std::byte> encoded;
+	std::vector<std::byte> buffer(5 * encode_chunk / 4 + 7200);  // LAME 的缓冲区大小
+	auto* const buffer_ptr = reinterpret_cast<unsigned char*>(buffer.data());
+	const auto buffer_size = static_cast<int>(buffer.size());
+
+	auto append_output = [&encoded, &buffer](int written)
+	{
+		if (written < 0) throw std::runtime_error(std::format("Failed to encode MP3 segment, LAME error {}", written));
+		encoded.insert(encoded.end(), buffer.begin(), buffer.begin() + written);
+	};
+
+	const size_t total = pcm.size() / params.channels;
+	for (size_t offset = 0; offset < total; offset += encode_chunk)
+	{
+		const auto count = static_cast<int>(std::min(encode_chunk, total - offset));
+		const float* const src = pcm.data() + offset * params.channels;
+
+		append_output(
+			params.channels == 2
+				? lame_encode_buffer_interleaved_ieee_float(lame, src, count, buffer_ptr, buffer_size)
+				: lame_encode_buffer_ieee_float(lame, src, src, count, buffer_ptr, buffer_size)
+		);
+	}
+
+	append_output(lame_encode_flush(lame, buffer_ptr, buffer_size));
+
+	/* 按帧裁剪 */
+
+	Segment_output output{.data = {}, .frame_count = 0};
+	size_t position = 0, frame_index = 0;
+
+	while (position < encoded.size())
+	{
+		const auto header = Mp3_frame_header::parse(std::span(encoded).subspan(position));
+		if (!header.has_value() || position + header->frame_size > encoded.size())
+			throw std::runtime_error(std::format("Invalid MP3 frame in encoded segment at byte {}", position));
+
+		const bool keep
+			= frame_index >= skip_frames
+		   && (!keep_frames.has_value() || frame_index < skip_frames + keep_frames.value());
+
+		if (keep)
+		{
+			output.data.insert(
+				output.data.end(),
+				encoded.begin() + position,
+				encoded.begin() + position + header->frame_size
+			);
+			output.frame_count++;
+		}
+
+		position += header->frame_size;
+		frame_index++;
+	}
+
+	if (keep_frames.has_value() && output.frame_count != keep_frames.value())
+		throw std::runtime_error(std::format(
+			"MP3 segment produced {} frames, expected {}",
+			output.frame_count,
+			keep_frames.value()
+		));
+
+	return output;
+}
+
+void Segmented_mp3_encoder::submit_segment(std::optional<uint64_t> length)
+{
+	constexpr auto priming_frames = config::processor::audio_output::segment_priming_frames;
+	constexpr auto trailing_frames = config::processor::audio_output::segment_trailing_frames;
+
+	// 预热部分从前一个分段的末尾取，第一个分段没有预热
+	const uint64_t priming_samples = std::min<uint64_t>(segment_begin, priming_frames * frame_samples);
+	const uint64_t job_begin = segment_begin - priming_samples;
+	const uint64_t job_end
+		= length.has_value() ? segment_begin + length.value() + trailing_frames * frame_samples
+							 : buffer_begin + pcm_buffer.size() / params.channels;
+
+	std::vector<float> pcm(
+		pcm_buffer.begin() + (job_begin - buffer_begin) * params.channels,
+		pcm_buffer.begin() + (job_end - buffer_begin) * params.channels
+	);
+
+	const size_t skip_frames = priming_samples / frame_samples;
+	const auto keep_frames
+		= length.has_value() ? std::optional<size_t>(length.value() / frame_samples) : std::nullopt;
+
+	pending_segments.push_back(
+		std::async(std::launch::async, encode_segment, params, std::move(pcm), skip_frames, keep_frames)
+	);
+
+	if (!length.has_value()) return;
+
+	segment_begin += length.value();
+
+	// 丢弃之后不会再用到的采样
+	const uint64_t keep_from = segment_begin - std::min<uint64_t>(segment_begin, priming_frames * frame_samples);
+	pcm_buffer.erase(pcm_buffer.begin(), pcm_buffer.begin() + (keep_from - buffer_begin) * params.channels);
+	buffer_begin = keep_from;
+}
+
+void Segmented_mp3_encoder::write_segment(Segment_output segment, Double_buffered_writer& writer)
+{
+	if (segment.data.empty()) return;
+
+	if (!first_header.has_value())
+	{
+		first_header = Mp3_frame_header::parse(segment.data);
+		first_header_bytes.assign(segment.data.begin(), segment.data.begin() + 4);
+
+		// Info帧需要容纳边信息、Xing与LAME标签，码率不足时选择更高的码率
+		const size_t required = 4 + first_header->side_info_size() + xing_size + lame_tag_size;
+		const auto& bitrates = first_header->version == 1 ? mpeg1_bitrates : mpeg2_bitrates;
+
+		int bitrate_index = first_header->bitrate_index;
+		while (bitrate_index < 14
+			   && calc_frame_size(first_header->version, bitrates[bitrate_index], first_header->sample_rate, false)
+					  < required)
+			bitrate_index++;
+
+		first_header->bitrate_index = bitrate_index;
+		first_header->bitrate = bitrates[bitrate_index];
+		info_frame_size = calc_frame_size(first_header->version, first_header->bitrate, first_header->sample_rate, false);
+
+		// 预留Info帧的位置
+		const std::vector<std::byte> placeholder(info_frame_size, std::byte(0));
+		writer.write(placeholder);
+	}
+
+	music_crc = crc16_update(music_crc, segment.data);
+	output_frames += segment.frame_count;
+	output_bytes += segment.data.size();
+
+	writer.write(segment.data);
+}
+
+void Segmented_mp3_encoder::write_completed(Double_buffered_writer& writer, bool wait)
+{
+	while (!pending_segments.empty())
+	{
+		auto& front = pending_segments.front();
+		if (!wait && front.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+		write_segment(front.get(), writer);
+		pending_segments.pop_front();
+		wait = false;
+	}
+}
+
+void Segmented_mp3_encoder::submit_ready_segments(Double_buffered_writer& writer)
+{
+	constexpr auto trailing_frames = config::processor::audio_output::segment_trailing_frames;
+	const uint64_t segment_length = config::processor::audio_output::segment_frames * frame_samples;
+	const size_t max_pending = std::max<size_t>(params.thread_count, 1) * 2;
+
+	const uint64_t buffer_end = buffer_begin + pcm_buffer.size() / params.channels;
+
+	while (buffer_end >= segment_begin + segment_length + trailing_frames * frame_samples)
+	{
+		// 限制同时进行的分段数量，避免占用过多内存
+		while (pending_segments.size() >= max_pending) write_completed(writer, true);
+
+		submit_segment(segment_length);
+	}
+
+	write_completed(writer, false);
+}
+
+void Segmented_mp3_encoder::append(std::span<const float> samples, Double_buffered_writer& writer)
+{
+	pcm_buffer.insert(pcm_buffer.end(), samples.begin(), samples.end());
+	total_samples += samples.size() / params.channels;
+
+	submit_ready_segments(writer);
+}
+
+void Segmented_mp3_encoder::append_silence(uint64_t sample_count, Double_buffered_writer& writer)
+{
+	pcm_buffer.resize(pcm_buffer.size() + sample_count * params.channels, 0.0f);
+	total_samples += sample_count;
+
+	submit_ready_segments(writer);
+}
+
+std::vector<std::byte> Segmented_mp3_encoder::finish(Double_buffered_writer& writer)
+{
+	// 最后一个分段即使没有新的采样也需要编码，以输出覆盖编码器延迟的尾部帧
+	submit_segment(std::nullopt);
+	write_completed(writer, true);
+
+	return build_info_frame();
+}
+
+std::vector<std::byte> Segmented_mp3_encoder::build_info_frame() const
+{
+	if (!first_header.has_value()) return {};
+
+	std::vector<std::byte> frame(info_frame_size, std::byte(0));
+
+	/* 帧头：与第一帧相同，仅修改码率，去掉填充与CRC */
+
+	std::memcpy(frame.data(), first_header_bytes.data(), 4);
+	frame[1] |= std::byte(0x01);
+	frame[2] = std::byte((first_header->bitrate_index << 4) | (first_header->sample_rate_index << 2))
+			 | (frame[2] & std::byte(0x01));
+
+	/* Xing "Info" 头 */
+
+	std::byte* const xing = frame.data() + 4 + first_header->side_info_size();
+	const uint64_t file_size = output_bytes + info_frame_size;
+
+	std::memcpy(xing, "Info", 4);
+	write_be32(xing + 4, 0x0F);  // 帧数、字节数、TOC、质量
+	write_be32(xing + 8, uint32_t(output_frames));
+	write_be32(xing + 12, uint32_t(file_size));
+	for (int i = 0; i < 100; i++) xing[16 + i] = std::byte(i * 256 / 100);  // CBR的TOC为线性
+	write_be32(xing + 116, 0);
+
+	/* LAME 标签 */
+
+	std::byte* const tag = xing + xing_size;
+
+	const auto version = std::format("LAME{}", get_lame_short_version());
+	std::memcpy(tag, version.data(), std::min<size_t>(version.size(), 9));
+
+	const int64_t padding = int64_t(output_frames) * frame_samples - encoder_delay - int64_t(total_samples);
+	const auto clamped_delay = uint32_t(std::clamp(encoder_delay, 0, 4095));
+	const auto clamped_padding = uint32_t(std::clamp<int64_t>(padding, 0, 4095));
+
+	tag[9] = std::byte(0x01);  // 标签版本0，CBR
+	tag[10] = std::byte(std::min(lowpass_freq / 100, 255));
+	tag[20] = std::byte(std::min<size_t>(params.kbps, 255));
+	tag[21] = std::byte(clamped_delay >> 4);
+	tag[22] = std::byte(((clamped_delay & 0x0F) << 4) | (clamped_padding >> 8));
+	tag[23] = std::byte(clamped_padding & 0xFF);
+
+	// 源采样率：0 = ≤32kHz，1 = 44.1kHz，2 = 48kHz，3 = >48kHz
+	const int source_rate = params.sample_rate <= 32000 ? 0
+						  : params.sample_rate <= 44100 ? 1
+						  : params.sample_rate <= 48000 ? 2
+														: 3;
+	tag[24] = std::byte(source_rate << 6);
+
+	write_be32(tag + 28, uint32_t(file_size));
+	tag[32] = std::byte(music_crc >> 8);
+	tag[33] = std::byte(music_crc & 0xFF);
+
+	const auto tag_crc = crc16_update(0, std::span(frame.data(), tag + 34));
+	tag[34] = std::byte(tag_crc >> 8);
+	tag[35] = std::byte(tag_crc & 0xFF);
+
+	return frame;
+}
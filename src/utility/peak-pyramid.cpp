@@ -0,0 +1,275 @@
+#include "utility/peak-pyramid.hpp"
+#include "utility/system.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <ostream>
+
+// 峰值金字塔文件（版本2），所有整数均为小端序
+//
+// 文件头
+//   char[4]  magic = "NDYP"
+//   u32      version
+//   u64      source_size             // 源文件大小，用于判断是否过期
+//   i64      source_modified_time    // 源文件修改时间
+//   u32      sample_rate
+//   u32      base_block
+//   u32      level_factor
+//   u32      level_count
+//   u64      total_frames
+//   level_count × u64 entry_count
+// 各层的条目依次排列，第0层在前
+//   entry_count × { i16 min, i16 max, u16 rms }
+
+static_assert(std::endian::native == std::endian::little, "Peak pyramid format assumes little endian");
+static_assert(sizeof(Peak_pyramid::Peak) == 6, "Peak must be packed without padding");
+
+namespace
+{
+	constexpr char pyramid_magic[4] = {'N', 'D', 'Y', 'P'};
+	constexpr uint32_t pyramid_version = 2;  // 版本1的块最值从0开始累计，已失效
+
+	struct File_header
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t source_size;
+		int64_t source_modified_time;
+		uint32_t sample_rate;
+		uint32_t base_block;
+		uint32_t level_factor;
+		uint32_t level_count;
+		uint64_t total_frames;
+	};
+
+	static_assert(sizeof(File_header) == 48, "File header must be packed without padding");
+
+	int16_t quantize_amplitude(float value)
+	{
+		return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	uint16_t quantize_rms(double value)
+	{
+		return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0, 1.0) * 65535.0));
+	}
+
+	// 合并若干条目，RMS按条目等长计算
+	Peak_pyramid::Peak merge_peaks(std::span<const Peak_pyramid::Peak> peaks)
+	{
+		int16_t min = peaks.front().min, max = peaks.front().max;
+		double sum_squares = 0;
+
+		for (const auto& peak : peaks)
+		{
+			min = std::min(min, peak.min);
+			max = std::max(max, peak.max);
+			sum_squares += double(peak.rms) * peak.rms;
+		}
+
+		const double rms = std::sqrt(sum_squares / double(peaks.size()));
+		return {.min = min, .max = max, .rms = static_cast<uint16_t>(std::lround(rms))};
+	}
+}
+
+void Peak_pyramid::Builder::flush_block()
+{
+	if (block_frames == 0) return;
+
+	const double rms = std::sqrt(block_sum_squares / (double(block_frames) * block_channels));
+	base_level.push_back(
+		{.min = quantize_amplitude(block_min), .max = quantize_amplitude(block_max), .rms = quantize_rms(rms)}
+	);
+
+	block_sum_squares = 0;
+	block_frames = 0;
+}
+
+void Peak_pyramid::Builder::push(std::span<const float> samples, int channels)
+{
+	block_channels = channels;
+
+	const size_t frame_count = samples.size() / channels;
+	const float* frame = samples.data();
+
+	for (size_t i = 0; i < frame_count; i++, frame += channels)
+	{
+		// 块的最值从第一个采样开始累计，否则整块为正（负）的信号最小（大）值会被钳制为0
+		if (block_frames == 0) block_min = block_max = frame[0];
+
+		for (int channel = 0; channel < channels; channel++)
+		{
+			const float sample = frame[channel];
+			block_min = std::min(block_min, sample);
+			block_max = std::max(block_max, sample);
+			block_sum_squares += double(sample) * sample;
+		}
+
+		if (++block_frames == base_block) flush_block();
+	}
+
+	total_frames += frame_count;
+}
+
+bool Peak_pyramid::Builder::write(const std::string& path, const Source_info& source, int sample_rate)
+{
+	flush_block();
+
+	// 每层合并上一层的level_factor个条目，直到只剩一个条目
+	std::vector<std::vector<Peak>> upper_levels;
+	for (std::span<const Peak> lower = base_level; lower.size() > 1; lower = upper_levels.back())
+	{
+		std::vector<Peak> level;
+		level.reserve((lower.size() + level_factor - 1) / level_factor);
+
+		for (size_t i = 0; i < lower.size(); i += level_factor)
+			level.push_back(merge_peaks(lower.subspan(i, std::min<size_t>(level_factor, lower.size() - i))));
+
+		upper_levels.push_back(std::move(level));
+	}
+
+	const File_header header{
+		.magic = {pyramid_magic[0], pyramid_magic[1], pyramid_magic[2], pyramid_magic[3]},
+		.version = pyramid_version,
+		.source_size = source.size,
+		.source_modified_time = source.modified_time,
+		.sample_rate = static_cast<uint32_t>(sample_rate),
+		.base_block = base_block,
+		.level_factor = level_factor,
+		.level_count = static_cast<uint32_t>(1 + upper_levels.size()),
+		.total_frames = total_frames
+	};
+
+	const auto write_level = [](std::ostream& stream, std::span<const Peak> level)
+	{
+		stream.write(reinterpret_cast<const char*>(level.data()), std::streamsize(level.size_bytes()));
+	};
+
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+	return write_file_atomic(
+		path,
+		[&](std::ostream& stream)
+		{
+			stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+			const uint64_t base_count = base_level.size();
+			stream.write(reinterpret_cast<const char*>(&base_count), sizeof(base_count));
+			for (const auto& level : upper_levels)
+			{
+				const uint64_t count = level.size();
+				stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+			}
+
+			write_level(stream, base_level);
+			for (const auto& level : upper_levels) write_level(stream, level);
+
+			return stream.good();
+		}
+	);
+}
+
+Peak_pyramid::Peak_pyramid(
+	Mapped_file file,
+	int sample_rate,
+	uint64_t total_frames,
+	std::vector<std::span<const Peak>> levels
+) :
+	file(std::move(file)),
+	sample_rate(sample_rate),
+	total_frames(total_frames),
+	levels(std::move(levels))
+{
+}
+
+std::optional<Peak_pyramid::Source_info> Peak_pyramid::get_source_info(const std::string& path)
+{
+	std::error_code error;
+
+	const auto size = std::filesystem::file_size(path, error);
+	if (error) return std::nullopt;
+
+	const auto modified_time = std::filesystem::last_write_time(path, error);
+	if (error) return std::nullopt;
+
+	return Source_info{
+		.size = static_cast<uint64_t>(size),
+		.modified_time = static_cast<int64_t>(modified_time.time_since_epoch().count())
+	};
+}
+
+std::optional<Peak_pyramid> Peak_pyramid::open(const std::string& path, const Source_info& source)
+{
+	auto file = Mapped_file::open(path);
+	if (!file.has_value()) return std::nullopt;
+
+	const auto bytes = file->bytes();
+	if (bytes.size() < sizeof(File_header)) return std::nullopt;
+
+	File_header header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+
+	if (std::memcmp(header.magic, pyramid_magic, sizeof(pyramid_magic)) != 0) return std::nullopt;
+	if (header.version != pyramid_version) return std::nullopt;
+	if (header.base_block != base_block || header.level_factor != level_factor) return std::nullopt;
+	if (Source_info{header.source_size, header.source_modified_time} != source) return std::nullopt;
+	if (header.sample_rate == 0 || header.level_count == 0) return std::nullopt;
+
+	// 条目数量表之后紧接着各层数据，总长度必须与文件大小一致
+	size_t offset = sizeof(File_header);
+	if ((bytes.size() - offset) / sizeof(uint64_t) < header.level_count) return std::nullopt;
+
+	std::vector<uint64_t> counts(header.level_count);
+	std::memcpy(counts.data(), bytes.data() + offset, counts.size() * sizeof(uint64_t));
+	offset += counts.size() * sizeof(uint64_t);
+
+	std::vector<std::span<const Peak>> levels;
+	levels.reserve(counts.size());
+
+	for (const auto count : counts)
+	{
+		if ((bytes.size() - offset) / sizeof(Peak) < count) return std::nullopt;
+
+		levels.emplace_back(reinterpret_cast<const Peak*>(bytes.data() + offset), count);
+		offset += count * sizeof(Peak);
+	}
+
+	if (offset != bytes.size()) return std::nullopt;
+
+	return Peak_pyramid(std::move(*file), int(header.sample_rate), header.total_frames, std::move(levels));
+}
+
+void Peak_pyramid::query(double first_frame, double frames_per_pixel, std::span<Peak> output) const
+{
+	std::ranges::fill(output, Peak{.min = 0, .max = 0, .rms = 0});
+	if (frames_per_pixel <= 0 || levels.front().empty()) return;
+
+	// 选择条目不超过一个像素的最粗的一层
+	size_t level_index = 0;
+	double entry_frames = base_block;
+	while (level_index + 1 < levels.size() && entry_frames * level_factor <= frames_per_pixel)
+	{
+		level_index++;
+		entry_frames *= level_factor;
+	}
+
+	const auto& level = levels[level_index];
+
+	for (size_t x = 0; x < output.size(); x++)
+	{
+		const double begin = std::max(first_frame + double(x) * frames_per_pixel, 0.0);
+		const double end = std::min(first_frame + double(x + 1) * frames_per_pixel, double(total_frames));
+		if (begin >= end) continue;
+
+		// 像素比条目窄时，至少取包含该像素的一个条目
+		const auto first_entry = std::min(static_cast<size_t>(begin / entry_frames), level.size() - 1);
+		const auto last_entry
+			= std::clamp(static_cast<size_t>(std::ceil(end / entry_frames)), first_entry + 1, level.size());
+
+		output[x] = merge_peaks(level.subspan(first_entry, last_entry - first_entry));
+	}
+}
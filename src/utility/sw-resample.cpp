@@ -1,39 +1,339 @@
 #include "utility/sw-resample.hpp"
+#include "utility/logic-error-utility.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <numbers>
+#include <source_location>
+#include <stdexcept>
 
 extern "C"
 {
 #include <libavutil/opt.h>
 }
 
-std::optional<std::unique_ptr<Audio_resampler>> Audio_resampler::create(Format input, Format output)
+namespace
+{
+	/* 采样格式转换内核 */
+
+	// 转换为[-1, 1)范围内的float，与libswresample的换算一致
+	float sample_to_float(uint8_t sample)
+	{
+		return (float(sample) - 128.0f) / 128.0f;
+	}
+
+	float sample_to_float(int16_t sample)
+	{
+		return float(sample) / 32768.0f;
+	}
+
+	float sample_to_float(int32_t sample)
+	{
+		return float(double(sample) / 2147483648.0);
+	}
+
+	float sample_to_float(float sample)
+	{
+		return sample;
+	}
+
+	// 从float转换，超出范围的值被截断
+	template <typename T>
+	T float_to_sample(float value);
+
+	template <>
+	uint8_t float_to_sample<uint8_t>(float value)
+	{
+		return uint8_t(std::round(std::clamp(value * 128.0f + 128.0f, 0.0f, 255.0f)));
+	}
+
+	template <>
+	int16_t float_to_sample<int16_t>(float value)
+	{
+		return int16_t(std::round(std::clamp(value * 32768.0f, -32768.0f, 32767.0f)));
+	}
+
+	template <>
+	int32_t float_to_sample<int32_t>(float value)
+	{
+		return int32_t(std::round(std::clamp(double(value) * 2147483648.0, -2147483648.0, 2147483647.0)));
+	}
+
+	template <>
+	float float_to_sample<float>(float value)
+	{
+		return value;
+	}
+
+	template <typename In_t, typename Out_t>
+	void convert_channel(
+		const uint8_t* src,
+		int src_stride,
+		uint8_t* dst,
+		int dst_stride,
+		int count,
+		float gain
+	)
+	{
+		const auto input = reinterpret_cast<const In_t*>(src);
+		const auto output = reinterpret_cast<Out_t*>(dst);
+
+		[[assume(count > 0)]];
+
+		// 平面格式之间步长都为1，单独处理以便编译器向量化
+		if (src_stride == 1 && dst_stride == 1)
+		{
+			for (int i = 0; i < count; i++)
+				output[i] = float_to_sample<Out_t>(sample_to_float(input[i]) * gain);
+			return;
+		}
+
+		for (int i = 0; i < count; i++)
+			output[size_t(i) * dst_stride]
+				= float_to_sample<Out_t>(sample_to_float(input[size_t(i) * src_stride]) * gain);
+	}
+
+	template <typename In_t>
+	Audio_resampler::Convert_func select_convert_func(AVSampleFormat output)
+	{
+		switch (av_get_packed_sample_fmt(output))
+		{
+		case AV_SAMPLE_FMT_U8:
+			return convert_channel<In_t, uint8_t>;
+		case AV_SAMPLE_FMT_S16:
+			return convert_channel<In_t, int16_t>;
+		case AV_SAMPLE_FMT_S32:
+			return convert_channel<In_t, int32_t>;
+		case AV_SAMPLE_FMT_FLT:
+			return convert_channel<In_t, float>;
+		default:
+			return nullptr;
+		}
+	}
+
+	// 选择转换内核，不支持的格式（如DBL、S64）返回nullptr，交给libswresample处理
+	Audio_resampler::Convert_func select_convert_func(AVSampleFormat input, AVSampleFormat output)
+	{
+		switch (av_get_packed_sample_fmt(input))
+		{
+		case AV_SAMPLE_FMT_U8:
+			return select_convert_func<uint8_t>(output);
+		case AV_SAMPLE_FMT_S16:
+			return select_convert_func<int16_t>(output);
+		case AV_SAMPLE_FMT_S32:
+			return select_convert_func<int32_t>(output);
+		case AV_SAMPLE_FMT_FLT:
+			return select_convert_func<float>(output);
+		default:
+			return nullptr;
+		}
+	}
+
+	/* 质量预设 */
+
+	struct Quality_preset
+	{
+		int filter_size;        // 内置引擎的滤波器长度
+		int phase_shift;        // 内置引擎的相位数（以2为底的对数）
+		double soxr_precision;  // soxr引擎的精度（位），为0时不使用soxr
+	};
+
+	const Quality_preset& get_quality_preset(Audio_resampler::Quality quality)
+	{
+		// 内置引擎的默认值为filter_size = 32，phase_shift = 10
+		static constexpr Quality_preset preview_preset{
+			.filter_size = 16,
+			.phase_shift = 8,
+			.soxr_precision = 0
+		};
+
+		static constexpr Quality_preset export_preset{
+			.filter_size = 64,
+			.phase_shift = 14,
+			.soxr_precision = 28
+		};
+
+		switch (quality)
+		{
+		case Audio_resampler::Quality::Preview:
+			return preview_preset;
+		case Audio_resampler::Quality::Export:
+			return export_preset;
+		}
+
+		THROW_LOGIC_ERROR("Invalid resample quality {}", (int)quality);
+	}
+}
+
+std::string_view Audio_resampler::get_quality_name(Quality quality)
+{
+	switch (quality)
+	{
+	case Quality::Preview:
+		return "preview/fast";
+	case Quality::Export:
+		return "export/high";
+	}
+
+	return "unknown";
+}
+
+std::optional<std::unique_ptr<Audio_resampler>> Audio_resampler::create(
+	Format input,
+	Format output,
+	Quality quality
+)
 {
-	std::unique_ptr<Audio_resampler> resampler = std::make_unique<Audio_resampler>();
-	if (!resampler->resampler_context) throw std::bad_alloc();
+	std::unique_ptr<Audio_resampler> resampler(new Audio_resampler());
+
+	resampler->input_sample_format = input.format;
+	resampler->output_sample_format = output.format;
+	resampler->input_channels = input.channel_layout.nb_channels;
+	resampler->output_channels = output.channel_layout.nb_channels;
+
+	if (input.sample_rate == output.sample_rate)
+	{
+		const AVChannelLayout stereo_layout = AV_CHANNEL_LAYOUT_STEREO;
+		const bool same_layout
+			= av_channel_layout_compare(&input.channel_layout, &output.channel_layout) == 0;
+		const bool mono_to_stereo = input.channel_layout.nb_channels == 1
+								 && av_channel_layout_compare(&output.channel_layout, &stereo_layout) == 0;
+
+		if (same_layout && input.format == output.format)
+		{
+			resampler->mode = Mode::Passthrough;
+			return resampler;
+		}
+
+		if (same_layout || mono_to_stereo)
+		{
+			resampler->convert_func = select_convert_func(input.format, output.format);
+
+			// 单声道扩展为立体声时与libswresample一致，每个声道衰减3dB
+			resampler->convert_gain = mono_to_stereo ? float(std::numbers::sqrt2 / 2) : 1.0f;
+
+			if (resampler->convert_func != nullptr)
+			{
+				resampler->mode = Mode::Convert;
+				return resampler;
+			}
+		}
+	}
 
-	av_opt_set_int(resampler->resampler_context, "in_sample_rate", input.sample_rate, 0);
-	av_opt_set_sample_fmt(resampler->resampler_context, "in_sample_fmt", input.format, 0);
-	av_opt_set_chlayout(resampler->resampler_context, "in_chlayout", &input.channel_layout, 0);
-	av_opt_set_int(resampler->resampler_context, "out_sample_rate", output.sample_rate, 0);
-	av_opt_set_sample_fmt(resampler->resampler_context, "out_sample_fmt", output.format, 0);
-	av_opt_set_chlayout(resampler->resampler_context, "out_chlayout", &output.channel_layout, 0);
+	resampler->mode = Mode::Resample;
+	resampler->resampler_context = swr_alloc();
+	if (resampler->resampler_context == nullptr) throw std::bad_alloc();
 
-	if (swr_init(resampler->resampler_context) < 0) return std::nullopt;
+	SwrContext* const context = resampler->resampler_context;
+
+	av_opt_set_int(context, "in_sample_rate", input.sample_rate, 0);
+	av_opt_set_sample_fmt(context, "in_sample_fmt", input.format, 0);
+	av_opt_set_chlayout(context, "in_chlayout", &input.channel_layout, 0);
+	av_opt_set_int(context, "out_sample_rate", output.sample_rate, 0);
+	av_opt_set_sample_fmt(context, "out_sample_fmt", output.format, 0);
+	av_opt_set_chlayout(context, "out_chlayout", &output.channel_layout, 0);
+
+	const auto& preset = get_quality_preset(quality);
+	av_opt_set_int(context, "filter_size", preset.filter_size, 0);
+	av_opt_set_int(context, "phase_shift", preset.phase_shift, 0);
+
+	if (preset.soxr_precision > 0)
+	{
+		av_opt_set_int(context, "resampler", SWR_ENGINE_SOXR, 0);
+		av_opt_set_double(context, "precision", preset.soxr_precision, 0);
+		if (swr_init(context) >= 0) return resampler;
+
+		// FFmpeg编译时没有启用soxr，回退到内置引擎
+		av_opt_set_int(context, "resampler", SWR_ENGINE_SWR, 0);
+	}
+
+	if (swr_init(context) < 0) return std::nullopt;
 
 	return resampler;
 }
 
+void Audio_resampler::copy_samples(const uint8_t* const* input, uint8_t* const* output, int count) const
+{
+	const bool planar = av_sample_fmt_is_planar(input_sample_format);
+	const int plane_count = planar ? input_channels : 1;
+	const size_t plane_bytes
+		= size_t(count) * av_get_bytes_per_sample(input_sample_format) * (planar ? 1 : input_channels);
+
+	for (int plane = 0; plane < plane_count; plane++) std::memcpy(output[plane], input[plane], plane_bytes);
+}
+
+void Audio_resampler::convert_samples(const uint8_t* const* input, uint8_t* const* output, int count) const
+{
+	const bool input_planar = av_sample_fmt_is_planar(input_sample_format);
+	const bool output_planar = av_sample_fmt_is_planar(output_sample_format);
+	const int input_bytes = av_get_bytes_per_sample(input_sample_format);
+	const int output_bytes = av_get_bytes_per_sample(output_sample_format);
+
+	// 每个声道单独转换一遍，平面格式之间的转换可以向量化
+	for (int ch = 0; ch < output_channels; ch++)
+	{
+		// 单声道扩展为立体声时两个输出声道都来自第一个输入声道
+		const int input_ch = input_channels == 1 ? 0 : ch;
+
+		const uint8_t* src = input_planar ? input[input_ch] : input[0] + size_t(input_ch) * input_bytes;
+		uint8_t* dst = output_planar ? output[ch] : output[0] + size_t(ch) * output_bytes;
+
+		convert_func(
+			src,
+			input_planar ? 1 : input_channels,
+			dst,
+			output_planar ? 1 : output_channels,
+			count,
+			convert_gain
+		);
+	}
+}
+
+int Audio_resampler::process(
+	const uint8_t* const* input,
+	int input_samples,
+	uint8_t* const* output,
+	int output_samples
+)
+{
+	if (mode == Mode::Resample)
+		return swr_convert(
+			resampler_context,
+			output,
+			output_samples,
+			input,
+			input == nullptr ? 0 : input_samples
+		);
+
+	// 直通与转换模式没有内部缓冲，冲刷时没有剩余采样
+	const int count = std::min(input_samples, output_samples);
+	if (input == nullptr || count <= 0) return 0;
+
+	if (mode == Mode::Passthrough)
+		copy_samples(input, output, count);
+	else
+		convert_samples(input, output, count);
+
+	return count;
+}
+
 void Audio_resampler::inject_silence(int sample_count)
 {
+	if (mode != Mode::Resample) THROW_LOGIC_ERROR("Audio_resampler::inject_silence() requires resample mode");
 	swr_inject_silence(resampler_context, sample_count);
 }
 
 void Audio_resampler::drop_samples(int sample_count)
 {
+	if (mode != Mode::Resample) THROW_LOGIC_ERROR("Audio_resampler::drop_samples() requires resample mode");
 	swr_drop_output(resampler_context, sample_count);
 }
 
 int Audio_resampler::calc_samples(int input_samples) const
 {
+	if (mode != Mode::Resample) return input_samples;
 	return swr_get_out_samples(resampler_context, input_samples);
 }
 
@@ -1,12 +1,21 @@
 #ifdef _WIN32
 #include <psapi.h>
 #include <windows.h>
-#elif defined(__linux__)
+#else
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include "utility/system.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
 #include <fstream>
+#include <ostream>
 #include <sstream>
 
 std::optional<size_t> get_working_set_size()
@@ -54,4 +63,116 @@ void open_url(std::string_view url)
 #else
 	// Not implemented for other platforms
 #endif
-}
\ No newline at end of file
+}
+
+std::string get_cache_directory()
+{
+	std::filesystem::path base;
+
+#ifdef _WIN32
+	if (const char* app_data = std::getenv("LOCALAPPDATA"); app_data != nullptr && *app_data) base = app_data;
+#else
+	if (const char* xdg_cache = std::getenv("XDG_CACHE_HOME"); xdg_cache != nullptr && *xdg_cache)
+		base = xdg_cache;
+	else if (const char* home = std::getenv("HOME"); home != nullptr && *home)
+		base = std::filesystem::path(home) / ".cache";
+#endif
+
+	if (base.empty())
+	{
+		std::error_code error;
+		base = std::filesystem::temp_directory_path(error);
+	}
+
+	return (base / "nodey-audio-editor").string();
+}
+
+namespace
+{
+	// 临时文件名包含进程号与进程内的序号，同时写入同一目标的多个线程或进程不会互相覆盖临时文件
+	std::string make_temp_path(const std::string& path)
+	{
+		static std::atomic<uint64_t> counter = 0;
+
+#ifdef _WIN32
+		const auto process_id = static_cast<uint64_t>(GetCurrentProcessId());
+#else
+		const auto process_id = static_cast<uint64_t>(getpid());
+#endif
+
+		return std::format("{}.{}-{}.tmp", path, process_id, counter.fetch_add(1, std::memory_order_relaxed));
+	}
+}
+
+bool write_file_atomic(const std::string& path, const std::function<bool(std::ostream&)>& write_content)
+{
+	const std::string temp_path = make_temp_path(path);
+
+	bool success;
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) return false;
+
+		success = write_content(file);
+		file.flush();
+		success = success && file.good();
+	}
+
+#ifdef _WIN32
+
+	// 重命名前必须刷入磁盘，否则断电后可能得到重命名成功但内容为空的文件
+	if (success)
+	{
+		const HANDLE file = CreateFileA(
+			temp_path.c_str(),
+			GENERIC_WRITE,
+			0,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr
+		);
+
+		success = file != INVALID_HANDLE_VALUE && FlushFileBuffers(file);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	}
+
+	if (success)
+		success = MoveFileExA(
+			temp_path.c_str(),
+			path.c_str(),
+			MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH
+		);
+
+	if (!success) DeleteFileA(temp_path.c_str());
+	return success;
+
+#else
+
+	// 重命名前必须刷入磁盘，否则断电后可能得到重命名成功但内容为空的文件
+	if (success)
+	{
+		const int file = open(temp_path.c_str(), O_WRONLY);
+		success = file >= 0 && fsync(file) == 0;
+		if (file >= 0) success = close(file) == 0 && success;
+	}
+
+	if (success) success = std::rename(temp_path.c_str(), path.c_str()) == 0;
+
+	if (!success) unlink(temp_path.c_str());
+	return success;
+
+#endif
+}
+
+bool write_file_atomic(const std::string& path, std::string_view content)
+{
+	return write_file_atomic(
+		path,
+		[content](std::ostream& stream)
+		{
+			stream.write(content.data(), std::streamsize(content.size()));
+			return stream.good();
+		}
+	);
+}
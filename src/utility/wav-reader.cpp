@@ -0,0 +1,266 @@
+#include "utility/wav-reader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+
+// 注：WAV文件均为小端序，以下实现假定宿主机也为小端序（x86/ARM）
+
+namespace
+{
+	constexpr uint16_t wave_format_pcm = 0x0001;
+	constexpr uint16_t wave_format_ieee_float = 0x0003;
+	constexpr uint16_t wave_format_extensible = 0xFFFE;
+
+	// KSDATAFORMAT_SUBTYPE_PCM/IEEE_FLOAT的GUID中，除前两字节外的公共部分
+	constexpr std::array<uint8_t, 14> ksdataformat_guid_tail
+		= {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+
+	template <typename T>
+	T read_le(const std::byte* ptr)
+	{
+		T value;
+		std::memcpy(&value, ptr, sizeof(T));
+		return value;
+	}
+
+	bool match_id(const std::byte* ptr, const char (&id)[5])
+	{
+		return std::memcmp(ptr, id, 4) == 0;
+	}
+
+	/* 采样转换内核 */
+	// - 写成无分支的简单循环，由编译器自动向量化
+	// - 通过memcpy读取，允许data块不对齐
+
+	void convert_u8(const std::byte* src, float* dst, size_t count)
+	{
+		const auto* typed_src = reinterpret_cast<const uint8_t*>(src);
+		for (size_t i = 0; i < count; i++) dst[i] = (float(typed_src[i]) - 128.0f) * (1.0f / 128.0f);
+	}
+
+	void convert_s16(const std::byte* src, float* dst, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			dst[i] = float(read_le<int16_t>(src + i * 2)) * (1.0f / 32768.0f);
+	}
+
+	void convert_s24(const std::byte* src, float* dst, size_t count)
+	{
+		const auto* typed_src = reinterpret_cast<const uint8_t*>(src);
+		for (size_t i = 0; i < count; i++)
+		{
+			const auto* sample = typed_src + i * 3;
+			const int32_t value = int32_t(
+				(uint32_t(sample[0]) << 8) | (uint32_t(sample[1]) << 16) | (uint32_t(sample[2]) << 24)
+			);
+			dst[i] = float(value >> 8) * (1.0f / 8388608.0f);
+		}
+	}
+
+	void convert_s32(const std::byte* src, float* dst, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			dst[i] = float(read_le<int32_t>(src + i * 4)) * (1.0f / 2147483648.0f);
+	}
+
+	void convert_f32(const std::byte* src, float* dst, size_t count)
+	{
+		std::memcpy(dst, src, count * sizeof(float));
+	}
+
+	void convert_f64(const std::byte* src, float* dst, size_t count)
+	{
+		for (size_t i = 0; i < count; i++) dst[i] = float(read_le<double>(src + i * 8));
+	}
+
+	size_t sample_size(Wav_reader::Sample_type type)
+	{
+		switch (type)
+		{
+		case Wav_reader::Sample_type::Uint8:
+			return 1;
+		case Wav_reader::Sample_type::Int16:
+			return 2;
+		case Wav_reader::Sample_type::Int24:
+			return 3;
+		case Wav_reader::Sample_type::Int32:
+		case Wav_reader::Sample_type::Float32:
+			return 4;
+		case Wav_reader::Sample_type::Float64:
+			return 8;
+		}
+
+		return 0;
+	}
+}
+
+Wav_reader::Wav_reader(Mapped_file file, Format format, const std::byte* data_begin, size_t frame_count) :
+	file(std::move(file)),
+	format(format),
+	data_begin(data_begin),
+	bytes_per_frame(sample_size(format.sample_type) * format.channels),
+	frame_count(frame_count)
+{
+}
+
+std::optional<Wav_reader> Wav_reader::open(const std::string& path)
+{
+	auto mapped = Mapped_file::open(path);
+	if (!mapped.has_value()) return std::nullopt;
+
+	const std::byte* const begin = mapped->data();
+	const size_t file_size = mapped->size();
+
+	if (file_size < 12) return std::nullopt;
+
+	const bool is_rf64 = match_id(begin, "RF64") || match_id(begin, "BW64");
+	if (!match_id(begin, "RIFF") && !is_rf64) return std::nullopt;
+	if (!match_id(begin + 8, "WAVE")) return std::nullopt;
+
+	std::optional<Format> format;
+	const std::byte* data_begin = nullptr;
+	uint64_t data_size = 0;
+	uint64_t ds64_data_size = 0;
+
+	/* 遍历块 */
+
+	size_t offset = 12;
+	while (offset + 8 <= file_size && data_begin == nullptr)
+	{
+		const std::byte* const chunk = begin + offset;
+		const uint32_t chunk_size = read_le<uint32_t>(chunk + 4);
+		const std::byte* const body = chunk + 8;
+		const size_t body_available = file_size - offset - 8;
+
+		if (match_id(chunk, "ds64"))
+		{
+			// RF64: riff_size(8) data_size(8) sample_count(8) ...
+			if (chunk_size < 24 || body_available < 24) return std::nullopt;
+			ds64_data_size = read_le<uint64_t>(body + 8);
+		}
+		else if (match_id(chunk, "fmt "))
+		{
+			if (chunk_size < 16 || body_available < 16) return std::nullopt;
+
+			uint16_t format_tag = read_le<uint16_t>(body);
+			const uint16_t channels = read_le<uint16_t>(body + 2);
+			const uint32_t sample_rate = read_le<uint32_t>(body + 4);
+			const uint16_t block_align = read_le<uint16_t>(body + 12);
+			const uint16_t bits_per_sample = read_le<uint16_t>(body + 14);
+			uint32_t channel_mask = 0;
+
+			if (format_tag == wave_format_extensible)
+			{
+				if (chunk_size < 40 || body_available < 40) return std::nullopt;
+
+				channel_mask = read_le<uint32_t>(body + 20);
+				format_tag = read_le<uint16_t>(body + 24);
+				if (std::memcmp(body + 26, ksdataformat_guid_tail.data(), ksdataformat_guid_tail.size()) != 0)
+					return std::nullopt;
+			}
+
+			if (channels == 0 || sample_rate == 0) return std::nullopt;
+
+			Sample_type sample_type;
+			if (format_tag == wave_format_pcm)
+			{
+				switch (bits_per_sample)
+				{
+				case 8:
+					sample_type = Sample_type::Uint8;
+					break;
+				case 16:
+					sample_type = Sample_type::Int16;
+					break;
+				case 24:
+					sample_type = Sample_type::Int24;
+					break;
+				case 32:
+					sample_type = Sample_type::Int32;
+					break;
+				default:
+					return std::nullopt;
+				}
+			}
+			else if (format_tag == wave_format_ieee_float)
+			{
+				switch (bits_per_sample)
+				{
+				case 32:
+					sample_type = Sample_type::Float32;
+					break;
+				case 64:
+					sample_type = Sample_type::Float64;
+					break;
+				default:
+					return std::nullopt;
+				}
+			}
+			else
+				return std::nullopt;  // 压缩格式交给libavcodec
+
+			if (block_align != sample_size(sample_type) * channels) return std::nullopt;
+
+			format = Format{
+				.sample_type = sample_type,
+				.channels = channels,
+				.sample_rate = int(sample_rate),
+				.channel_mask = channel_mask
+			};
+		}
+		else if (match_id(chunk, "data"))
+		{
+			data_begin = body;
+			data_size = (is_rf64 && chunk_size == 0xFFFFFFFF) ? ds64_data_size : chunk_size;
+
+			// 截断的文件：只读取实际存在的部分
+			data_size = std::min<uint64_t>(data_size, body_available);
+			break;
+		}
+
+		offset += 8 + size_t(chunk_size) + (chunk_size & 1);  // 块按2字节对齐
+	}
+
+	if (!format.has_value() || data_begin == nullptr) return std::nullopt;
+
+	mapped->advise_sequential();
+
+	const size_t frame_bytes = sample_size(format->sample_type) * format->channels;
+	return Wav_reader(std::move(mapped.value()), *format, data_begin, size_t(data_size / frame_bytes));
+}
+
+size_t Wav_reader::read_interleaved(float* dst, size_t max_frames)
+{
+	const size_t frames = std::min(max_frames, remaining_frames());
+	if (frames == 0) return 0;
+
+	const std::byte* const src = data_begin + position * bytes_per_frame;
+	const size_t samples = frames * format.channels;
+
+	switch (format.sample_type)
+	{
+	case Sample_type::Uint8:
+		convert_u8(src, dst, samples);
+		break;
+	case Sample_type::Int16:
+		convert_s16(src, dst, samples);
+		break;
+	case Sample_type::Int24:
+		convert_s24(src, dst, samples);
+		break;
+	case Sample_type::Int32:
+		convert_s32(src, dst, samples);
+		break;
+	case Sample_type::Float32:
+		convert_f32(src, dst, samples);
+		break;
+	case Sample_type::Float64:
+		convert_f64(src, dst, samples);
+		break;
+	}
+
+	position += frames;
+	return frames;
+}
@@ -1155,6 +1155,14 @@ namespace IMNODES_NAMESPACE
 			}
 		}
 
+		// Pins stick out of the node rect by PinOffset, include them in the visibility test
+		inline bool NodeOverlapsCanvas(const ImNodeData& node)
+		{
+			ImRect rect = node.Rect;
+			rect.Expand(ImVec2(ImFabs(GImNodes->Style.PinOffset) + GImNodes->Style.PinHoverRadius, 0.f));
+			return GImNodes->CanvasRectScreenSpace.Overlaps(rect);
+		}
+
 		void ResolveOccludedPins(const ImNodesEditorContext& editor, ImVector<int>& occluded_pin_indices)
 		{
 			const ImVector<int>& depth_stack = editor.NodeDepthOrder;
@@ -1171,11 +1179,23 @@ namespace IMNODES_NAMESPACE
 			{
 				const ImNodeData& node_below = editor.Nodes.Pool[depth_stack[depth_idx]];
 
+				// Pins outside of the canvas can't be hovered, skip them to keep this quadratic loop cheap
+				// for large graphs
+				if (!NodeOverlapsCanvas(node_below))
+				{
+					continue;
+				}
+
 				// Iterate over the rest of the depth stack to find nodes overlapping the pins
 				for (int next_depth_idx = depth_idx + 1; next_depth_idx < depth_stack.Size; ++next_depth_idx)
 				{
 					const ImRect& rect_above = editor.Nodes.Pool[depth_stack[next_depth_idx]].Rect;
 
+					if (!rect_above.Overlaps(node_below.Rect))
+					{
+						continue;
+					}
+
 					// Iterate over each pin
 					for (int idx = 0; idx < node_below.PinIndices.Size; ++idx)
 					{
@@ -1554,6 +1574,20 @@ namespace IMNODES_NAMESPACE
 		void DrawNode(ImNodesEditorContext& editor, const int node_idx)
 		{
 			const ImNodeData& node = editor.Nodes.Pool[node_idx];
+
+			// Nodes outside of the canvas are not drawn, but their pin positions are still needed by links
+			// and hover detection
+			if (!NodeOverlapsCanvas(node))
+			{
+				for (int i = 0; i < node.PinIndices.size(); ++i)
+				{
+					ImPinData& pin = editor.Pins.Pool[node.PinIndices[i]];
+					pin.Pos = GetScreenSpacePinCoordinates(node.Rect, pin.AttributeRect, pin.Type);
+				}
+
+				return;
+			}
+
 			ImGui::SetCursorPos(node.Origin + editor.Panning);
 
 			const bool node_hovered
@@ -1676,6 +1710,12 @@ namespace IMNODES_NAMESPACE
 				return;
 			}
 
+			// Skip links entirely outside of the canvas
+			if (!GImNodes->CanvasRectScreenSpace.Overlaps(GetContainingRectForCubicBezier(cubic_bezier)))
+			{
+				return;
+			}
+
 			ImU32 link_color = link.ColorStyle.Base;
 			if (editor.SelectedLinkIndices.contains(link_idx))
 			{
@@ -1898,6 +1938,12 @@ namespace IMNODES_NAMESPACE
 				mini_map_node_rounding
 			);
 
+			// Level of detail: outlines of nodes only a few pixels large are not visible, skip them
+			if (node_rect.GetWidth() < 4.f || node_rect.GetHeight() < 4.f)
+			{
+				return;
+			}
+
 			GImNodes->CanvasDrawList
 				->AddRect(node_rect.Min, node_rect.Max, mini_map_node_outline, mini_map_node_rounding);
 		}
@@ -1908,12 +1954,8 @@ namespace IMNODES_NAMESPACE
 			const ImPinData& start_pin = editor.Pins.Pool[link.StartPinIdx];
 			const ImPinData& end_pin = editor.Pins.Pool[link.EndPinIdx];
 
-			const CubicBezier cubic_bezier = GetCubicBezier(
-				ScreenSpaceToMiniMapSpace(editor, start_pin.Pos),
-				ScreenSpaceToMiniMapSpace(editor, end_pin.Pos),
-				start_pin.Type,
-				GImNodes->Style.LinkLineSegmentsPerLength / editor.MiniMapScaling
-			);
+			const ImVec2 start_pos = ScreenSpaceToMiniMapSpace(editor, start_pin.Pos);
+			const ImVec2 end_pos = ScreenSpaceToMiniMapSpace(editor, end_pin.Pos);
 
 			// It's possible for a link to be deleted in begin_link_interaction. A user
 			// may detach a link, resulting in the link wire snapping to the mouse
@@ -1930,18 +1972,12 @@ namespace IMNODES_NAMESPACE
 					  [editor.SelectedLinkIndices.contains(link_idx) ? ImNodesCol_MiniMapLinkSelected
 																	 : ImNodesCol_MiniMapLink];
 
-#if IMGUI_VERSION_NUM < 18000
-			GImNodes->CanvasDrawList->AddBezierCurve(
-#else
-			GImNodes->CanvasDrawList->AddBezierCubic(
-#endif
-				cubic_bezier.P0,
-				cubic_bezier.P1,
-				cubic_bezier.P2,
-				cubic_bezier.P3,
+			// Level of detail: at mini-map scale the curvature is barely visible, draw a straight line
+			GImNodes->CanvasDrawList->AddLine(
+				start_pos,
+				end_pos,
 				link_color,
-				GImNodes->Style.LinkThickness * editor.MiniMapScaling,
-				cubic_bezier.NumSegments
+				GImNodes->Style.LinkThickness * editor.MiniMapScaling
 			);
 		}
 
@@ -51,6 +51,39 @@ target("nodey_audio")
 	end
 target_end()
 
+-- 基准测试，不包含前端代码，不初始化SDL视频
+-- 运行：xmake build nodey_bench && xmake run nodey_bench
+target("nodey_bench")
+	set_kind("binary")
+	set_languages("c++23")
+	set_default(false)
+
+	add_deps("imnodes", "portable-file-dialogs")
+	add_packages(
+		"libsdl2", 
+		"imgui", 
+		"jsoncpp", 
+		"ffmpeg", 
+		"boost", 
+		"fftw",
+		"soundtouch",
+		"lame"
+	)
+
+	add_files("src/infra/*.cpp", "src/processor/*.cpp", "src/utility/*.cpp", "src/register.cpp")
+	add_files("bench/*.cpp")
+	add_includedirs("include")
+
+	if is_plat("windows") then
+		add_cxflags("/utf-8")
+		add_defines("NOMINMAX")
+	end
+
+	if is_mode("debug") then
+		add_defines("_DEBUG")
+	end
+target_end()
+
 includes("@builtin/xpack")
 
 xpack("nodey_audio")